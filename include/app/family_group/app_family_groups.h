@@ -0,0 +1,23 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_APP_FAMILY_GROUPS_H_
+#define VH_PONC_APP_FAMILY_GROUPS_H_
+
+#include <memory>
+#include <vector>
+
+#include "core_i_family_group.h"
+#include "json_i_family_parser.h"
+
+namespace vh::ponc {
+///
+auto CreateFamilyGroups() -> std::vector<std::unique_ptr<core::IFamilyGroup>>;
+///
+auto CreateFamilyParsers() -> std::vector<std::unique_ptr<json::IFamilyParser>>;
+}  // namespace vh::ponc
+
+#endif  // VH_PONC_APP_FAMILY_GROUPS_H_
@@ -0,0 +1,39 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_BENCH_APP_H_
+#define VH_PONC_BENCH_APP_H_
+
+#include <crude_json.h>
+
+#include "bench_options.h"
+
+namespace vh::ponc::bench {
+///
+class App {
+ public:
+  ///
+  explicit App(Options options);
+
+  ///
+  auto Run() -> int;
+
+ private:
+  ///
+  auto RunScenarios() const -> crude_json::value;
+  ///
+  auto RunChecks() const -> bool;
+  ///
+  auto CompareWithBaseline(const crude_json::value &report) const -> bool;
+  ///
+  auto WriteReport(const crude_json::value &report) const -> bool;
+
+  ///
+  Options options_{};
+};
+}  // namespace vh::ponc::bench
+
+#endif  // VH_PONC_BENCH_APP_H_
@@ -0,0 +1,32 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_BENCH_CHECKER_H_
+#define VH_PONC_BENCH_CHECKER_H_
+
+#include "bench_scenario.h"
+#include "core_settings.h"
+#include "cpp_static_api.h"
+
+namespace vh::ponc::bench {
+///
+struct Checker : public cpp::StaticApi {
+  ///
+  static auto CheckEngines(const Scenario &scenario,
+                           const core::CalculatorSettings &settings) -> bool;
+  ///
+  static auto CanRunWorkers() -> bool;
+  ///
+  static auto CheckWorkers(const Scenario &scenario,
+                           const core::CalculatorSettings &settings) -> bool;
+  ///
+  static auto CheckResolution(const Scenario &scenario,
+                              const core::CalculatorSettings &settings)
+      -> bool;
+};
+}  // namespace vh::ponc::bench
+
+#endif  // VH_PONC_BENCH_CHECKER_H_
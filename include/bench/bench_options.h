@@ -0,0 +1,45 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_BENCH_OPTIONS_H_
+#define VH_PONC_BENCH_OPTIONS_H_
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+///
+enum class Check { kNone, kEngines, kWorkers, kResolution };
+
+///
+struct Options {
+  ///
+  static auto Parse(std::span<char *const> args) -> std::optional<Options>;
+  ///
+  static auto GetUsage() -> std::string;
+
+  ///
+  std::string filter{};
+  ///
+  core::CalculatorEngine engine{};
+  ///
+  int num_threads{1};
+  ///
+  std::filesystem::path output_file{};
+  ///
+  std::filesystem::path baseline_file{};
+  ///
+  float tolerance{10};
+  ///
+  Check check{};
+};
+}  // namespace vh::ponc::bench
+
+#endif  // VH_PONC_BENCH_OPTIONS_H_
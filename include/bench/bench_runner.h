@@ -0,0 +1,44 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_BENCH_RUNNER_H_
+#define VH_PONC_BENCH_RUNNER_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "bench_scenario.h"
+#include "calc_types.h"
+#include "core_settings.h"
+#include "cpp_static_api.h"
+
+namespace vh::ponc::bench {
+///
+struct Measurement {
+  ///
+  double wall_time{};
+  ///
+  std::int64_t num_expanded_nodes{};
+  ///
+  std::int64_t num_pruned_nodes{};
+  ///
+  std::int64_t peak_memory_size{};
+  ///
+  calc::Cost cost{};
+  ///
+  calc::NumClients num_clients{};
+};
+
+///
+struct Runner : public cpp::StaticApi {
+  ///
+  static auto Measure(const Scenario &scenario,
+                      const core::CalculatorSettings &settings)
+      -> std::optional<Measurement>;
+};
+}  // namespace vh::ponc::bench
+
+#endif  // VH_PONC_BENCH_RUNNER_H_
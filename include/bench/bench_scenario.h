@@ -0,0 +1,46 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_BENCH_SCENARIO_H_
+#define VH_PONC_BENCH_SCENARIO_H_
+
+#include <string>
+#include <vector>
+
+#include "calc_calculator.h"
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+///
+enum class FamilySet { kSplitters, kSplittersCouplers, kAttenuators };
+
+///
+struct Scenario {
+  ///
+  static auto MakeScenarios() -> std::vector<Scenario>;
+  ///
+  static auto GetFamilySetName(FamilySet family_set) -> std::string;
+  ///
+  static auto MakeCalculatorArgs(const Scenario &scenario,
+                                 const core::CalculatorSettings &settings)
+      -> calc::Calculator::ConstructorArgs;
+
+  ///
+  std::string name{};
+  ///
+  FamilySet family_set{};
+  ///
+  int num_clients{};
+  ///
+  int num_inputs{};
+  ///
+  float min_output{};
+  ///
+  float max_output{};
+};
+}  // namespace vh::ponc::bench
+
+#endif  // VH_PONC_BENCH_SCENARIO_H_
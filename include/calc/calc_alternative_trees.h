@@ -0,0 +1,80 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_ALTERNATIVE_TREES_H_
+#define VH_PONC_CALC_ALTERNATIVE_TREES_H_
+
+#include <span>
+#include <vector>
+
+#include "calc_best_trees_table.h"
+#include "calc_types.h"
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+///
+class AlternativeTrees {
+ public:
+  ///
+  struct Tree {
+    ///
+    FamilyIndex family_index{};
+    ///
+    Cost cost{};
+    ///
+    std::vector<NumClients> child_num_clients{};
+  };
+
+  ///
+  struct ConstructorArgs {
+    ///
+    int num_rows{};
+    ///
+    NumClients max_num_clients{};
+    ///
+    int max_num_trees{};
+  };
+
+  ///
+  explicit AlternativeTrees(const ConstructorArgs &args);
+
+  ///
+  void AddTree(RowIndex row, NumClients num_clients, FamilyIndex family_index,
+               Cost cost, std::span<const NumClients> child_num_clients);
+  ///
+  auto GetSortedTrees(RowIndex row, NumClients num_clients) const
+      -> std::vector<Tree>;
+
+  ///
+  auto IsFull(RowIndex row, NumClients num_clients) const {
+    return static_cast<int>(cells_[GetCellIndex(row, num_clients)].size()) >=
+           max_num_trees_;
+  }
+
+  ///
+  auto GetMaxCost(RowIndex row, NumClients num_clients) const {
+    const auto &trees = cells_[GetCellIndex(row, num_clients)];
+    Expects(!trees.empty());
+    return trees.front().cost;
+  }
+
+ private:
+  ///
+  auto GetCellIndex(RowIndex row, NumClients num_clients) const -> int {
+    Expects((num_clients >= 0) && (num_clients <= max_num_clients_));
+    return row * (max_num_clients_ + 1) + num_clients;
+  }
+
+  ///
+  NumClients max_num_clients_{};
+  ///
+  int max_num_trees_{};
+  ///
+  std::vector<std::vector<Tree>> cells_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_ALTERNATIVE_TREES_H_
@@ -0,0 +1,81 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_BATCH_TASK_H_
+#define VH_PONC_CALC_BATCH_TASK_H_
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <vector>
+
+#include "calc_calculator.h"
+#include "calc_estimator.h"
+#include "calc_tree_node.h"
+
+namespace vh::ponc::calc {
+///
+class BatchTask {
+ public:
+  ///
+  struct ConstructorArgs {
+    ///
+    Calculator::ConstructorArgs calculator_args{};
+    ///
+    std::vector<std::vector<TreeNode>> diagram_input_nodes{};
+  };
+
+  ///
+  explicit BatchTask(ConstructorArgs args);
+
+  ///
+  BatchTask(const BatchTask &) = delete;
+  ///
+  BatchTask(BatchTask &&) noexcept = delete;
+
+  ///
+  auto operator=(const BatchTask &) -> BatchTask & = delete;
+  ///
+  auto operator=(BatchTask &&) noexcept -> BatchTask & = delete;
+
+  ///
+  ~BatchTask();
+
+  ///
+  static auto ChooseCalculation(const ConstructorArgs &args)
+      -> Estimator::Estimate;
+
+  ///
+  void Stop();
+  ///
+  auto IsRunning() const -> bool;
+  ///
+  auto GetProgress() const -> float;
+  ///
+  auto GetTimeLeft() const -> std::optional<std::chrono::seconds>;
+  ///
+  auto GetResults() -> std::optional<std::vector<std::vector<TreeNode>>>;
+
+ private:
+  ///
+  auto CalculateDiagrams(ConstructorArgs args)
+      -> std::vector<std::vector<TreeNode>>;
+  ///
+  void UpdateProgress(const std::vector<std::atomic<float>> &part_progress);
+
+  ///
+  std::future<std::vector<std::vector<TreeNode>>> task_{};
+  ///
+  std::atomic<bool> stop_requested_{};
+  ///
+  std::atomic<float> progress_{};
+  ///
+  std::chrono::steady_clock::time_point start_time_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_BATCH_TASK_H_
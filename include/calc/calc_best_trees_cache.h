@@ -0,0 +1,61 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_BEST_TREES_CACHE_H_
+#define VH_PONC_CALC_BEST_TREES_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "calc_best_trees_table.h"
+#include "calc_types.h"
+#include "core_i_family.h"
+
+namespace vh::ponc::calc {
+///
+class BestTreesCache {
+ public:
+  ///
+  using Key = std::uint64_t;
+
+  ///
+  struct Entry {
+    ///
+    std::shared_ptr<const BestTreesTable> best_trees{};
+    ///
+    std::vector<core::FamilyId> family_ids{};
+    ///
+    std::vector<Cost> family_costs{};
+    ///
+    Cost client_cost{};
+    ///
+    std::optional<Key> inputs_key{};
+  };
+
+  ///
+  auto Find(Key key) const -> std::optional<Entry>;
+  ///
+  void Store(Key key, Entry entry);
+  ///
+  auto ReadFromFile(const std::filesystem::path &file_path) -> bool;
+  ///
+  auto WriteToFile(const std::filesystem::path &file_path) const -> bool;
+
+ private:
+  ///
+  mutable std::mutex mutex_{};
+  ///
+  std::list<std::pair<Key, Entry>> entries_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_BEST_TREES_CACHE_H_
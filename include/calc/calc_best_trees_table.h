@@ -0,0 +1,176 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_BEST_TREES_TABLE_H_
+#define VH_PONC_CALC_BEST_TREES_TABLE_H_
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "calc_types.h"
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+///
+using RowIndex = int;
+
+///
+class BestTreesTable {
+ public:
+  ///
+  BestTreesTable() = default;
+  ///
+  BestTreesTable(const std::vector<FlowValue> &sorted_outputs, int num_levels,
+                 int num_extra_rows, NumClients max_num_clients);
+  ///
+  BestTreesTable(const std::vector<FlowValue> &sorted_outputs, int num_levels,
+                 int num_extra_rows, NumClients max_num_clients,
+                 const std::vector<RowIndex> &stored_rows);
+
+  ///
+  auto GetNumRows() const -> int;
+  ///
+  auto IsRowStored(RowIndex row) const -> bool;
+  ///
+  auto GetNumOutputRows() const -> int;
+  ///
+  auto GetMaxNumClients() const -> NumClients;
+  ///
+  auto FindOutputRow(FlowValue output) const -> std::optional<RowIndex>;
+  ///
+  auto GetOutput(RowIndex row) const -> FlowValue;
+  ///
+  auto GetNumLevels() const -> int;
+  ///
+  auto GetLevel(RowIndex row) const -> int;
+  ///
+  auto GetLevelRow(RowIndex row, int level) const -> RowIndex;
+  ///
+  auto GetExtraRow(int extra_row_index) const -> RowIndex;
+  ///
+  auto GetFamilyIndex(RowIndex row, NumClients num_clients) const
+      -> FamilyIndex;
+  ///
+  auto GetChildNumClients(RowIndex row, NumClients num_clients) const
+      -> std::span<const NumClients>;
+  ///
+  void SetTree(RowIndex row, NumClients num_clients, FamilyIndex family_index,
+               Cost cost, std::span<const NumClients> child_num_clients);
+  ///
+  void ClearTree(RowIndex row, NumClients num_clients);
+  ///
+  void CompactRow(RowIndex row);
+  ///
+  void CopyRow(const BestTreesTable &source, RowIndex source_row,
+               RowIndex row, std::span<const FamilyIndex> family_indices);
+  ///
+  void WriteRowToStream(RowIndex row, std::ostream &stream) const;
+  ///
+  auto ReadRowFromStream(RowIndex row, std::istream &stream) -> bool;
+  ///
+  void WriteToStream(std::ostream &stream) const;
+  ///
+  static auto ReadFromStream(std::istream &stream,
+                             FamilyIndex max_family_index)
+      -> std::optional<BestTreesTable>;
+
+  ///
+  auto HasTree(RowIndex row, NumClients num_clients) const {
+    const auto word = occupancy_[GetWordIndex(row, num_clients)];
+    return ((word >> (num_clients % kWordBits)) & 1U) != 0;
+  }
+
+  ///
+  auto GetCost(RowIndex row, NumClients num_clients) const {
+    return costs_[GetCellIndex(row, num_clients)];
+  }
+
+  ///
+  auto FindMaxNumClients(RowIndex row, NumClients max_num_clients) const
+      -> NumClients {
+    if (max_num_clients <= 0) {
+      return 0;
+    }
+
+    max_num_clients = std::min(max_num_clients, num_columns_ - 1);
+
+    const auto *row_words = &occupancy_[GetWordIndex(row, 0)];
+    auto word_index = max_num_clients / kWordBits;
+    auto word = row_words[word_index] &
+                (~std::uint64_t{} >>
+                 (kWordBits - 1 - max_num_clients % kWordBits));
+
+    while (word == 0) {
+      if (word_index == 0) {
+        return 0;
+      }
+
+      --word_index;
+      word = row_words[word_index];
+    }
+
+    return word_index * kWordBits + std::bit_width(word) - 1;
+  }
+
+ private:
+  ///
+  static constexpr auto kWordBits = 64;
+  ///
+  static constexpr auto kNotStored = -1;
+
+  ///
+  auto GetCellIndex(RowIndex row, NumClients num_clients) const -> int {
+    Expects((row >= 0) && (row < num_rows_));
+    Expects((num_clients >= 0) && (num_clients < num_columns_));
+    Expects(row_cell_offsets_[row] != kNotStored);
+    return row_cell_offsets_[row] + num_clients;
+  }
+
+  ///
+  auto GetWordIndex(RowIndex row, NumClients num_clients) const -> int {
+    Expects((row >= 0) && (row < num_rows_));
+    Expects((num_clients >= 0) && (num_clients < num_columns_));
+    Expects(row_word_offsets_[row] != kNotStored);
+    return row_word_offsets_[row] + num_clients / kWordBits;
+  }
+
+  ///
+  FlowValue min_output_{};
+  ///
+  std::vector<FlowValue> outputs_{};
+  ///
+  std::vector<RowIndex> output_rows_{};
+  ///
+  int num_levels_{};
+  ///
+  int num_rows_{};
+  ///
+  int num_columns_{};
+  ///
+  int num_words_per_row_{};
+  ///
+  std::vector<int> row_cell_offsets_{};
+  ///
+  std::vector<int> row_word_offsets_{};
+  ///
+  std::vector<Cost> costs_{};
+  ///
+  std::vector<std::uint64_t> occupancy_{};
+  ///
+  std::vector<FamilyIndex> family_indices_{};
+  ///
+  std::vector<int> child_offsets_{};
+  ///
+  std::vector<std::vector<NumClients>> row_children_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_BEST_TREES_TABLE_H_
@@ -8,17 +8,30 @@
 #define VH_PONC_CALC_CALCULATION_TASK_H_
 
 #include <atomic>
+#include <chrono>
 #include <future>
+#include <memory>
 #include <optional>
 #include <vector>
 
 #include "calc_calculator.h"
 #include "calc_tree_node.h"
+#include "calc_types.h"
 
 namespace vh::ponc::calc {
 ///
 class CalculationTask {
  public:
+  ///
+  struct BestResult {
+    ///
+    std::vector<TreeNode> calculated_trees{};
+    ///
+    Cost total_cost{};
+    ///
+    NumClients num_clients{};
+  };
+
   ///
   explicit CalculationTask(Calculator::ConstructorArgs args);
 
@@ -42,19 +55,39 @@ class CalculationTask {
   ///
   auto GetProgress() const -> float;
   ///
+  auto GetTimeLeft() const -> std::optional<std::chrono::seconds>;
+  ///
   auto GetResult() -> std::optional<std::vector<calc::TreeNode>>;
+  ///
+  auto GetFinishedCalculator() const -> std::shared_ptr<const Calculator>;
+  ///
+  auto GetStatistics() const -> const Calculator::Statistics &;
+  ///
+  auto GetBestResult() -> const std::optional<BestResult> &;
 
  private:
   ///
   auto OnCalculationStep(const calc::Calculator &calculator)
       -> calc::Calculator::StepStatus;
+  ///
+  void OnBestResult(std::vector<TreeNode> calculated_trees);
 
   ///
-  std::future<std::vector<calc::TreeNode>> task_{};
+  std::future<std::shared_ptr<Calculator>> task_{};
   ///
   std::atomic<bool> stop_requested_{};
   ///
   std::atomic<float> progress_{};
+  ///
+  std::chrono::steady_clock::time_point start_time_{};
+  ///
+  Calculator::Statistics statistics_{};
+  ///
+  std::atomic<BestResult *> best_result_mailbox_{};
+  ///
+  std::optional<BestResult> best_result_{};
+  ///
+  std::shared_ptr<const Calculator> finished_calculator_{};
 };
 }  // namespace vh::ponc::calc
 
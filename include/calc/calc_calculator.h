@@ -7,15 +7,29 @@
 #ifndef VH_PONC_CALC_CALCULATOR_H_
 #define VH_PONC_CALC_CALCULATOR_H_
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <iosfwd>
+#include <limits>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
-#include <unordered_map>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "calc_alternative_trees.h"
+#include "calc_best_trees_cache.h"
+#include "calc_best_trees_table.h"
+#include "calc_thread_pool.h"
 #include "calc_tree_node.h"
 #include "calc_types.h"
+#include "calc_worker_pool.h"
 #include "core_settings.h"
 
 namespace vh::ponc::calc {
@@ -37,62 +51,400 @@ class Calculator {
     std::vector<TreeNode> family_nodes{};
     ///
     std::function<auto(const Calculator &)->StepStatus> step_callback{};
+    ///
+    std::function<void(std::vector<TreeNode>)> best_result_callback{};
+    ///
+    std::shared_ptr<BestTreesCache> best_trees_cache{};
+    ///
+    std::shared_ptr<ThreadPool> thread_pool{};
+    ///
+    bool only_output_trees{};
+  };
+
+  ///
+  struct Statistics {
+    ///
+    std::int64_t num_expanded_nodes{};
+    ///
+    std::int64_t num_pruned_nodes{};
+    ///
+    int num_removed_families{};
+    ///
+    int num_removed_outputs{};
+    ///
+    Cost result_cost{};
+    ///
+    Cost lower_bound_cost{};
+  };
+
+  ///
+  struct CostCurvePoint {
+    ///
+    NumClients num_clients{};
+    ///
+    Cost total_cost{};
   };
 
   ///
   explicit Calculator(const ConstructorArgs &args);
 
+  ///
+  static auto UsesCache(const core::CalculatorSettings &settings) -> bool;
+  ///
+  static auto GetNumPathLevels(const core::CalculatorSettings &settings)
+      -> int;
+  ///
+  static auto RunWorker() -> int;
   ///
   auto GetProgress() const -> float;
   ///
+  auto GetStatistics() const -> Statistics;
+  ///
   auto TakeResult() -> std::vector<TreeNode>;
+  ///
+  auto GetCostCurve() const -> std::vector<CostCurvePoint>;
+  ///
+  auto MakeCostCurveResult(NumClients num_clients) const
+      -> std::vector<TreeNode>;
+  ///
+  auto MakeLayoutResults() const -> std::vector<std::vector<TreeNode>>;
 
  private:
+  ///
+  enum class SearchedFamilies { kNone, kDecreasedCost, kAll };
+
+  ///
+  static constexpr auto kAnyNumOutputs = 0;
+
+  ///
+  template <typename T, int kNumValues>
+  using PermutationValues =
+      std::conditional_t<kNumValues == kAnyNumOutputs, std::vector<T>,
+                         std::array<T, kNumValues>>;
+
+  ///
+  template <int kNumOutputs>
+  static constexpr auto kNumBounds =
+      (kNumOutputs == kAnyNumOutputs) ? kAnyNumOutputs : (kNumOutputs + 1);
+
+  ///
+  template <int kNumOutputs>
+  struct PermutationSearch {
+    ///
+    RowIndex row{};
+    ///
+    FamilyIndex family_index{};
+    ///
+    PermutationValues<RowIndex, kNumOutputs> child_rows{};
+    ///
+    PermutationValues<OutputIndex, kNumOutputs> symmetric_outputs{};
+    ///
+    PermutationValues<NumClients, kNumBounds<kNumOutputs>>
+        max_num_clients_left{};
+    ///
+    PermutationValues<double, kNumBounds<kNumOutputs>>
+        min_costs_per_client_left{};
+    ///
+    PermutationValues<NumClients, kNumOutputs> permutation{};
+    ///
+    Statistics statistics{};
+    ///
+    int num_steps_since_stop_check{};
+  };
+
+  ///
+  using PermutationKernel = void (Calculator::*)(
+      RowIndex row, FamilyIndex family_index,
+      const std::vector<RowIndex> &child_rows);
+
+  ///
+  static constexpr auto kNoPruneCost = std::numeric_limits<Cost>::max();
+
+  ///
+  struct LayoutDerivation {
+    ///
+    Cost cost{};
+    ///
+    int tree_index{};
+    ///
+    std::vector<int> child_ranks{};
+  };
+
+  ///
+  struct LayoutCell {
+    ///
+    std::vector<AlternativeTrees::Tree> trees{};
+    ///
+    std::vector<std::vector<RowIndex>> child_rows{};
+    ///
+    std::vector<LayoutDerivation> derivations{};
+    ///
+    std::vector<LayoutDerivation> candidates{};
+    ///
+    std::set<std::pair<int, std::vector<int>>> tried_candidates{};
+  };
+
+  ///
+  using LayoutSearch = std::map<std::pair<RowIndex, NumClients>, LayoutCell>;
+
+  ///
+  Calculator() = default;
+
   ///
   auto IsOutputInRange(FlowValue ouput) const;
   ///
-  auto IsStopped();
+  auto IsStopped() -> bool;
+  ///
+  template <int kNumOutputs>
+  auto IsStopped(PermutationSearch<kNumOutputs> &search) -> bool;
+  ///
+  void RemoveDominatedFamilies();
+  ///
+  void SnapOutputsToFlowStep(FlowValue flow_step);
+  ///
+  void UseFlowStep(FlowValue flow_step);
   ///
   void FindUniqueOutputs();
   ///
+  void FindCachedBestTrees();
+  ///
+  auto MakeCacheKey() const -> BestTreesCache::Key;
+  ///
+  auto MakeInputsKey() const -> BestTreesCache::Key;
+  ///
+  void StoreCachedBestTrees() const;
+  ///
+  auto SplitOutputsIntoWaves() const -> std::vector<std::vector<RowIndex>>;
+  ///
+  void FindBestTrees();
+  ///
   void FindBestOutputTrees();
   ///
-  void FindBestTreesForOutput(FlowValue output, const TreeNode &family_node);
+  void FindBestOutputTreesInWaves(
+      const std::vector<std::vector<RowIndex>> &row_waves);
+  ///
+  void FindBestOutputTreesInWorkers(
+      const std::vector<std::vector<RowIndex>> &row_waves);
   ///
-  auto GetBestTree(FlowValue output, NumClients num_clients)
-      -> std::optional<TreeNode *>;
+  void WriteWorkerSetup(std::ostream &stream) const;
   ///
-  auto TestBestTreesPermutation(
-      FlowValue output, const TreeNode &family_node,
-      std::vector<std::optional<const TreeNode *>> &permutation,
-      OutputIndex output_index);
+  auto ReadWorkerSetup(std::istream &stream) -> bool;
   ///
-  void MakeBestTreesPermutation(
-      FlowValue output, const TreeNode &family_node,
-      std::vector<std::optional<const TreeNode *>> &permutation,
-      OutputIndex output_index,
-      std::unordered_map<FlowValue, NumClientsIndex> num_clients_indices);
+  auto SetUpWorkers(WorkerPool &worker_pool) const -> bool;
+  ///
+  auto FindReadRows(std::span<const RowIndex> rows) const
+      -> std::vector<RowIndex>;
+  ///
+  auto ReadRows(std::istream &stream, std::vector<RowIndex> &rows) const
+      -> bool;
+  ///
+  auto ProcessWorkerRequest(const std::string &request) -> std::string;
+  ///
+  void WriteRowRecord(RowIndex row, std::ostream &stream) const;
+  ///
+  auto ReadRowRecords(std::istream &stream, std::uint64_t num_records,
+                      std::vector<bool> &merged_rows) -> bool;
+  ///
+  void FindBestTreesForOutput(RowIndex row);
+  ///
+  auto GetCachedCosts(RowIndex row) const -> std::vector<Cost>;
+  ///
+  auto ClearOutdatedTrees(RowIndex row) -> SearchedFamilies;
+  ///
+  void FindBestTreesForOutput(RowIndex row, FamilyIndex family_index,
+                              const std::vector<RowIndex> &child_rows);
+  ///
+  static auto FindPermutationKernel(int num_outputs) -> PermutationKernel;
+  ///
+  template <int kNumOutputs>
+  void FindBestTreesPermutation(RowIndex row, FamilyIndex family_index,
+                                const std::vector<RowIndex> &child_rows);
+  ///
+  template <int kNumOutputs>
+  void FindPermutationBounds(PermutationSearch<kNumOutputs> &search) const;
+  ///
+  template <int kNumOutputs>
+  auto IsPermutationBounded(const PermutationSearch<kNumOutputs> &search,
+                            OutputIndex output_index,
+                            NumClients permutation_num_clients,
+                            Cost permutation_tree_cost) const;
+  ///
+  template <int kNumOutputs>
+  auto TestBestTreesPermutation(PermutationSearch<kNumOutputs> &search,
+                                OutputIndex output_index);
+  ///
+  template <int kNumOutputs>
+  void MakeBestTreesPermutation(PermutationSearch<kNumOutputs> &search,
+                                OutputIndex output_index);
+  ///
+  auto GetPruneCost(RowIndex row, NumClients num_clients) const {
+    // vh: With alternative layouts, a tree is only pruned when it can't get
+    // into the cheapest ones.
+    if (alternative_trees_.has_value()) {
+      return alternative_trees_->IsFull(row, num_clients)
+                 ? alternative_trees_->GetMaxCost(row, num_clients)
+                 : kNoPruneCost;
+    }
+
+    return best_trees_.HasTree(row, num_clients)
+               ? best_trees_.GetCost(row, num_clients)
+               : kNoPruneCost;
+  }
+  ///
+  void AddTree(RowIndex row, NumClients num_clients, FamilyIndex family_index,
+               Cost cost, std::span<const NumClients> child_num_clients);
+  ///
+  void KeepBeamTrees(RowIndex row);
+  ///
+  void UpdateMinCostPerClient(RowIndex row);
+  ///
+  auto GetNumDoneStates() const -> std::int64_t;
+  ///
+  void UpdateWorkProgress();
+  ///
+  void AddStatistics(const Statistics &statistics);
+  ///
+  static void FindSymmetricOutputs(std::span<const RowIndex> child_rows,
+                                   std::span<OutputIndex> symmetric_outputs);
   ///
   void FindBestRootTree();
+  ///
+  auto FindCachedRootTree() -> bool;
+  ///
+  auto FindLowerBoundCost(NumClients num_clients) const -> Cost;
+  ///
+  auto GetFamily(FamilyIndex family_index) const -> const TreeNode &;
+  ///
+  auto FindChildLevel(RowIndex row, FamilyIndex family_index) const -> int;
+  ///
+  void FindChildRows(RowIndex row, FamilyIndex family_index,
+                     std::vector<RowIndex> &child_rows) const;
+  ///
+  auto MakeTree(RowIndex row, NumClients num_clients) const -> TreeNode;
+  ///
+  auto MakeResult() const -> std::vector<TreeNode>;
+  ///
+  void ReportBestResult() const;
+  ///
+  void FitResultToOutputRange();
+  ///
+  auto IsResultInRange(const std::vector<TreeNode> &trees) const -> bool;
+  ///
+  auto FindClientOutputs(const std::vector<TreeNode> &trees) const
+      -> std::optional<std::pair<FlowValue, FlowValue>>;
+  ///
+  void FindClientOutputs(
+      const TreeNode &tree, const std::vector<FlowValue> &outputs,
+      FlowValue flow,
+      std::optional<std::pair<FlowValue, FlowValue>> &client_outputs) const;
+  ///
+  auto InitLayoutCell(LayoutSearch &search, RowIndex row,
+                      NumClients num_clients) const -> LayoutCell &;
+  ///
+  void AddLayoutCandidate(LayoutSearch &search, LayoutCell &cell,
+                          int tree_index, std::vector<int> child_ranks) const;
+  ///
+  auto FindLayoutDerivation(LayoutSearch &search, RowIndex row,
+                            NumClients num_clients, int rank) const
+      -> const LayoutDerivation *;
+  ///
+  auto MakeLayoutTree(LayoutSearch &search, RowIndex row,
+                      NumClients num_clients, int rank) const -> TreeNode;
 
   ///
   FlowValue min_output_{};
   ///
   FlowValue max_output_{};
   ///
+  FlowValue requested_max_output_{};
+  ///
   NumClients num_clients_{};
   ///
+  core::CalculatorEngine engine_{};
+  ///
+  int num_layouts_{};
+  ///
+  FlowValue flow_step_{};
+  ///
+  FlowValue snapped_flow_step_{};
+  ///
+  bool only_output_trees_{};
+  ///
+  int beam_width_{};
+  ///
+  int max_depth_{};
+  ///
+  int max_devices_{};
+  ///
+  int num_levels_{};
+  ///
+  int num_workers_{};
+  ///
   std::vector<TreeNode> input_nodes_{};
   ///
   TreeNode client_node_{};
   ///
   std::vector<TreeNode> family_nodes_{};
   ///
+  std::vector<TreeNode> exact_input_nodes_{};
+  ///
+  std::vector<TreeNode> exact_family_nodes_{};
+  ///
+  TreeNode root_family_{};
+  ///
   std::function<auto(const Calculator &)->StepStatus> step_callback_{};
   ///
-  std::set<FlowValue> unique_outputs_{};
+  std::function<void(std::vector<TreeNode>)> best_result_callback_{};
+  ///
+  std::shared_ptr<BestTreesCache> best_trees_cache_{};
+  ///
+  BestTreesCache::Key cache_key_{};
+  ///
+  std::optional<BestTreesCache::Entry> cached_entry_{};
+  ///
+  NumClients cached_num_clients_{};
+  ///
+  std::vector<FamilyIndex> cached_family_indices_{};
+  ///
+  std::vector<bool> increased_cost_families_{};
+  ///
+  std::vector<bool> decreased_cost_families_{};
+  ///
+  std::vector<bool> cached_rows_{};
+  ///
+  std::vector<std::uint8_t> changed_rows_{};
+  ///
+  std::shared_ptr<ThreadPool> thread_pool_{};
+  ///
+  std::vector<FlowValue> unique_outputs_{};
+  ///
+  BestTreesTable best_trees_{};
+  ///
+  std::optional<AlternativeTrees> alternative_trees_{};
+  ///
+  std::vector<std::optional<double>> min_costs_per_client_{};
+  ///
+  std::int64_t num_work_units_{};
+  ///
+  std::atomic<std::int64_t> num_done_work_units_{};
+  ///
+  std::atomic<std::int64_t> num_states_at_last_row_{};
+  ///
+  std::atomic<double> num_states_per_work_unit_{};
+  ///
+  std::atomic<bool> stopped_{};
+  ///
+  std::atomic<std::int64_t> num_expanded_nodes_{};
+  ///
+  std::atomic<std::int64_t> num_pruned_nodes_{};
+  ///
+  int num_removed_families_{};
+  ///
+  int num_removed_outputs_{};
+  ///
+  Cost result_cost_{};
   ///
-  std::map<FlowValue, std::map<NumClients, TreeNode>> best_trees_{};
+  Cost lower_bound_cost_{};
 };
 }  // namespace vh::ponc::calc
 
@@ -0,0 +1,57 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_CONVOLUTION_SEARCH_H_
+#define VH_PONC_CALC_CONVOLUTION_SEARCH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "calc_alternative_trees.h"
+#include "calc_best_trees_table.h"
+#include "calc_types.h"
+
+namespace vh::ponc::calc {
+///
+class ConvolutionSearch {
+ public:
+  ///
+  ConvolutionSearch(BestTreesTable &best_trees,
+                    AlternativeTrees *alternative_trees);
+
+  ///
+  void FindBestTrees(RowIndex row, FamilyIndex family_index, Cost node_cost,
+                     const std::vector<RowIndex> &child_rows);
+  ///
+  auto GetNumExpandedNodes() const -> std::int64_t;
+
+ private:
+  ///
+  void FoldOutput(RowIndex child_row, OutputIndex output_index);
+  ///
+  void UpdateBestTrees(RowIndex row, FamilyIndex family_index,
+                       int num_outputs);
+
+  ///
+  BestTreesTable *best_trees_{};
+  ///
+  AlternativeTrees *alternative_trees_{};
+  ///
+  NumClients max_num_clients_{};
+  ///
+  std::vector<Cost> costs_{};
+  ///
+  std::vector<Cost> next_costs_{};
+  ///
+  std::vector<NumClients> choices_{};
+  ///
+  std::vector<NumClients> child_num_clients_{};
+  ///
+  std::int64_t num_expanded_nodes_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_CONVOLUTION_SEARCH_H_
@@ -0,0 +1,60 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_ESTIMATOR_H_
+#define VH_PONC_CALC_ESTIMATOR_H_
+
+#include <cstdint>
+
+#include "calc_calculator.h"
+#include "calc_types.h"
+#include "core_settings.h"
+
+namespace vh::ponc::calc {
+///
+class Estimator {
+ public:
+  ///
+  struct Estimate {
+    ///
+    core::CalculatorEngine engine{};
+    ///
+    int beam_width{};
+    ///
+    int num_outputs{};
+    ///
+    std::int64_t num_states{};
+    ///
+    std::int64_t memory_size{};
+    ///
+    float duration{};
+  };
+
+  ///
+  explicit Estimator(const Calculator::ConstructorArgs &args);
+
+  ///
+  auto EstimateCalculation(core::CalculatorEngine engine, int beam_width) const
+      -> Estimate;
+  ///
+  auto ChooseCalculation() const -> Estimate;
+
+ private:
+  ///
+  auto IsInBudget(const Estimate &estimate) const -> bool;
+
+  ///
+  core::CalculatorSettings settings_{};
+  ///
+  int num_outputs_{};
+  ///
+  int num_families_{};
+  ///
+  int num_family_outputs_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_ESTIMATOR_H_
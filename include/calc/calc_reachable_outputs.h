@@ -0,0 +1,52 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_REACHABLE_OUTPUTS_H_
+#define VH_PONC_CALC_REACHABLE_OUTPUTS_H_
+
+#include <vector>
+
+#include "calc_types.h"
+
+namespace vh::ponc::calc {
+///
+class ReachableOutputs {
+ public:
+  ///
+  struct ConstructorArgs {
+    ///
+    std::vector<FlowValue> start_outputs{};
+    ///
+    std::vector<FlowValue> family_outputs{};
+    ///
+    FlowValue min_output{};
+  };
+
+  ///
+  explicit ReachableOutputs(const ConstructorArgs &args);
+
+  ///
+  auto Contains(FlowValue output) const -> bool;
+  ///
+  auto RemoveOutputsNotLeadingTo(FlowValue min_output, FlowValue max_output)
+      -> int;
+  ///
+  auto GetSortedOutputs() const -> std::vector<FlowValue>;
+
+ private:
+  ///
+  auto GetNumOffsets() const -> int;
+
+  ///
+  FlowValue min_output_{};
+  ///
+  std::vector<FlowValue> family_outputs_{};
+  ///
+  std::vector<bool> outputs_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_REACHABLE_OUTPUTS_H_
@@ -17,6 +17,10 @@ auto ToCalculatorResolution(const std::vector<float> &values)
     -> std::vector<int>;
 ///
 auto FromCalculatorResolution(int value) -> float;
+///
+auto ToCalculatorFlowStep(float flow_resolution) -> int;
+///
+auto SnapToFlowStep(int value, int flow_step) -> int;
 }  // namespace vh::ponc::calc
 
 #endif  // VH_PONC_CALC_RESOLUTION_H_
@@ -0,0 +1,79 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_THREAD_POOL_H_
+#define VH_PONC_CALC_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "cpp_non_copyable.h"
+
+namespace vh::ponc::calc {
+///
+class ThreadPool : public cpp::NonCopyable {
+ public:
+  ///
+  using Task = std::function<void()>;
+
+  ///
+  explicit ThreadPool(int num_threads);
+
+  ///
+  ~ThreadPool() override;
+
+  ///
+  static auto GetNumThreads(int requested_num_threads) -> int;
+
+  ///
+  auto GetSize() const -> int;
+  ///
+  void RunAndWait(std::vector<Task> tasks);
+
+ private:
+  ///
+  struct WorkerQueue {
+    ///
+    std::mutex mutex{};
+    ///
+    std::deque<Task> tasks{};
+  };
+
+  ///
+  void Work(const std::stop_token &stop_token, int queue_index);
+  ///
+  auto PopTask(int queue_index) -> std::optional<Task>;
+  ///
+  auto StealTask(int queue_index) -> std::optional<Task>;
+  ///
+  auto RunNextTask(int queue_index) -> bool;
+
+  ///
+  std::vector<std::unique_ptr<WorkerQueue>> queues_{};
+  ///
+  std::atomic<int> num_pending_tasks_{};
+  ///
+  std::mutex mutex_{};
+  ///
+  std::condition_variable_any tasks_added_{};
+  ///
+  std::condition_variable tasks_finished_{};
+  ///
+  std::uint64_t batch_index_{};
+  ///
+  std::vector<std::jthread> workers_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_THREAD_POOL_H_
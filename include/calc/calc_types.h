@@ -18,6 +18,8 @@ using NumClients = int;
 using OutputIndex = int;
 ///
 using NumClientsIndex = int;
+///
+using FamilyIndex = int;
 }  // namespace vh::ponc::calc
 
 #endif  // VH_PONC_CALC_TYPES_H_
@@ -0,0 +1,61 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CALC_WORKER_POOL_H_
+#define VH_PONC_CALC_WORKER_POOL_H_
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cpp_non_copyable.h"
+
+namespace vh::ponc::calc {
+///
+class WorkerPool : public cpp::NonCopyable {
+ public:
+  ///
+  using Handler = std::function<auto(const std::string &)->std::string>;
+
+  ///
+  static constexpr auto kWorkerExecutable = std::string_view{"ponc-cli"};
+  ///
+  static constexpr auto kWorkerOption = std::string_view{"--calc-worker"};
+
+  ///
+  explicit WorkerPool(int num_workers);
+
+  ///
+  ~WorkerPool() override;
+
+  ///
+  static auto GetNumWorkers(int requested_num_workers) -> int;
+  ///
+  static auto RunWorker(const Handler &handler) -> int;
+
+  ///
+  auto GetSize() const -> int;
+  ///
+  auto Exchange(const std::vector<std::string> &requests)
+      -> std::optional<std::vector<std::string>>;
+
+ private:
+  ///
+  struct Worker {
+    ///
+    int process_id{};
+    ///
+    int socket{};
+  };
+
+  ///
+  std::vector<Worker> workers_{};
+};
+}  // namespace vh::ponc::calc
+
+#endif  // VH_PONC_CALC_WORKER_POOL_H_
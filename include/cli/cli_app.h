@@ -0,0 +1,64 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CLI_APP_H_
+#define VH_PONC_CLI_APP_H_
+
+#include <crude_json.h>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "calc_batch_task.h"
+#include "calc_best_trees_cache.h"
+#include "calc_tree_node.h"
+#include "cli_options.h"
+#include "core_project.h"
+
+namespace vh::ponc::cli {
+///
+class App {
+ public:
+  ///
+  explicit App(Options options);
+
+  ///
+  auto Run() -> int;
+
+ private:
+  ///
+  auto ReadProject() -> bool;
+  ///
+  auto FindDiagramIndices() const -> std::optional<std::vector<int>>;
+  ///
+  auto CalculateDiagrams(const std::vector<int> &diagram_indices,
+                         std::vector<crude_json::value> &diagram_reports)
+      -> std::optional<std::vector<std::optional<int>>>;
+  ///
+  auto CalculateLocally(calc::BatchTask::ConstructorArgs batch_args) const
+      -> std::vector<std::vector<calc::TreeNode>>;
+  ///
+  auto CalculateOnDaemon(const std::vector<int> &diagram_indices) const
+      -> std::optional<std::vector<std::vector<calc::TreeNode>>>;
+  ///
+  auto GetCacheFilePath() const -> std::filesystem::path;
+  ///
+  auto WriteProject() const -> bool;
+  ///
+  auto WriteReport(const crude_json::value &report) const -> bool;
+
+  ///
+  Options options_{};
+  ///
+  std::optional<core::Project> project_{};
+  ///
+  std::shared_ptr<calc::BestTreesCache> best_trees_cache_{};
+};
+}  // namespace vh::ponc::cli
+
+#endif  // VH_PONC_CLI_APP_H_
@@ -0,0 +1,43 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_CLI_OPTIONS_H_
+#define VH_PONC_CLI_OPTIONS_H_
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace vh::ponc::cli {
+///
+struct Options {
+  ///
+  static auto Parse(std::span<char *const> args) -> std::optional<Options>;
+  ///
+  static auto GetUsage() -> std::string;
+
+  ///
+  std::filesystem::path project_file{};
+  ///
+  std::vector<std::string> diagram_names{};
+  ///
+  bool calculate{};
+  ///
+  bool evaluate_flow{};
+  ///
+  std::filesystem::path output_file{};
+  ///
+  std::filesystem::path report_file{};
+  ///
+  std::filesystem::path daemon_socket{};
+  ///
+  int daemon_priority{};
+};
+}  // namespace vh::ponc::cli
+
+#endif  // VH_PONC_CLI_OPTIONS_H_
@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "core_connection.h"
@@ -32,6 +33,9 @@ struct CalculatorFamilySettings {
   float cost{};
 };
 
+///
+enum class CalculatorEngine { kPermutations, kConvolution, kAuto };
+
 ///
 struct CalculatorSettings {
   ///
@@ -41,6 +45,36 @@ struct CalculatorSettings {
   ///
   int num_clients{};
   ///
+  int num_threads{};
+  ///
+  CalculatorEngine engine{};
+  ///
+  bool keep_cache_file{};
+  ///
+  int num_layouts{};
+  ///
+  // vh: Outputs are rounded down to this step before the search, so the flow
+  // of a client is found lower than the real one by less than a step for
+  // each node on its path, counting the input. Results which get above the
+  // max output because of it are searched again.
+  float flow_resolution{};
+  ///
+  int beam_width{};
+  ///
+  float time_budget{};
+  ///
+  int memory_budget{};
+  ///
+  int max_depth{};
+  ///
+  int max_devices{};
+  ///
+  int num_processes{};
+  ///
+  std::string daemon_socket{};
+  ///
+  int daemon_priority{};
+  ///
   std::vector<CalculatorFamilySettings> family_settings{};
 };
 
@@ -9,18 +9,27 @@
 
 #include <imgui_node_editor.h>
 
+#include <chrono>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string_view>
 #include <vector>
 
+#include "calc_batch_task.h"
+#include "calc_best_trees_cache.h"
 #include "calc_calculation_task.h"
+#include "calc_calculator.h"
+#include "calc_estimator.h"
 #include "calc_tree_node.h"
+#include "calc_types.h"
 #include "core_diagram.h"
 #include "core_i_family.h"
 #include "core_id_value.h"
+#include "core_settings.h"
 #include "cpp_safe_ptr.h"
+#include "daemon_task.h"
 
 namespace vh::ponc::coreui {
 ///
@@ -37,22 +46,53 @@ class Calculator {
   ///
   void Calculate();
   ///
+  void CalculateSelected();
+  ///
+  void CalculateDiagrams(const std::vector<int>& diagram_indices);
+  ///
   void Cancel();
   ///
   auto IsRunning() const -> bool;
   ///
   auto GetProgress() const -> float;
+  ///
+  auto GetTimeLeft() const -> std::optional<std::chrono::seconds>;
+  ///
+  auto GetNumJobsAhead() const -> std::optional<int>;
+  ///
+  auto GetBestResult()
+      -> const std::optional<calc::CalculationTask::BestResult>&;
+  ///
+  void AcceptBestResult();
+  ///
+  auto GetCostCurve() const
+      -> const std::vector<calc::Calculator::CostCurvePoint>&;
+  ///
+  void AddCostCurveDiagram(calc::NumClients num_clients);
+  ///
+  void UpdateEstimate();
+  ///
+  auto GetEstimate() const -> const std::optional<calc::Estimator::Estimate>&;
 
  private:
   ///
-  auto ValidateInputs(const std::vector<calc::TreeNode>& input_nodes) const;
+  struct NextResult {
+    ///
+    core::Diagram diagram{};
+    ///
+    std::vector<bool> calculated_free_outputs{};
+    ///
+    std::vector<calc::TreeNode> calculated_trees{};
+  };
+
   ///
-  auto AsFamilyNodes(
-      const std::vector<std::unique_ptr<core::IFamily>>& families) const;
+  void Calculate(std::vector<bool> calculated_free_outputs);
   ///
-  auto PopulateOutput(const calc::TreeNode& output_tree, ne::PinId output_pin);
+  auto UsesDaemon() const -> bool;
   ///
-  auto PopulateDiagram(const std::vector<calc::TreeNode>& calculated_trees);
+  void SubmitToDaemon(std::vector<NextResult> daemon_results);
+  ///
+  auto ValidateInputs(const std::vector<calc::TreeNode>& input_nodes) const;
   ///
   auto ValidateResult(
       const std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>&
@@ -61,14 +101,67 @@ class Calculator {
   void LogResult(const std::vector<calc::TreeNode>& calculated_trees,
                  std::string_view diagram_name) const;
   ///
+  void LogBatchResults(const std::vector<NextResult>& results) const;
+  ///
+  void LogEstimate(const calc::Estimator::Estimate& estimate) const;
+  ///
+  void LogStatistics(const calc::Calculator::Statistics& statistics) const;
+  ///
+  void KeepCostCurve();
+  ///
+  void ProcessCostCurveResult(
+      const std::vector<calc::TreeNode>& calculated_trees);
+  ///
+  void ProcessBatchResults();
+  ///
+  void ProcessDaemonResult();
+  ///
+  void ProcessNextResult();
+  ///
   void ProcessResult(const std::vector<calc::TreeNode>& calculated_trees);
+  ///
+  void ReleaseCalculationTask();
+  ///
+  auto GetCacheFilePath() const -> std::filesystem::path;
+  ///
+  void ReadCacheFile(const core::CalculatorSettings& settings);
+  ///
+  void WriteCacheFile() const;
 
   ///
   cpp::SafePtr<Project> parent_project_;
   ///
   std::optional<core::Diagram> diagram_copy_{};
   ///
-  std::optional<calc::CalculationTask> calculation_task_{};
+  std::vector<bool> calculated_free_outputs_{};
+  ///
+  std::unique_ptr<calc::CalculationTask> calculation_task_{};
+  ///
+  std::vector<std::unique_ptr<calc::CalculationTask>> stopped_tasks_{};
+  ///
+  std::optional<calc::BatchTask> batch_task_{};
+  ///
+  std::vector<core::Diagram> batch_diagrams_{};
+  ///
+  std::optional<daemon::Task> daemon_task_{};
+  ///
+  std::vector<NextResult> daemon_results_{};
+  ///
+  std::shared_ptr<calc::BestTreesCache> best_trees_cache_{};
+  ///
+  std::filesystem::path read_cache_file_path_{};
+  ///
+  std::shared_ptr<const calc::Calculator> cost_curve_calculator_{};
+  ///
+  std::optional<core::Diagram> cost_curve_diagram_{};
+  ///
+  std::vector<bool> cost_curve_free_outputs_{};
+  ///
+  std::vector<calc::Calculator::CostCurvePoint> cost_curve_{};
+  ///
+  std::vector<NextResult> next_results_{};
+  ///
+  std::optional<calc::Estimator::Estimate> estimate_{};
 };
 }  // namespace vh::ponc::coreui
 
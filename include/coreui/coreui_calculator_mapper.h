@@ -0,0 +1,47 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_COREUI_CALCULATOR_MAPPER_H_
+#define VH_PONC_COREUI_CALCULATOR_MAPPER_H_
+
+#include <imgui_node_editor.h>
+
+#include <map>
+#include <vector>
+
+#include "calc_calculator.h"
+#include "calc_tree_node.h"
+#include "core_diagram.h"
+#include "core_id_value.h"
+#include "core_project.h"
+#include "cpp_static_api.h"
+
+namespace vh::ponc::coreui {
+///
+struct CalculatorMapper : public cpp::StaticApi {
+  ///
+  static auto FindCalculatedFreeOutputs(const core::Diagram& diagram,
+                                        const core::Project& project,
+                                        const std::vector<ne::NodeId>& node_ids)
+      -> std::vector<bool>;
+  ///
+  static auto GetInputNodes(const core::Diagram& diagram,
+                            const core::Project& project,
+                            const std::vector<bool>& calculated_free_outputs)
+      -> std::vector<calc::TreeNode>;
+  ///
+  static auto MakeCalculatorArgs(const core::Project& project)
+      -> calc::Calculator::ConstructorArgs;
+  ///
+  static auto PopulateDiagram(
+      core::Diagram& diagram, core::Project& project,
+      const std::vector<bool>& calculated_free_outputs,
+      const std::vector<calc::TreeNode>& calculated_trees)
+      -> std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>;
+};
+}  // namespace vh::ponc::coreui
+
+#endif  // VH_PONC_COREUI_CALCULATOR_MAPPER_H_
@@ -74,6 +74,8 @@ class Project {
   ///
   auto CanSave() const -> bool;
   ///
+  auto GetFilePath() const -> const std::filesystem::path &;
+  ///
   auto Save() -> Event &;
   ///
   auto SaveToFile(std::filesystem::path file_path) -> Event &;
@@ -0,0 +1,77 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_CALCULATION_H_
+#define VH_PONC_DAEMON_CALCULATION_H_
+
+#include <crude_json.h>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "calc_batch_task.h"
+#include "calc_best_trees_cache.h"
+#include "core_project.h"
+
+namespace vh::ponc::daemon {
+///
+class Calculation {
+ public:
+  ///
+  struct ConstructorArgs {
+    ///
+    crude_json::value request{};
+    ///
+    std::shared_ptr<calc::BestTreesCache> best_trees_cache{};
+  };
+
+  ///
+  static auto ValidateRequest(const crude_json::value &request)
+      -> std::optional<std::string>;
+
+  ///
+  explicit Calculation(ConstructorArgs args);
+
+  ///
+  void Stop();
+  ///
+  auto IsRunning() const -> bool;
+  ///
+  auto GetProgress() const -> float;
+  ///
+  auto GetTimeLeft() const -> std::optional<std::chrono::seconds>;
+  ///
+  auto GetResult() -> std::optional<crude_json::value>;
+
+ private:
+  ///
+  struct CalculatedDiagram {
+    ///
+    int diagram_index{};
+    ///
+    std::vector<bool> free_outputs{};
+    ///
+    std::string error{};
+  };
+
+  ///
+  auto MakeDiagramResult(const CalculatedDiagram &calculated_diagram,
+                         const std::vector<calc::TreeNode> &calculated_trees)
+      -> crude_json::value;
+
+  ///
+  std::optional<core::Project> project_{};
+  ///
+  std::vector<CalculatedDiagram> calculated_diagrams_{};
+  ///
+  std::optional<calc::BatchTask> batch_task_{};
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_CALCULATION_H_
@@ -0,0 +1,54 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_JOB_QUEUE_H_
+#define VH_PONC_DAEMON_JOB_QUEUE_H_
+
+#include <crude_json.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "daemon_socket.h"
+
+namespace vh::ponc::daemon {
+///
+using JobId = int;
+
+///
+struct Job {
+  ///
+  JobId id{};
+  ///
+  int priority{};
+  ///
+  std::shared_ptr<Socket> client{};
+  ///
+  crude_json::value request{};
+};
+
+///
+class JobQueue {
+ public:
+  ///
+  auto Push(Job job) -> int;
+  ///
+  auto Pop() -> std::optional<Job>;
+  ///
+  auto Remove(JobId job_id, const std::shared_ptr<Socket> &client) -> bool;
+  ///
+  void RemoveClientJobs(const std::shared_ptr<Socket> &client);
+  ///
+  auto GetJobs() const -> const std::vector<Job> &;
+
+ private:
+  ///
+  std::vector<Job> jobs_{};
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_JOB_QUEUE_H_
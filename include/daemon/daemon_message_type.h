@@ -0,0 +1,34 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_MESSAGE_TYPE_H_
+#define VH_PONC_DAEMON_MESSAGE_TYPE_H_
+
+#include "cpp_static_api.h"
+
+namespace vh::ponc::daemon {
+///
+struct MessageType : public cpp::StaticApi {
+  ///
+  static constexpr auto kSubmit = "submit";
+  ///
+  static constexpr auto kCancel = "cancel";
+  ///
+  static constexpr auto kQueued = "queued";
+  ///
+  static constexpr auto kStarted = "started";
+  ///
+  static constexpr auto kProgress = "progress";
+  ///
+  static constexpr auto kResult = "result";
+  ///
+  static constexpr auto kCancelled = "cancelled";
+  ///
+  static constexpr auto kError = "error";
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_MESSAGE_TYPE_H_
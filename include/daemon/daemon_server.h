@@ -0,0 +1,82 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_SERVER_H_
+#define VH_PONC_DAEMON_SERVER_H_
+
+#include <crude_json.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "calc_best_trees_cache.h"
+#include "daemon_calculation.h"
+#include "daemon_job_queue.h"
+#include "daemon_socket.h"
+
+namespace vh::ponc::daemon {
+///
+class Server {
+ public:
+  ///
+  struct ConstructorArgs {
+    ///
+    std::filesystem::path socket_path{};
+  };
+
+  ///
+  explicit Server(ConstructorArgs args);
+
+  ///
+  auto Run() -> int;
+
+ private:
+  ///
+  void AcceptClient(const Socket &listening_socket);
+  ///
+  auto ReceiveRequests(const std::shared_ptr<Socket> &client) -> bool;
+  ///
+  void ProcessRequest(const std::shared_ptr<Socket> &client,
+                      const crude_json::value &request);
+  ///
+  void Submit(const std::shared_ptr<Socket> &client,
+              crude_json::value request);
+  ///
+  void Cancel(const std::shared_ptr<Socket> &client, JobId job_id);
+  ///
+  void DisconnectClient(const std::shared_ptr<Socket> &client);
+  ///
+  void DisconnectBrokenClients();
+  ///
+  void StartNextJob();
+  ///
+  void ProcessRunningJob();
+  ///
+  void SendQueuePositions() const;
+
+  ///
+  std::filesystem::path socket_path_{};
+  ///
+  std::shared_ptr<calc::BestTreesCache> best_trees_cache_{};
+  ///
+  std::vector<std::shared_ptr<Socket>> clients_{};
+  ///
+  JobQueue job_queue_{};
+  ///
+  JobId next_job_id_{};
+  ///
+  std::optional<Job> running_job_{};
+  ///
+  std::optional<Calculation> calculation_{};
+  ///
+  std::chrono::steady_clock::time_point progress_time_{};
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_SERVER_H_
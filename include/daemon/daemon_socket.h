@@ -0,0 +1,77 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_SOCKET_H_
+#define VH_PONC_DAEMON_SOCKET_H_
+
+#include <crude_json.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vh::ponc::daemon {
+///
+class Socket {
+ public:
+  ///
+  static auto Listen(const std::filesystem::path &path)
+      -> std::optional<Socket>;
+  ///
+  static auto Connect(const std::filesystem::path &path)
+      -> std::optional<Socket>;
+  ///
+  static auto GetDefaultPath() -> std::filesystem::path;
+
+  ///
+  Socket(const Socket &) = delete;
+  ///
+  Socket(Socket &&other) noexcept;
+
+  ///
+  auto operator=(const Socket &) -> Socket & = delete;
+  ///
+  auto operator=(Socket &&) noexcept -> Socket & = delete;
+
+  ///
+  ~Socket();
+
+  ///
+  auto GetDescriptor() const -> int;
+  ///
+  auto Accept() const -> std::optional<Socket>;
+  ///
+  auto SendMessage(const crude_json::value &message) -> bool;
+  ///
+  auto HasPendingData() const -> bool;
+  ///
+  auto SendPendingData() -> bool;
+  ///
+  auto IsBroken() const -> bool;
+  ///
+  auto ReceiveMessages() -> std::optional<std::vector<crude_json::value>>;
+  ///
+  void Shutdown() const;
+
+ private:
+  ///
+  explicit Socket(int descriptor);
+
+  ///
+  int descriptor_{};
+  ///
+  std::filesystem::path bound_path_{};
+  ///
+  std::string pending_data_{};
+  ///
+  std::string received_data_{};
+  ///
+  bool broken_{};
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_SOCKET_H_
@@ -0,0 +1,105 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_DAEMON_TASK_H_
+#define VH_PONC_DAEMON_TASK_H_
+
+#include <crude_json.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "calc_tree_node.h"
+#include "core_diagram.h"
+#include "core_project.h"
+#include "daemon_socket.h"
+
+namespace vh::ponc::daemon {
+///
+class Task {
+ public:
+  ///
+  struct ConstructorArgs {
+    ///
+    std::filesystem::path socket_path{};
+    ///
+    int priority{};
+    ///
+    crude_json::value project{};
+    ///
+    std::vector<crude_json::value> diagrams{};
+  };
+
+  ///
+  struct Result {
+    ///
+    std::vector<std::vector<calc::TreeNode>> calculated_trees{};
+    ///
+    std::string error{};
+  };
+
+  ///
+  static auto WriteProject(const core::Project &project) -> crude_json::value;
+  ///
+  static auto WriteDiagram(const core::Diagram &diagram,
+                           const std::vector<bool> &free_outputs)
+      -> crude_json::value;
+
+  ///
+  explicit Task(ConstructorArgs args);
+
+  ///
+  Task(const Task &) = delete;
+  ///
+  Task(Task &&) noexcept = delete;
+
+  ///
+  auto operator=(const Task &) -> Task & = delete;
+  ///
+  auto operator=(Task &&) noexcept -> Task & = delete;
+
+  ///
+  ~Task();
+
+  ///
+  void Stop();
+  ///
+  auto IsRunning() const -> bool;
+  ///
+  auto GetProgress() const -> float;
+  ///
+  auto GetTimeLeft() const -> std::optional<std::chrono::seconds>;
+  ///
+  auto GetNumJobsAhead() const -> std::optional<int>;
+  ///
+  auto GetResult() -> std::optional<Result>;
+
+ private:
+  ///
+  auto Exchange(const std::filesystem::path &socket_path,
+                const crude_json::value &request) -> Result;
+  ///
+  void ProcessEvent(const crude_json::value &event);
+
+  ///
+  std::optional<Socket> socket_{};
+  ///
+  std::future<Result> task_{};
+  ///
+  std::atomic<float> progress_{};
+  ///
+  std::atomic<int> time_left_{-1};
+  ///
+  std::atomic<int> num_jobs_ahead_{-1};
+};
+}  // namespace vh::ponc::daemon
+
+#endif  // VH_PONC_DAEMON_TASK_H_
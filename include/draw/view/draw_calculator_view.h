@@ -7,11 +7,13 @@
 #ifndef VH_PONC_DRAW_CALCULATOR_VIEW_H_
 #define VH_PONC_DRAW_CALCULATOR_VIEW_H_
 
+#include <set>
 #include <string>
 
 #include "core_project.h"
 #include "coreui_calculator.h"
 #include "draw_i_view.h"
+#include "draw_string_buffer.h"
 
 namespace vh::ponc::draw {
 ///
@@ -22,6 +24,14 @@ class CalculatorView : public IView {
 
   ///
   void Draw(coreui::Calculator& calculator, core::Project& project);
+
+ private:
+  ///
+  int cost_curve_point_index_{};
+  ///
+  std::set<std::string> skipped_diagrams_{};
+  ///
+  StringBuffer daemon_socket_buffer_{};
 };
 }  // namespace vh::ponc::draw
 
@@ -14,6 +14,20 @@
 namespace vh::ponc::json {
 ///
 struct ContainerSerializer : public cpp::StaticApi {
+  ///
+  static auto CanParseFromJson(const crude_json::value& json,
+                               const auto& item_checker) {
+    if (!json.is_array()) {
+      return false;
+    }
+
+    const auto& items_json = json.get<crude_json::array>();
+    return std::all_of(items_json.cbegin(), items_json.cend(),
+                       [&item_checker](const auto& item_json) {
+                         return item_checker(item_json);
+                       });
+  }
+
   ///
   template <typename Item>
   static auto ParseFromJson(const crude_json::value& json,
@@ -20,6 +20,10 @@ namespace vh::ponc::json {
 ///
 struct DiagramSerializer : public cpp::StaticApi {
   ///
+  static auto CanParseFromJson(
+      const crude_json::value &json,
+      const std::vector<std::unique_ptr<core::IFamily>> &families) -> bool;
+  ///
   static auto ParseFromJson(
       const crude_json::value &json,
       const std::vector<std::unique_ptr<core::IFamily>> &families)
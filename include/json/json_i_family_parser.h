@@ -20,6 +20,8 @@ namespace vh::ponc::json {
 ///
 class IFamilyParser : public cpp::NonCopyable {
  public:
+  ///
+  auto CanParseFromJson(const crude_json::value &json) const -> bool;
   ///
   auto TryToParseFromJson(const crude_json::value &json) const
       -> std::optional<std::unique_ptr<core::IFamily>>;
@@ -28,6 +30,9 @@ class IFamilyParser : public cpp::NonCopyable {
   ///
   virtual auto GetTypeName() const -> std::string = 0;
   ///
+  virtual auto CanParseDataFromJson(const crude_json::value &json) const
+      -> bool = 0;
+  ///
   virtual auto ParseFromJson(core::FamilyId parsed_id,
                              const crude_json::value &json) const
       -> std::unique_ptr<core::IFamily> = 0;
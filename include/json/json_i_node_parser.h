@@ -18,12 +18,17 @@ namespace vh::ponc::json {
 ///
 class INodeParser : public cpp::NonCopyable {
  public:
+  ///
+  auto CanParseFromJson(const crude_json::value &json) const -> bool;
   ///
   auto ParseFromJson(const crude_json::value &json) const
       -> std::unique_ptr<core::INode>;
 
  private:
   ///
+  virtual auto CanParseDataFromJson(const crude_json::value &json) const
+      -> bool = 0;
+  ///
   virtual auto ParseFromJson(const core::INode::ConstructorArgs &parsed_args,
                              const crude_json::value &json) const
       -> std::unique_ptr<core::INode> = 0;
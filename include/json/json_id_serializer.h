@@ -12,10 +12,18 @@
 #include "core_concepts.h"
 #include "core_id_value.h"
 #include "cpp_static_api.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
 ///
 struct IdSerializer : public cpp::StaticApi {
+  ///
+  static auto CanParseFromJson(const crude_json::value &json) {
+    // vh: Larger numbers lose precision, so IDs would not match.
+    constexpr auto kMaxIdValue = static_cast<crude_json::number>(1ULL << 53U);
+    return ValueChecker::IsInteger(json, 0, kMaxIdValue);
+  }
+
   ///
   template <core::Id Id>
   static auto ParseFromJson(const crude_json::value &json) {
@@ -15,6 +15,8 @@
 namespace vh::ponc::json {
 ///
 struct LinkSerializer : public cpp::StaticApi {
+  ///
+  static auto CanParseFromJson(const crude_json::value &json) -> bool;
   ///
   static auto ParseFromJson(const crude_json::value &json) -> core::Link;
   ///
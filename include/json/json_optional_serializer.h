@@ -14,6 +14,13 @@
 namespace vh::ponc::json {
 ///
 struct OptionalSerializer : public cpp::StaticApi {
+  ///
+  static auto CanParseFromJson(const crude_json::value& json,
+                               const crude_json::string& item_name,
+                               const auto& item_checker) {
+    return !json.contains(item_name) || item_checker(json[item_name]);
+  }
+
   ///
   template <typename Item>
   static auto ParseFromJson(const crude_json::value& json,
@@ -12,6 +12,7 @@
 #include <memory>
 #include <vector>
 
+#include "core_i_family.h"
 #include "core_project.h"
 #include "cpp_static_api.h"
 #include "json_i_family_parser.h"
@@ -20,6 +21,16 @@ namespace vh::ponc::json {
 ///
 struct ProjectSerializer : public cpp::StaticApi {
   ///
+  static auto CanParseFromJson(
+      const crude_json::value &json,
+      const std::vector<std::unique_ptr<IFamilyParser>> &family_parsers)
+      -> bool;
+  ///
+  static auto ParseFamiliesFromJson(
+      const crude_json::value &json,
+      const std::vector<std::unique_ptr<IFamilyParser>> &family_parsers)
+      -> std::vector<std::unique_ptr<core::IFamily>>;
+  ///
   static auto ParseFromJson(
       const crude_json::value &json,
       const std::vector<std::unique_ptr<IFamilyParser>> &family_parsers)
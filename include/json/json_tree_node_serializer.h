@@ -0,0 +1,26 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_JSON_TREE_NODE_SERIALIZER_H_
+#define VH_PONC_JSON_TREE_NODE_SERIALIZER_H_
+
+#include <crude_json.h>
+
+#include "calc_tree_node.h"
+#include "cpp_static_api.h"
+
+namespace vh::ponc::json {
+///
+struct TreeNodeSerializer : public cpp::StaticApi {
+  ///
+  static auto ParseFromJson(const crude_json::value &json) -> calc::TreeNode;
+  ///
+  static auto WriteToJson(const calc::TreeNode &tree_node)
+      -> crude_json::value;
+};
+}  // namespace vh::ponc::json
+
+#endif  // VH_PONC_JSON_TREE_NODE_SERIALIZER_H_
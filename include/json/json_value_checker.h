@@ -0,0 +1,53 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#ifndef VH_PONC_JSON_VALUE_CHECKER_H_
+#define VH_PONC_JSON_VALUE_CHECKER_H_
+
+#include <crude_json.h>
+
+#include <limits>
+
+#include "cpp_static_api.h"
+
+namespace vh::ponc::json {
+///
+struct ValueChecker : public cpp::StaticApi {
+  ///
+  static auto HasValue(const crude_json::value &json,
+                       const crude_json::string &key) -> bool;
+  ///
+  static auto HasValue(const crude_json::value &json,
+                       const crude_json::string &key,
+                       const auto &value_checker) -> bool {
+    return HasValue(json, key) && value_checker(json[key]);
+  }
+  ///
+  static auto HasBoolean(const crude_json::value &json,
+                         const crude_json::string &key) -> bool;
+  ///
+  static auto HasNumber(const crude_json::value &json,
+                        const crude_json::string &key) -> bool;
+  ///
+  static auto HasInteger(const crude_json::value &json,
+                         const crude_json::string &key) -> bool;
+  ///
+  static auto HasString(const crude_json::value &json,
+                        const crude_json::string &key) -> bool;
+  ///
+  static auto HasNumberArray(const crude_json::value &json,
+                             const crude_json::string &key, int size) -> bool;
+  ///
+  static auto IsInteger(
+      const crude_json::value &json,
+      crude_json::number min = std::numeric_limits<int>::min(),
+      crude_json::number max = std::numeric_limits<int>::max()) -> bool;
+  ///
+  static auto IsNumberArray(const crude_json::value &json, int size) -> bool;
+};
+}  // namespace vh::ponc::json
+
+#endif  // VH_PONC_JSON_VALUE_CHECKER_H_
@@ -19,6 +19,16 @@ enum class Version {
   kSlider,
   kAreas,
   kConnections,
+  kCalculatorThreads,
+  kCalculatorEngine,
+  kCalculatorCache,
+  kCalculatorLayouts,
+  kCalculatorResolution,
+  kCalculatorBeam,
+  kCalculatorBudget,
+  kCalculatorPathLimits,
+  kCalculatorProcesses,
+  kCalculatorDaemon,
   kAfterCurrent
 };
 
@@ -10,12 +10,7 @@
 #include <utility>
 #include <vector>
 
-#include "app_attenuator_family_group.h"
-#include "app_client_family_group.h"
-#include "app_coupler_family_group.h"
-#include "app_input_family_group.h"
-#include "app_splitter_family_group.h"
-#include "core_i_family_group.h"
+#include "app_family_groups.h"
 #include "core_project.h"
 #include "coreui_project.h"
 
@@ -23,25 +18,7 @@ namespace vh::ponc {
 ///
 AppImpl::AppImpl(coreui::Project::Callbacks project_callbacks,
                  draw::MainWindow::Callbacks main_window_callbacks)
-    : project_{[]() {
-                 auto family_groups =
-                     std::vector<std::unique_ptr<core::IFamilyGroup>>{};
-                 family_groups.reserve(5);
-
-                 family_groups.emplace_back(
-                     std::make_unique<InputFamilyGroup>());
-                 family_groups.emplace_back(
-                     std::make_unique<ClientFamilyGroup>());
-                 family_groups.emplace_back(
-                     std::make_unique<SplitterFamilyGroup>());
-                 family_groups.emplace_back(
-                     std::make_unique<CouplerFamilyGroup>());
-                 family_groups.emplace_back(
-                     std::make_unique<AttenuatorFamilyGroup>());
-
-                 return family_groups;
-               }(),
-               std::move(project_callbacks)},
+    : project_{CreateFamilyGroups(), std::move(project_callbacks)},
       main_window_callbacks_{std::move(main_window_callbacks)} {}
 
 ///
@@ -55,6 +55,12 @@ class Node : public core::INode {
 ///
 class NodeParser : public json::INodeParser {
  private:
+  ///
+  auto CanParseDataFromJson(const crude_json::value& /*unused*/) const
+      -> bool override {
+    return true;
+  }
+
   ///
   auto ParseFromJson(const core::INode::ConstructorArgs& parsed_args,
                      const crude_json::value& /*unused*/) const
@@ -165,6 +171,12 @@ class FamilyParser : public json::IFamilyParser {
   ///
   auto GetTypeName() const -> std::string override { return kTypeName; }
 
+  ///
+  auto CanParseDataFromJson(const crude_json::value& /*unused*/) const
+      -> bool override {
+    return true;
+  }
+
   ///
   auto ParseFromJson(core::FamilyId parsed_id,
                      const crude_json::value& /*unused*/) const
@@ -33,6 +33,8 @@
 #include "json_i_family_writer.h"
 #include "json_i_node_parser.h"
 #include "json_i_node_writer.h"
+#include "json_optional_serializer.h"
+#include "json_value_checker.h"
 #include "style_tailwind.h"
 #include "style_utils.h"
 
@@ -342,6 +344,14 @@ class NodeParser : public json::INodeParser {
       : family_{std::move(family)} {}
 
  private:
+  ///
+  auto CanParseDataFromJson(const crude_json::value& json) const
+      -> bool override {
+    return json::OptionalSerializer::CanParseFromJson(
+        json, "reverse_order",
+        [](const auto& json) { return json.is_boolean(); });
+  }
+
   ///
   auto ParseFromJson(const core::INode::ConstructorArgs& parsed_args,
                      const crude_json::value& json) const
@@ -372,6 +382,14 @@ class FamilyParser : public json::IFamilyParser {
   ///
   auto GetTypeName() const -> std::string override { return kTypeName; }
 
+  ///
+  auto CanParseDataFromJson(const crude_json::value& json) const
+      -> bool override {
+    return json::ValueChecker::HasValue(json, "percentage_index") &&
+           json::ValueChecker::IsInteger(json["percentage_index"], 0,
+                                         static_cast<int>(kDrops.size()) - 1);
+  }
+
   ///
   auto ParseFromJson(core::FamilyId parsed_id,
                      const crude_json::value& json) const
@@ -0,0 +1,60 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "app_family_groups.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "app_attenuator_family_group.h"
+#include "app_client_family_group.h"
+#include "app_coupler_family_group.h"
+#include "app_input_family_group.h"
+#include "app_splitter_family_group.h"
+#include "core_i_family_group.h"
+#include "json_i_family_parser.h"
+
+namespace vh::ponc {
+///
+auto CreateFamilyGroups() -> std::vector<std::unique_ptr<core::IFamilyGroup>> {
+  auto family_groups = std::vector<std::unique_ptr<core::IFamilyGroup>>{};
+  family_groups.reserve(5);
+
+  family_groups.emplace_back(std::make_unique<InputFamilyGroup>());
+  family_groups.emplace_back(std::make_unique<ClientFamilyGroup>());
+  family_groups.emplace_back(std::make_unique<SplitterFamilyGroup>());
+  family_groups.emplace_back(std::make_unique<CouplerFamilyGroup>());
+  family_groups.emplace_back(std::make_unique<AttenuatorFamilyGroup>());
+
+  return family_groups;
+}
+
+///
+auto CreateFamilyParsers()
+    -> std::vector<std::unique_ptr<json::IFamilyParser>> {
+  // vh: Projects also have families of the default groups, which the editor
+  // adds to the ones of the application.
+  auto family_groups = CreateFamilyGroups();
+  auto default_family_groups = core::IFamilyGroup::CreateDefaultFamilyGroups();
+
+  family_groups.insert(family_groups.cend(),
+                       std::move_iterator{default_family_groups.begin()},
+                       std::move_iterator{default_family_groups.end()});
+
+  auto family_parsers = std::vector<std::unique_ptr<json::IFamilyParser>>{};
+  family_parsers.reserve(family_groups.size());
+
+  std::transform(family_groups.cbegin(), family_groups.cend(),
+                 std::back_inserter(family_parsers),
+                 [](const auto& family_group) {
+                   return family_group->CreateFamilyParser();
+                 });
+
+  return family_parsers;
+}
+}  // namespace vh::ponc
@@ -28,6 +28,7 @@
 #include "json_i_family_writer.h"
 #include "json_i_node_parser.h"
 #include "json_i_node_writer.h"
+#include "json_value_checker.h"
 #include "style_tailwind.h"
 
 namespace vh::ponc {
@@ -82,6 +83,12 @@ class Node : public core::INode {
 ///
 class NodeParser : public json::INodeParser {
  private:
+  ///
+  auto CanParseDataFromJson(const crude_json::value& json) const
+      -> bool override {
+    return json::ValueChecker::HasNumber(json, "value");
+  }
+
   ///
   auto ParseFromJson(const core::INode::ConstructorArgs& parsed_args,
                      const crude_json::value& json) const
@@ -231,6 +238,12 @@ class FamilyParser : public json::IFamilyParser {
   ///
   auto GetTypeName() const -> std::string override { return kTypeName; }
 
+  ///
+  auto CanParseDataFromJson(const crude_json::value& /*unused*/) const
+      -> bool override {
+    return true;
+  }
+
   ///
   auto ParseFromJson(core::FamilyId parsed_id,
                      const crude_json::value& /*unused*/) const
@@ -30,6 +30,7 @@
 #include "flow_node_flow.h"
 #include "json_i_family_writer.h"
 #include "json_i_node_parser.h"
+#include "json_value_checker.h"
 #include "style_tailwind.h"
 #include "style_utils.h"
 
@@ -222,6 +223,12 @@ class Family : public core::IFamily {
 ///
 class NodeParser : public json::INodeParser {
  private:
+  ///
+  auto CanParseDataFromJson(const crude_json::value& /*unused*/) const
+      -> bool override {
+    return true;
+  }
+
   ///
   auto ParseFromJson(const core::INode::ConstructorArgs& parsed_args,
                      const crude_json::value& /*unused*/) const
@@ -237,6 +244,8 @@ auto CreateFamilyNodeParser() -> std::unique_ptr<json::INodeParser> {
 
 ///
 constexpr auto kTypeName = "Splitter";
+///
+constexpr auto kMaxNumOutputPins = 16;
 
 ///
 class FamilyParser : public json::IFamilyParser {
@@ -244,6 +253,16 @@ class FamilyParser : public json::IFamilyParser {
   ///
   auto GetTypeName() const -> std::string override { return kTypeName; }
 
+  ///
+  auto CanParseDataFromJson(const crude_json::value& json) const
+      -> bool override {
+    // vh: Group makes splitters of up to 16 outputs, drops of larger ones
+    // are unknown.
+    return json::ValueChecker::HasValue(json, "num_output_pins") &&
+           json::ValueChecker::IsInteger(json["num_output_pins"], 1,
+                                         kMaxNumOutputPins);
+  }
+
   ///
   auto ParseFromJson(core::FamilyId parsed_id,
                      const crude_json::value& json) const
@@ -0,0 +1,339 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "bench_app.h"
+
+#include <crude_json.h>
+
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench_checker.h"
+#include "bench_options.h"
+#include "bench_runner.h"
+#include "bench_scenario.h"
+#include "calc_resolution.h"
+#include "calc_worker_pool.h"
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+namespace {
+///
+constexpr auto kBytesPerMegabyte = 1024. * 1024.;
+///
+constexpr auto kMinComparedWallTime = 0.05;
+///
+constexpr auto kReportIndent = 2;
+
+///
+auto GetEngineName(core::CalculatorEngine engine) -> std::string {
+  switch (engine) {
+    case core::CalculatorEngine::kPermutations:
+      return "permutations";
+    case core::CalculatorEngine::kConvolution:
+      return "convolution";
+    case core::CalculatorEngine::kAuto:
+      return "auto";
+  }
+
+  return {};
+}
+
+///
+auto MakeSettings(const Options &options) {
+  // vh: Everything besides the engine and threads is fixed, so reports of
+  // different builds compare the same work.
+  return core::CalculatorSettings{.num_threads = options.num_threads,
+                                  .engine = options.engine,
+                                  .num_layouts = 1,
+                                  .flow_resolution = 0.01F};
+}
+
+///
+auto WriteScenario(const Scenario &scenario) {
+  auto json = crude_json::value{};
+  json["name"] = scenario.name;
+  json["families"] = Scenario::GetFamilySetName(scenario.family_set);
+  json["clients"] = static_cast<crude_json::number>(scenario.num_clients);
+  json["inputs"] = static_cast<crude_json::number>(scenario.num_inputs);
+  json["min_output"] = static_cast<crude_json::number>(scenario.min_output);
+  json["max_output"] = static_cast<crude_json::number>(scenario.max_output);
+  return json;
+}
+
+///
+void WriteMeasurement(const Measurement &measurement,
+                      crude_json::value &json) {
+  json["wall_time"] = measurement.wall_time;
+  json["expanded_states"] =
+      static_cast<crude_json::number>(measurement.num_expanded_nodes);
+  json["pruned_states"] =
+      static_cast<crude_json::number>(measurement.num_pruned_nodes);
+  json["peak_rss_mb"] =
+      static_cast<crude_json::number>(measurement.peak_memory_size) /
+      kBytesPerMegabyte;
+  json["cost"] = static_cast<crude_json::number>(
+      calc::FromCalculatorResolution(measurement.cost));
+  json["result_clients"] =
+      static_cast<crude_json::number>(measurement.num_clients);
+}
+
+///
+void PrintMeasurement(const Measurement &measurement) {
+  std::cerr << measurement.wall_time << " s, "
+            << measurement.num_expanded_nodes << " states, "
+            << static_cast<int>(static_cast<double>(
+                                    measurement.peak_memory_size) /
+                                kBytesPerMegabyte)
+            << " MB, " << calc::FromCalculatorResolution(measurement.cost)
+            << "$ for " << measurement.num_clients << " clients\n";
+}
+
+///
+auto MakeFilteredScenarios(const std::string &filter) {
+  auto scenarios = Scenario::MakeScenarios();
+  std::erase_if(scenarios, [&filter](const auto &scenario) {
+    return scenario.name.find(filter) == std::string::npos;
+  });
+  return scenarios;
+}
+
+///
+void PrintScenarioIndex(const std::vector<Scenario> &scenarios, int index) {
+  std::cerr << "[" << (index + 1) << "/" << scenarios.size() << "] "
+            << scenarios[index].name << ": " << std::flush;
+}
+
+///
+auto RunCheck(Check check, const Scenario &scenario,
+              const core::CalculatorSettings &settings) {
+  switch (check) {
+    case Check::kWorkers:
+      return Checker::CheckWorkers(scenario, settings);
+    case Check::kResolution:
+      return Checker::CheckResolution(scenario, settings);
+    case Check::kNone:
+    case Check::kEngines:
+      break;
+  }
+
+  return Checker::CheckEngines(scenario, settings);
+}
+
+///
+auto GetNumber(const crude_json::value &json, const std::string &key) {
+  if (!json.contains(key) || !json[key].is_number()) {
+    return crude_json::number{};
+  }
+
+  return json[key].get<crude_json::number>();
+}
+
+///
+auto CompareScenario(const crude_json::value &scenario,
+                     const crude_json::value &baseline, float tolerance) {
+  const auto &name = scenario["name"].get<crude_json::string>();
+  auto regressed = false;
+
+  const auto print_regression = [&name, &regressed]() -> auto & {
+    regressed = true;
+    return std::cerr << name << ": ";
+  };
+
+  const auto cost = GetNumber(scenario, "cost");
+  const auto num_clients = GetNumber(scenario, "result_clients");
+  const auto baseline_cost = GetNumber(baseline, "cost");
+  const auto baseline_num_clients = GetNumber(baseline, "result_clients");
+
+  // vh: Search is deterministic for the fixed settings, so any other result
+  // is a change of the search. Convolution is also exact, so for it a
+  // cheaper result is a bug as well, while permutations could miss the best
+  // trees and a cheaper result there only has to be checked.
+  if ((cost != baseline_cost) || (num_clients != baseline_num_clients)) {
+    print_regression() << "result changed from " << baseline_cost << "$ for "
+                       << baseline_num_clients << " clients to " << cost
+                       << "$ for " << num_clients << " clients\n";
+  }
+
+  const auto max_ratio = 1 + tolerance / 100;
+
+  for (const auto *key : {"wall_time", "expanded_states", "peak_rss_mb"}) {
+    const auto value = GetNumber(scenario, key);
+    const auto baseline_value = GetNumber(baseline, key);
+
+    // vh: Short runs are mostly noise, so their time is not compared.
+    if ((std::string_view{key} == "wall_time") &&
+        (baseline_value < kMinComparedWallTime)) {
+      continue;
+    }
+
+    if ((baseline_value > 0) && (value > baseline_value * max_ratio)) {
+      print_regression() << key << " grew from " << baseline_value << " to "
+                         << value << "\n";
+    }
+  }
+
+  return !regressed;
+}
+}  // namespace
+
+///
+App::App(Options options) : options_{std::move(options)} {}
+
+///
+auto App::Run() -> int {
+  if (options_.check != Check::kNone) {
+    return RunChecks() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  const auto report = RunScenarios();
+  auto succeeded = WriteReport(report);
+
+  if (!options_.baseline_file.empty()) {
+    succeeded = CompareWithBaseline(report) && succeeded;
+  }
+
+  for (const auto &scenario : report["scenarios"].get<crude_json::array>()) {
+    succeeded = succeeded && !scenario.contains("error");
+  }
+
+  return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+///
+auto App::RunScenarios() const -> crude_json::value {
+  const auto settings = MakeSettings(options_);
+
+  const auto scenarios = MakeFilteredScenarios(options_.filter);
+  auto scenarios_json = crude_json::array{};
+  scenarios_json.reserve(scenarios.size());
+
+  for (auto index = 0; index < static_cast<int>(scenarios.size()); ++index) {
+    const auto &scenario = scenarios[index];
+    PrintScenarioIndex(scenarios, index);
+
+    auto &scenario_json = scenarios_json.emplace_back(WriteScenario(scenario));
+    const auto measurement = Runner::Measure(scenario, settings);
+
+    if (!measurement.has_value()) {
+      std::cerr << "failed\n";
+      scenario_json["error"] = "Calculation failed.";
+      continue;
+    }
+
+    PrintMeasurement(*measurement);
+    WriteMeasurement(*measurement, scenario_json);
+  }
+
+  auto report = crude_json::value{};
+  report["engine"] = GetEngineName(options_.engine);
+  report["threads"] = static_cast<crude_json::number>(options_.num_threads);
+  report["scenarios"] = std::move(scenarios_json);
+  return report;
+}
+
+///
+auto App::RunChecks() const -> bool {
+  // vh: Calculator finds the rows in this process if it could not start the
+  // workers, which would pass the check without checking them.
+  if ((options_.check == Check::kWorkers) && !Checker::CanRunWorkers()) {
+    std::cerr << "Couldn't start worker processes. "
+              << calc::WorkerPool::kWorkerExecutable
+              << " must be next to ponc_calc_bench.\n";
+    return false;
+  }
+
+  const auto settings = MakeSettings(options_);
+  const auto scenarios = MakeFilteredScenarios(options_.filter);
+  auto num_failed = 0;
+
+  for (auto index = 0; index < static_cast<int>(scenarios.size()); ++index) {
+    PrintScenarioIndex(scenarios, index);
+
+    if (!RunCheck(options_.check, scenarios[index], settings)) {
+      ++num_failed;
+    }
+  }
+
+  std::cerr << "Checked " << scenarios.size() << " scenarios: " << num_failed
+            << " failed.\n";
+  return num_failed == 0;
+}
+
+///
+auto App::CompareWithBaseline(const crude_json::value &report) const -> bool {
+  const auto [baseline, loaded] =
+      crude_json::value::load(options_.baseline_file.string());
+
+  if (!loaded || !baseline.contains("scenarios") ||
+      !baseline["scenarios"].is_array()) {
+    std::cerr << "Couldn't read baseline from "
+              << options_.baseline_file.string() << "\n";
+    return false;
+  }
+
+  if (!baseline.contains("engine") || !baseline["engine"].is_string() ||
+      (baseline["engine"].get<crude_json::string>() !=
+       report["engine"].get<crude_json::string>()) ||
+      (GetNumber(baseline, "threads") != GetNumber(report, "threads"))) {
+    std::cerr << "Baseline was made with another engine or threads.\n";
+  }
+
+  auto baseline_scenarios = std::map<std::string, const crude_json::value *>{};
+
+  for (const auto &scenario : baseline["scenarios"].get<crude_json::array>()) {
+    if (scenario.contains("name") && scenario["name"].is_string() &&
+        !scenario.contains("error")) {
+      baseline_scenarios.emplace(scenario["name"].get<crude_json::string>(),
+                                 &scenario);
+    }
+  }
+
+  auto succeeded = true;
+  auto num_compared = 0;
+
+  for (const auto &scenario : report["scenarios"].get<crude_json::array>()) {
+    const auto baseline_scenario =
+        baseline_scenarios.find(scenario["name"].get<crude_json::string>());
+
+    if ((baseline_scenario == baseline_scenarios.cend()) ||
+        scenario.contains("error")) {
+      continue;
+    }
+
+    ++num_compared;
+    succeeded = CompareScenario(scenario, *baseline_scenario->second,
+                                options_.tolerance) &&
+                succeeded;
+  }
+
+  std::cerr << "Compared " << num_compared << " scenarios with baseline: "
+            << (succeeded ? "no regressions" : "regressed") << ".\n";
+  return succeeded;
+}
+
+///
+auto App::WriteReport(const crude_json::value &report) const -> bool {
+  if (options_.output_file.empty()) {
+    std::cout << report.dump(kReportIndent) << "\n";
+    return true;
+  }
+
+  if (!report.save(options_.output_file.string(), kReportIndent)) {
+    std::cerr << "Couldn't write report to " << options_.output_file.string()
+              << "\n";
+    return false;
+  }
+
+  return true;
+}
+}  // namespace vh::ponc::bench
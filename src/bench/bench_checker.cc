@@ -0,0 +1,322 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "bench_checker.h"
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_scenario.h"
+#include "calc_calculator.h"
+#include "calc_resolution.h"
+#include "calc_tree_node.h"
+#include "calc_types.h"
+#include "calc_worker_pool.h"
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+namespace {
+///
+constexpr auto kNumCheckedWorkers = std::array{2, 4};
+///
+constexpr auto kCheckedFlowResolutions = std::array{0.1F, 0.25F, 0.5F};
+
+///
+struct CheckedResult {
+  ///
+  calc::Cost cost{};
+  ///
+  calc::NumClients num_clients{};
+  ///
+  std::string error{};
+};
+
+///
+class ResultChecker {
+ public:
+  ///
+  explicit ResultChecker(const calc::Calculator::ConstructorArgs &args)
+      : args_{&args},
+        min_output_{calc::ToCalculatorResolution(args.settings.min_output)},
+        max_output_{calc::ToCalculatorResolution(args.settings.max_output)} {}
+
+  ///
+  auto Check(const std::vector<calc::TreeNode> &result) -> CheckedResult {
+    auto checked_result = CheckedResult{};
+
+    if (result.size() != args_->input_nodes.size()) {
+      checked_result.error = "result has another number of inputs";
+      return checked_result;
+    }
+
+    for (auto input_index = 0; input_index < static_cast<int>(result.size());
+         ++input_index) {
+      const auto &input_node = args_->input_nodes[input_index];
+      const auto &input_tree = result[input_index];
+
+      if (input_tree.family_id != input_node.family_id) {
+        checked_result.error = "input is replaced";
+        return checked_result;
+      }
+
+      // vh: Outputs of the inputs are absolute, the ones of the families are
+      // added to the flow they get.
+      checked_result.error =
+          CheckTree(input_tree, input_node.node_cost, input_node.outputs, 0);
+
+      if (!checked_result.error.empty()) {
+        return checked_result;
+      }
+
+      checked_result.cost += input_tree.tree_cost;
+      checked_result.num_clients += input_tree.num_clients;
+    }
+
+    if (checked_result.num_clients > args_->settings.num_clients) {
+      checked_result.error = "result has too many clients";
+    }
+
+    return checked_result;
+  }
+
+ private:
+  ///
+  // NOLINTNEXTLINE(*-no-recursion)
+  auto CheckTree(const calc::TreeNode &tree, calc::Cost node_cost,
+                 const std::vector<calc::FlowValue> &outputs,
+                 calc::FlowValue flow) const -> std::string {
+    auto tree_cost = node_cost;
+    auto num_clients = 0;
+
+    for (const auto &[output_index, child_tree] : tree.child_nodes) {
+      if ((output_index < 0) ||
+          (output_index >= static_cast<int>(outputs.size()))) {
+        return "tree uses a missing output";
+      }
+
+      const auto child_flow = flow + outputs[output_index];
+
+      if (child_tree.num_clients <= 0) {
+        return "tree has a branch without clients";
+      }
+
+      tree_cost += child_tree.tree_cost;
+      num_clients += child_tree.num_clients;
+
+      if (child_tree.family_id == args_->client_node.family_id) {
+        if ((child_flow < min_output_) || (child_flow > max_output_)) {
+          auto error = std::ostringstream{};
+          error << "client gets "
+                << calc::FromCalculatorResolution(child_flow)
+                << " dB, out of the output range";
+          return std::move(error).str();
+        }
+
+        if (!child_tree.child_nodes.empty() ||
+            (child_tree.num_clients != args_->client_node.num_clients) ||
+            (child_tree.tree_cost != args_->client_node.tree_cost)) {
+          return "client tree is broken";
+        }
+
+        continue;
+      }
+
+      const auto family_node = std::find_if(
+          args_->family_nodes.cbegin(), args_->family_nodes.cend(),
+          [family_id = child_tree.family_id](const auto &family_node) {
+            return family_node.family_id == family_id;
+          });
+
+      if (family_node == args_->family_nodes.cend()) {
+        return "tree uses an unknown family";
+      }
+
+      if (auto error = CheckTree(child_tree, family_node->node_cost,
+                                 family_node->outputs, child_flow);
+          !error.empty()) {
+        return error;
+      }
+    }
+
+    if ((tree.tree_cost != tree_cost) || (tree.num_clients != num_clients)) {
+      return "tree cost or clients don't match its children";
+    }
+
+    return {};
+  }
+
+  ///
+  const calc::Calculator::ConstructorArgs *args_{};
+  ///
+  calc::FlowValue min_output_{};
+  ///
+  calc::FlowValue max_output_{};
+};
+
+///
+auto Calculate(const Scenario &scenario, core::CalculatorSettings settings,
+               core::CalculatorEngine engine) {
+  settings.engine = engine;
+
+  const auto calculator_args =
+      Scenario::MakeCalculatorArgs(scenario, settings);
+  auto calculator = calc::Calculator{calculator_args};
+
+  return ResultChecker{calculator_args}.Check(calculator.TakeResult());
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+auto AreTreesEqual(const calc::TreeNode &left, const calc::TreeNode &right) {
+  if ((left.family_id != right.family_id) ||
+      (left.tree_cost != right.tree_cost) ||
+      (left.num_clients != right.num_clients) ||
+      (left.child_nodes.size() != right.child_nodes.size())) {
+    return false;
+  }
+
+  return std::equal(left.child_nodes.cbegin(), left.child_nodes.cend(),
+                    right.child_nodes.cbegin(),
+                    [](const auto &left_child, const auto &right_child) {
+                      return (left_child.first == right_child.first) &&
+                             AreTreesEqual(left_child.second,
+                                           right_child.second);
+                    });
+}
+
+///
+void PrintResult(std::string_view name, const CheckedResult &result) {
+  std::cerr << name << " " << calc::FromCalculatorResolution(result.cost)
+            << "$ for " << result.num_clients << " clients";
+}
+}  // namespace
+
+///
+auto Checker::CheckEngines(const Scenario &scenario,
+                           const core::CalculatorSettings &settings) -> bool {
+  const auto permutations_result =
+      Calculate(scenario, settings, core::CalculatorEngine::kPermutations);
+  const auto convolution_result =
+      Calculate(scenario, settings, core::CalculatorEngine::kConvolution);
+
+  PrintResult("permutations", permutations_result);
+  std::cerr << ", ";
+  PrintResult("convolution", convolution_result);
+
+  for (const auto &result : {permutations_result, convolution_result}) {
+    if (!result.error.empty()) {
+      std::cerr << ": " << result.error << "\n";
+      return false;
+    }
+  }
+
+  // vh: Convolution is exact, so it has at least as many clients as
+  // permutations, which could miss the best trees, and for the same number
+  // of clients it costs no more.
+  if ((convolution_result.num_clients < permutations_result.num_clients) ||
+      ((convolution_result.num_clients == permutations_result.num_clients) &&
+       (convolution_result.cost > permutations_result.cost))) {
+    std::cerr << ": convolution is worse than permutations\n";
+    return false;
+  }
+
+  std::cerr << "\n";
+  return true;
+}
+
+///
+auto Checker::CanRunWorkers() -> bool {
+  const auto num_workers = kNumCheckedWorkers.back();
+  return calc::WorkerPool{num_workers}.GetSize() == num_workers;
+}
+
+///
+auto Checker::CheckWorkers(const Scenario &scenario,
+                           const core::CalculatorSettings &settings) -> bool {
+  const auto calculator_args = Scenario::MakeCalculatorArgs(scenario, settings);
+  auto calculator = calc::Calculator{calculator_args};
+  const auto result = calculator.TakeResult();
+  const auto checked_result = ResultChecker{calculator_args}.Check(result);
+
+  PrintResult("in process", checked_result);
+
+  if (!checked_result.error.empty()) {
+    std::cerr << ": " << checked_result.error << "\n";
+    return false;
+  }
+
+  // vh: Workers find the same rows as this process does, only in parts, so
+  // the trees must be the same and not only their cost.
+  for (const auto num_workers : kNumCheckedWorkers) {
+    auto worker_settings = settings;
+    worker_settings.num_processes = num_workers;
+
+    auto worker_calculator = calc::Calculator{
+        Scenario::MakeCalculatorArgs(scenario, worker_settings)};
+    const auto worker_result = worker_calculator.TakeResult();
+
+    if (!std::equal(worker_result.cbegin(), worker_result.cend(),
+                    result.cbegin(), result.cend(), AreTreesEqual)) {
+      std::cerr << ": result of " << num_workers << " workers differs\n";
+      return false;
+    }
+  }
+
+  std::cerr << ", same in workers\n";
+  return true;
+}
+
+///
+auto Checker::CheckResolution(const Scenario &scenario,
+                              const core::CalculatorSettings &settings)
+    -> bool {
+  const auto exact_result = Calculate(scenario, settings, settings.engine);
+  PrintResult("exact", exact_result);
+
+  if (!exact_result.error.empty()) {
+    std::cerr << ": " << exact_result.error << "\n";
+    return false;
+  }
+
+  for (const auto flow_resolution : kCheckedFlowResolutions) {
+    auto coarse_settings = settings;
+    coarse_settings.flow_resolution = flow_resolution;
+
+    // vh: Result is checked with the exact outputs, so a client which the
+    // coarse grid put above the max output fails the check.
+    const auto coarse_result =
+        Calculate(scenario, coarse_settings, settings.engine);
+
+    auto name = std::ostringstream{};
+    name << ", " << flow_resolution << " dB";
+    PrintResult(std::move(name).str(), coarse_result);
+
+    if (!coarse_result.error.empty()) {
+      std::cerr << ": " << coarse_result.error << "\n";
+      return false;
+    }
+
+    // vh: Valid coarse result is also a solution on the exact grid, which
+    // convolution can't miss.
+    if ((settings.engine == core::CalculatorEngine::kConvolution) &&
+        ((coarse_result.num_clients > exact_result.num_clients) ||
+         ((coarse_result.num_clients == exact_result.num_clients) &&
+          (coarse_result.cost < exact_result.cost)))) {
+      std::cerr << ": exact grid is worse than the coarse one\n";
+      return false;
+    }
+  }
+
+  std::cerr << "\n";
+  return true;
+}
+}  // namespace vh::ponc::bench
@@ -0,0 +1,26 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <utility>
+
+#include "bench_app.h"
+#include "bench_options.h"
+
+///
+auto main(int argc, char **argv) -> int {
+  auto options =
+      vh::ponc::bench::Options::Parse(std::span{argv + 1, argv + argc});
+
+  if (!options.has_value()) {
+    std::cerr << vh::ponc::bench::Options::GetUsage();
+    return EXIT_FAILURE;
+  }
+
+  return vh::ponc::bench::App{std::move(*options)}.Run();
+}
@@ -0,0 +1,110 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "bench_options.h"
+
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+///
+auto Options::Parse(std::span<char *const> args) -> std::optional<Options> {
+  auto options = Options{};
+
+  for (auto arg = args.begin(); arg != args.end(); ++arg) {
+    const auto name = std::string_view{*arg};
+
+    if (std::next(arg) == args.end()) {
+      return std::nullopt;
+    }
+
+    // vh: All options take a value.
+    auto value = std::string{*++arg};
+
+    if (name == "--filter") {
+      options.filter = std::move(value);
+    } else if (name == "--engine") {
+      if (value == "permutations") {
+        options.engine = core::CalculatorEngine::kPermutations;
+      } else if (value == "convolution") {
+        options.engine = core::CalculatorEngine::kConvolution;
+      } else {
+        return std::nullopt;
+      }
+    } else if (name == "--check") {
+      if (value == "engines") {
+        options.check = Check::kEngines;
+      } else if (value == "workers") {
+        options.check = Check::kWorkers;
+      } else if (value == "resolution") {
+        options.check = Check::kResolution;
+      } else {
+        return std::nullopt;
+      }
+    } else if (name == "--output") {
+      options.output_file = std::move(value);
+    } else if (name == "--baseline") {
+      options.baseline_file = std::move(value);
+    } else if ((name == "--threads") || (name == "--tolerance")) {
+      try {
+        if (name == "--threads") {
+          options.num_threads = std::stoi(value);
+        } else {
+          options.tolerance = std::stof(value);
+        }
+      } catch (const std::exception &) {
+        return std::nullopt;
+      }
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  if ((options.num_threads < 0) || (options.tolerance < 0)) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+///
+auto Options::GetUsage() -> std::string {
+  return "Usage: ponc_calc_bench [--filter TEXT] [--engine ENGINE]\n"
+         "                       [--threads N] [--output FILE]\n"
+         "                       [--baseline FILE [--tolerance PERCENT]]\n"
+         "       ponc_calc_bench --check CHECK [--filter TEXT]\n"
+         "                       [--engine ENGINE] [--threads N]\n"
+         "\n"
+         "  --filter TEXT        Run only the scenarios with the text in the\n"
+         "                       name.\n"
+         "  --engine ENGINE      permutations or convolution, permutations by\n"
+         "                       default.\n"
+         "  --threads N          Calculator threads, 0 for all cores. 1 by\n"
+         "                       default, so the runs are comparable.\n"
+         "  --output FILE        File to write the JSON report to, stdout if\n"
+         "                       not specified.\n"
+         "  --baseline FILE      Earlier report to compare with. Fails if a\n"
+         "                       result changed or a scenario got slower.\n"
+         "  --tolerance PERCENT  Allowed growth of time, states and memory,\n"
+         "                       10 by default.\n"
+         "  --check engines      Instead of measuring, run both engines and\n"
+         "                       fail if any result is invalid or convolution\n"
+         "                       is worse than permutations.\n"
+         "  --check workers      Instead of measuring, run 2 and 4 worker\n"
+         "                       processes and fail if any result differs\n"
+         "                       from the one found in this process.\n"
+         "  --check resolution   Instead of measuring, run with coarser flow\n"
+         "                       resolutions and fail if any result puts a\n"
+         "                       client out of the output range. Prints the\n"
+         "                       cost and clients next to the exact ones.\n";
+}
+}  // namespace vh::ponc::bench
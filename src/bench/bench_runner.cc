@@ -0,0 +1,162 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "bench_runner.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+
+#include "bench_scenario.h"
+#include "calc_calculator.h"
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+namespace {
+///
+auto Calculate(const Scenario &scenario,
+               const core::CalculatorSettings &settings) {
+  const auto calculator_args =
+      Scenario::MakeCalculatorArgs(scenario, settings);
+
+  const auto start_time = std::chrono::steady_clock::now();
+  auto calculator = calc::Calculator{calculator_args};
+  const auto result = calculator.TakeResult();
+  const auto wall_time =
+      std::chrono::duration<double>{std::chrono::steady_clock::now() -
+                                    start_time};
+
+  const auto statistics = calculator.GetStatistics();
+
+  return Measurement{
+      .wall_time = wall_time.count(),
+      .num_expanded_nodes = statistics.num_expanded_nodes,
+      .num_pruned_nodes = statistics.num_pruned_nodes,
+      .cost = std::accumulate(result.cbegin(), result.cend(), calc::Cost{},
+                              [](const auto cost, const auto &tree) {
+                                return cost + tree.tree_cost;
+                              }),
+      .num_clients = std::accumulate(
+          result.cbegin(), result.cend(), calc::NumClients{},
+          [](const auto num_clients, const auto &tree) {
+            return num_clients + tree.num_clients;
+          })};
+}
+
+#ifdef __linux__
+///
+constexpr auto kBytesPerKilobyte = 1024;
+
+///
+auto ReadMeasurement(int descriptor) -> std::optional<Measurement> {
+  auto measurement = Measurement{};
+  auto *data = reinterpret_cast<char *>(&measurement);
+  auto size_left = static_cast<std::int64_t>(sizeof(measurement));
+
+  while (size_left > 0) {
+    const auto size_read = read(descriptor, data, size_left);
+
+    if ((size_read < 0) && (errno == EINTR)) {
+      continue;
+    }
+
+    if (size_read <= 0) {
+      return std::nullopt;
+    }
+
+    data += size_read;
+    size_left -= size_read;
+  }
+
+  return measurement;
+}
+
+///
+void WriteMeasurement(int descriptor, const Measurement &measurement) {
+  const auto *data = reinterpret_cast<const char *>(&measurement);
+  auto size_left = static_cast<std::int64_t>(sizeof(measurement));
+
+  while (size_left > 0) {
+    const auto size_written = write(descriptor, data, size_left);
+
+    if ((size_written < 0) && (errno == EINTR)) {
+      continue;
+    }
+
+    if (size_written <= 0) {
+      return;
+    }
+
+    data += size_written;
+    size_left -= size_written;
+  }
+}
+#endif
+}  // namespace
+
+///
+auto Runner::Measure(const Scenario &scenario,
+                     const core::CalculatorSettings &settings)
+    -> std::optional<Measurement> {
+#ifdef __linux__
+  // vh: Each scenario runs in a child process, so its peak memory is not
+  // hidden by the ones which ran before it.
+  auto descriptors = std::array<int, 2>{};
+
+  if (pipe(descriptors.data()) != 0) {
+    return std::nullopt;
+  }
+
+  const auto process_id = fork();
+
+  if (process_id < 0) {
+    close(descriptors[0]);
+    close(descriptors[1]);
+    return std::nullopt;
+  }
+
+  if (process_id == 0) {
+    close(descriptors[0]);
+    WriteMeasurement(descriptors[1], Calculate(scenario, settings));
+    close(descriptors[1]);
+    _exit(EXIT_SUCCESS);
+  }
+
+  close(descriptors[1]);
+  auto measurement = ReadMeasurement(descriptors[0]);
+  close(descriptors[0]);
+
+  auto status = 0;
+  auto usage = rusage{};
+
+  while ((wait4(process_id, &status, 0, &usage) < 0) && (errno == EINTR)) {
+  }
+
+  if (!measurement.has_value() || !WIFEXITED(status) ||
+      (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+    return std::nullopt;
+  }
+
+  measurement->peak_memory_size =
+      static_cast<std::int64_t>(usage.ru_maxrss) * kBytesPerKilobyte;
+  return measurement;
+#else
+  // vh: Peak memory of a single scenario is only measured on Linux, where
+  // it runs in a child process.
+  return Calculate(scenario, settings);
+#endif
+}
+}  // namespace vh::ponc::bench
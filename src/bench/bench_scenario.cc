@@ -0,0 +1,197 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "bench_scenario.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "calc_calculator.h"
+#include "calc_resolution.h"
+#include "calc_tree_node.h"
+#include "core_i_family.h"
+#include "core_settings.h"
+
+namespace vh::ponc::bench {
+namespace {
+///
+struct SyntheticFamily {
+  ///
+  int num_outputs{};
+  ///
+  float drop{};
+  ///
+  float coupler_drop{};
+  ///
+  float cost{};
+};
+
+///
+struct OutputWindow {
+  ///
+  const char *name{};
+  ///
+  float min_output{};
+  ///
+  float max_output{};
+};
+
+///
+constexpr auto kInputFlow = 6.F;
+///
+constexpr auto kMaxClientsPerInput = 64;
+///
+constexpr auto kClientFamilyId = std::uintptr_t{1000};
+
+// vh: Drops and relative costs are close to the ones of real PLC splitters
+// and FBT couplers, so the search has the same shape as on real projects.
+///
+constexpr auto kSplitters = std::array{
+    SyntheticFamily{.num_outputs = 2, .drop = -4.3F, .cost = 10},
+    SyntheticFamily{.num_outputs = 4, .drop = -7.4F, .cost = 18},
+    SyntheticFamily{.num_outputs = 8, .drop = -10.7F, .cost = 30},
+    SyntheticFamily{.num_outputs = 16, .drop = -13.9F, .cost = 50}};
+///
+constexpr auto kCouplers = std::array{
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -0.4F, .coupler_drop = -13.8F, .cost = 8},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -0.7F, .coupler_drop = -10.6F, .cost = 9},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -0.95F, .coupler_drop = -8.8F, .cost = 10},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -1.2F, .coupler_drop = -7.5F, .cost = 11},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -1.55F, .coupler_drop = -6.5F, .cost = 12},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -1.85F, .coupler_drop = -5.7F, .cost = 13},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -2.2F, .coupler_drop = -5.F, .cost = 14},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -2.6F, .coupler_drop = -4.4F, .cost = 15},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -3.F, .coupler_drop = -3.9F, .cost = 16},
+    SyntheticFamily{
+        .num_outputs = 2, .drop = -3.4F, .coupler_drop = -3.4F, .cost = 17}};
+///
+constexpr auto kAttenuators = std::array{
+    SyntheticFamily{.num_outputs = 1, .drop = -1.F, .cost = 3},
+    SyntheticFamily{.num_outputs = 1, .drop = -3.F, .cost = 3},
+    SyntheticFamily{.num_outputs = 1, .drop = -5.F, .cost = 3},
+    SyntheticFamily{.num_outputs = 1, .drop = -10.F, .cost = 3}};
+
+///
+constexpr auto kFamilySets =
+    std::array{FamilySet::kSplitters, FamilySet::kSplittersCouplers,
+               FamilySet::kAttenuators};
+///
+constexpr auto kNumClients = std::array{8, 32, 128, 512};
+///
+constexpr auto kOutputWindows = std::array{
+    OutputWindow{.name = "narrow", .min_output = -21, .max_output = -19},
+    OutputWindow{.name = "default", .min_output = -22, .max_output = -18},
+    OutputWindow{.name = "wide", .min_output = -26, .max_output = -16}};
+
+///
+auto MakeFamilyNode(const SyntheticFamily &family, std::uintptr_t family_id) {
+  auto outputs = std::vector<float>(family.num_outputs, family.drop);
+
+  // vh: Couplers split the flow unevenly between their two outputs.
+  if (family.coupler_drop != 0) {
+    outputs.back() = family.coupler_drop;
+  }
+
+  const auto cost = calc::ToCalculatorResolution(family.cost);
+
+  return calc::TreeNode{.family_id = core::FamilyId{family_id},
+                        .node_cost = cost,
+                        .tree_cost = cost,
+                        .outputs = calc::ToCalculatorResolution(outputs)};
+}
+
+///
+template <typename T>
+void AddFamilyNodes(const T &families, std::vector<calc::TreeNode> &nodes) {
+  for (const auto &family : families) {
+    nodes.emplace_back(
+        MakeFamilyNode(family, static_cast<std::uintptr_t>(nodes.size() + 1)));
+  }
+}
+}  // namespace
+
+///
+auto Scenario::MakeScenarios() -> std::vector<Scenario> {
+  auto scenarios = std::vector<Scenario>{};
+
+  for (const auto family_set : kFamilySets) {
+    for (const auto num_clients : kNumClients) {
+      for (const auto &window : kOutputWindows) {
+        scenarios.emplace_back(Scenario{
+            .name = GetFamilySetName(family_set) + "/" +
+                    std::to_string(num_clients) + "/" + window.name,
+            .family_set = family_set,
+            .num_clients = num_clients,
+            .num_inputs = std::max(1, num_clients / kMaxClientsPerInput),
+            .min_output = window.min_output,
+            .max_output = window.max_output});
+      }
+    }
+  }
+
+  return scenarios;
+}
+
+///
+auto Scenario::GetFamilySetName(FamilySet family_set) -> std::string {
+  switch (family_set) {
+    case FamilySet::kSplitters:
+      return "splitters";
+    case FamilySet::kSplittersCouplers:
+      return "splitters-couplers";
+    case FamilySet::kAttenuators:
+      return "attenuators";
+  }
+
+  return {};
+}
+
+///
+auto Scenario::MakeCalculatorArgs(const Scenario &scenario,
+                                  const core::CalculatorSettings &settings)
+    -> calc::Calculator::ConstructorArgs {
+  auto args = calc::Calculator::ConstructorArgs{
+      .settings = settings,
+      .client_node = calc::TreeNode{
+          .family_id = core::FamilyId{kClientFamilyId}, .num_clients = 1},
+      .step_callback = [](const auto &) {
+        return calc::Calculator::StepStatus::kContinueToNextStep;
+      }};
+
+  args.settings.min_output = scenario.min_output;
+  args.settings.max_output = scenario.max_output;
+  args.settings.num_clients = scenario.num_clients;
+
+  args.input_nodes.assign(
+      scenario.num_inputs,
+      calc::TreeNode{.outputs = calc::ToCalculatorResolution(
+                         std::vector<float>{kInputFlow})});
+
+  AddFamilyNodes(kSplitters, args.family_nodes);
+
+  if (scenario.family_set != FamilySet::kSplitters) {
+    AddFamilyNodes(kCouplers, args.family_nodes);
+  }
+
+  if (scenario.family_set == FamilySet::kAttenuators) {
+    AddFamilyNodes(kAttenuators, args.family_nodes);
+  }
+
+  return args;
+}
+}  // namespace vh::ponc::bench
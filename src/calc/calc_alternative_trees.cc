@@ -0,0 +1,77 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_alternative_trees.h"
+
+#include <algorithm>
+
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+namespace {
+///
+auto IsCheaper(const AlternativeTrees::Tree &left,
+               const AlternativeTrees::Tree &right) {
+  return left.cost < right.cost;
+}
+}  // namespace
+
+///
+AlternativeTrees::AlternativeTrees(const ConstructorArgs &args)
+    : max_num_clients_{args.max_num_clients},
+      max_num_trees_{args.max_num_trees},
+      cells_(static_cast<size_t>(args.num_rows) * (args.max_num_clients + 1)) {
+  Expects(max_num_trees_ > 0);
+}
+
+///
+void AlternativeTrees::AddTree(RowIndex row, NumClients num_clients,
+                               FamilyIndex family_index, Cost cost,
+                               std::span<const NumClients> child_num_clients) {
+  auto &trees = cells_[GetCellIndex(row, num_clients)];
+  const auto is_full = static_cast<int>(trees.size()) >= max_num_trees_;
+
+  // vh: Trees are kept in a max heap, so the most expensive one is replaced
+  // first and a cell never holds more than the max number of trees.
+  if (is_full && (cost >= trees.front().cost)) {
+    return;
+  }
+
+  const auto same_tree = std::find_if(
+      trees.cbegin(), trees.cend(),
+      [family_index, child_num_clients](const auto &tree) {
+        return (tree.family_index == family_index) &&
+               std::equal(tree.child_num_clients.cbegin(),
+                          tree.child_num_clients.cend(),
+                          child_num_clients.begin(), child_num_clients.end());
+      });
+
+  if (same_tree != trees.cend()) {
+    return;
+  }
+
+  if (is_full) {
+    std::pop_heap(trees.begin(), trees.end(), &IsCheaper);
+    trees.pop_back();
+  }
+
+  trees.emplace_back(
+      Tree{.family_index = family_index,
+           .cost = cost,
+           .child_num_clients = {child_num_clients.begin(),
+                                 child_num_clients.end()}});
+  std::push_heap(trees.begin(), trees.end(), &IsCheaper);
+}
+
+///
+auto AlternativeTrees::GetSortedTrees(RowIndex row,
+                                      NumClients num_clients) const
+    -> std::vector<Tree> {
+  auto trees = cells_[GetCellIndex(row, num_clients)];
+  std::sort_heap(trees.begin(), trees.end(), &IsCheaper);
+  return trees;
+}
+}  // namespace vh::ponc::calc
@@ -0,0 +1,208 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_batch_task.h"
+
+// IWYU pragma: no_include <cxxabi.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "calc_best_trees_cache.h"
+#include "calc_thread_pool.h"
+
+namespace vh::ponc::calc {
+///
+BatchTask::BatchTask(ConstructorArgs args)
+    : start_time_{std::chrono::steady_clock::now()} {
+  task_ = std::async(std::launch::async, [this, args = std::move(args)]() {
+    return CalculateDiagrams(args);
+  });
+}
+
+///
+BatchTask::~BatchTask() {
+  Stop();
+
+  if (task_.valid()) {
+    task_.wait();
+  }
+}
+
+///
+auto BatchTask::ChooseCalculation(const ConstructorArgs &args)
+    -> Estimator::Estimate {
+  // vh: Diagrams share the trees of the outputs, so calculation is chosen
+  // once by the inputs of all of them.
+  auto estimated_args = args.calculator_args;
+
+  for (const auto &input_nodes : args.diagram_input_nodes) {
+    estimated_args.input_nodes.insert(estimated_args.input_nodes.end(),
+                                      input_nodes.cbegin(), input_nodes.cend());
+  }
+
+  return Estimator{estimated_args}.ChooseCalculation();
+}
+
+///
+void BatchTask::Stop() { stop_requested_ = true; }
+
+///
+auto BatchTask::IsRunning() const -> bool {
+  if (!task_.valid()) {
+    return false;
+  }
+
+  const auto calculation_status = task_.wait_for(std::chrono::seconds::zero());
+  return calculation_status != std::future_status::ready;
+}
+
+///
+auto BatchTask::GetProgress() const -> float { return progress_; }
+
+///
+auto BatchTask::GetTimeLeft() const -> std::optional<std::chrono::seconds> {
+  const auto progress = progress_.load();
+
+  if (progress <= 0) {
+    return std::nullopt;
+  }
+
+  const auto time_spent = std::chrono::duration<float>{
+      std::chrono::steady_clock::now() - start_time_};
+
+  return std::chrono::duration_cast<std::chrono::seconds>(
+      time_spent * (1 - progress) / progress);
+}
+
+///
+auto BatchTask::GetResults()
+    -> std::optional<std::vector<std::vector<TreeNode>>> {
+  if (!task_.valid() || IsRunning()) {
+    return std::nullopt;
+  }
+
+  auto results = task_.get();
+
+  task_ = std::future<std::vector<std::vector<TreeNode>>>{};
+  stop_requested_ = false;
+  progress_ = 0;
+
+  return results;
+}
+
+///
+auto BatchTask::CalculateDiagrams(ConstructorArgs args)
+    -> std::vector<std::vector<TreeNode>> {
+  auto &calculator_args = args.calculator_args;
+
+  // vh: Trees of the outputs don't depend on the inputs, so diagrams share
+  // them through the cache.
+  if (calculator_args.best_trees_cache == nullptr) {
+    calculator_args.best_trees_cache = std::make_shared<BestTreesCache>();
+  }
+
+  if (const auto num_threads =
+          ThreadPool::GetNumThreads(calculator_args.settings.num_threads);
+      (calculator_args.thread_pool == nullptr) && (num_threads > 1)) {
+    calculator_args.thread_pool = std::make_shared<ThreadPool>(num_threads);
+  }
+
+  const auto num_diagrams = static_cast<int>(args.diagram_input_nodes.size());
+
+  if (num_diagrams == 0) {
+    return {};
+  }
+
+  const auto uses_cache = Calculator::UsesCache(calculator_args.settings);
+
+  // vh: Output trees of all diagrams are found first by all threads and
+  // workers, and count as much progress as the diagrams themselves.
+  auto part_progress = std::vector<std::atomic<float>>(
+      uses_cache ? (num_diagrams + 1) : num_diagrams);
+
+  const auto make_step_callback = [this, &part_progress](const auto part) {
+    return [this, &part_progress, part](const auto &calculator) {
+      part_progress[part] = calculator.GetProgress();
+      UpdateProgress(part_progress);
+
+      return stop_requested_ ? Calculator::StepStatus::kStopCalculation
+                             : Calculator::StepStatus::kContinueToNextStep;
+    };
+  };
+
+  if (uses_cache) {
+    auto output_args = calculator_args;
+    output_args.only_output_trees = true;
+    output_args.step_callback = make_step_callback(num_diagrams);
+
+    for (const auto &input_nodes : args.diagram_input_nodes) {
+      output_args.input_nodes.insert(output_args.input_nodes.end(),
+                                     input_nodes.cbegin(), input_nodes.cend());
+    }
+
+    const auto output_calculator = Calculator{output_args};
+    part_progress[num_diagrams] = 1;
+  }
+
+  // vh: Diagrams are queued on the pool, so each of them takes one thread
+  // and they run at the same time. Worker processes would be started by
+  // every one of them, so they only help with the output trees.
+  auto diagram_args = calculator_args;
+  diagram_args.thread_pool = nullptr;
+  diagram_args.settings.num_threads = 1;
+  diagram_args.settings.num_processes = 0;
+
+  auto results = std::vector<std::vector<TreeNode>>(num_diagrams);
+  auto tasks = std::vector<ThreadPool::Task>{};
+  tasks.reserve(num_diagrams);
+
+  for (auto diagram_index = 0; diagram_index < num_diagrams; ++diagram_index) {
+    tasks.emplace_back([this, &args, &diagram_args, &results,
+                        &make_step_callback, &part_progress, diagram_index]() {
+      if (stop_requested_) {
+        return;
+      }
+
+      auto calculator_args = diagram_args;
+      calculator_args.input_nodes =
+          std::move(args.diagram_input_nodes[diagram_index]);
+      calculator_args.step_callback = make_step_callback(diagram_index);
+
+      auto calculator = Calculator{calculator_args};
+      results[diagram_index] = calculator.TakeResult();
+      part_progress[diagram_index] = 1;
+      UpdateProgress(part_progress);
+    });
+  }
+
+  if (calculator_args.thread_pool != nullptr) {
+    calculator_args.thread_pool->RunAndWait(std::move(tasks));
+  } else {
+    for (const auto &task : tasks) {
+      task();
+    }
+  }
+
+  return results;
+}
+
+///
+void BatchTask::UpdateProgress(
+    const std::vector<std::atomic<float>> &part_progress) {
+  auto progress = 0.F;
+
+  for (const auto &part : part_progress) {
+    progress += part;
+  }
+
+  progress_ = progress / static_cast<float>(part_progress.size());
+}
+}  // namespace vh::ponc::calc
@@ -0,0 +1,244 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_best_trees_cache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "core_id_value.h"
+
+namespace vh::ponc::calc {
+namespace {
+///
+constexpr auto kMaxNumEntries = 8;
+///
+constexpr auto kMaxNumFamilies = 1024;
+///
+constexpr auto kFileFormat = std::uint64_t{0x34454843434E4F50};
+///
+constexpr auto kChecksumOffset = std::uint64_t{0xCBF29CE484222325};
+///
+constexpr auto kChecksumPrime = std::uint64_t{0x100000001B3};
+
+///
+auto MakeChecksum(const std::string &data) {
+  auto checksum = kChecksumOffset;
+
+  for (const auto byte : data) {
+    checksum ^= static_cast<unsigned char>(byte);
+    checksum *= kChecksumPrime;
+  }
+
+  return checksum;
+}
+
+///
+void WriteEntry(std::ostream &stream, const BestTreesCache::Entry &entry) {
+  const auto num_families = static_cast<std::uint64_t>(entry.family_ids.size());
+  stream.write(reinterpret_cast<const char *>(&num_families),
+               sizeof(num_families));
+
+  for (auto family_index = std::uint64_t{0}; family_index < num_families;
+       ++family_index) {
+    const auto family_id =
+        static_cast<std::uint64_t>(entry.family_ids[family_index].Get());
+    const auto family_cost = entry.family_costs[family_index];
+
+    stream.write(reinterpret_cast<const char *>(&family_id), sizeof(family_id));
+    stream.write(reinterpret_cast<const char *>(&family_cost),
+                 sizeof(family_cost));
+  }
+
+  stream.write(reinterpret_cast<const char *>(&entry.client_cost),
+               sizeof(entry.client_cost));
+
+  const auto has_inputs_key =
+      static_cast<std::uint8_t>(entry.inputs_key.has_value());
+  const auto inputs_key = entry.inputs_key.value_or(BestTreesCache::Key{});
+
+  stream.write(reinterpret_cast<const char *>(&has_inputs_key),
+               sizeof(has_inputs_key));
+  stream.write(reinterpret_cast<const char *>(&inputs_key), sizeof(inputs_key));
+
+  entry.best_trees->WriteToStream(stream);
+}
+
+///
+auto ReadEntry(std::istream &stream) -> std::optional<BestTreesCache::Entry> {
+  auto entry = BestTreesCache::Entry{};
+  auto num_families = std::uint64_t{};
+  stream.read(reinterpret_cast<char *>(&num_families), sizeof(num_families));
+
+  if (!stream || (num_families > kMaxNumFamilies)) {
+    return std::nullopt;
+  }
+
+  for (auto family_index = std::uint64_t{0}; family_index < num_families;
+       ++family_index) {
+    auto family_id = std::uint64_t{};
+    auto family_cost = Cost{};
+
+    stream.read(reinterpret_cast<char *>(&family_id), sizeof(family_id));
+    stream.read(reinterpret_cast<char *>(&family_cost), sizeof(family_cost));
+
+    entry.family_ids.emplace_back(
+        static_cast<core::UnspecifiedIdValue>(family_id));
+    entry.family_costs.emplace_back(family_cost);
+  }
+
+  stream.read(reinterpret_cast<char *>(&entry.client_cost),
+              sizeof(entry.client_cost));
+
+  auto has_inputs_key = std::uint8_t{};
+  auto inputs_key = BestTreesCache::Key{};
+
+  stream.read(reinterpret_cast<char *>(&has_inputs_key),
+              sizeof(has_inputs_key));
+  stream.read(reinterpret_cast<char *>(&inputs_key), sizeof(inputs_key));
+
+  if (has_inputs_key != 0) {
+    entry.inputs_key = inputs_key;
+  }
+
+  if (!stream) {
+    return std::nullopt;
+  }
+
+  auto best_trees = BestTreesTable::ReadFromStream(
+      stream, static_cast<FamilyIndex>(num_families));
+
+  if (!best_trees.has_value()) {
+    return std::nullopt;
+  }
+
+  entry.best_trees =
+      std::make_shared<const BestTreesTable>(std::move(*best_trees));
+  return entry;
+}
+}  // namespace
+
+///
+auto BestTreesCache::Find(Key key) const -> std::optional<Entry> {
+  const auto lock = std::scoped_lock{mutex_};
+
+  const auto entry =
+      std::find_if(entries_.cbegin(), entries_.cend(),
+                   [key](const auto &entry) { return entry.first == key; });
+
+  if (entry == entries_.cend()) {
+    return std::nullopt;
+  }
+
+  return entry->second;
+}
+
+///
+void BestTreesCache::Store(Key key, Entry entry) {
+  const auto lock = std::scoped_lock{mutex_};
+
+  std::erase_if(entries_, [key](const auto &stored_entry) {
+    return stored_entry.first == key;
+  });
+
+  // vh: Latest entries are in front, so the oldest one is removed.
+  entries_.emplace_front(key, std::move(entry));
+
+  if (static_cast<int>(entries_.size()) > kMaxNumEntries) {
+    entries_.pop_back();
+  }
+}
+
+///
+auto BestTreesCache::ReadFromFile(const std::filesystem::path &file_path)
+    -> bool {
+  auto file = std::ifstream{file_path, std::ios::binary};
+  auto file_format = std::uint64_t{};
+  auto checksum = std::uint64_t{};
+
+  file.read(reinterpret_cast<char *>(&file_format), sizeof(file_format));
+  file.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+
+  if (!file || (file_format != kFileFormat)) {
+    return false;
+  }
+
+  // vh: File could be cut or damaged while the trees are only checked to be
+  // in bounds, so broken bytes could still make wrong trees out of them.
+  auto data = std::string{std::istreambuf_iterator<char>{file}, {}};
+
+  if (MakeChecksum(data) != checksum) {
+    return false;
+  }
+
+  auto stream = std::istringstream{std::move(data)};
+  auto num_entries = std::uint64_t{};
+  stream.read(reinterpret_cast<char *>(&num_entries), sizeof(num_entries));
+
+  if (!stream || (num_entries > kMaxNumEntries)) {
+    return false;
+  }
+
+  auto entries = decltype(entries_){};
+
+  for (auto entry_index = std::uint64_t{0}; entry_index < num_entries;
+       ++entry_index) {
+    auto key = Key{};
+    stream.read(reinterpret_cast<char *>(&key), sizeof(key));
+
+    if (!stream) {
+      return false;
+    }
+
+    auto entry = ReadEntry(stream);
+
+    if (!entry.has_value()) {
+      return false;
+    }
+
+    entries.emplace_back(key, std::move(*entry));
+  }
+
+  const auto lock = std::scoped_lock{mutex_};
+  entries_ = std::move(entries);
+  return true;
+}
+
+///
+auto BestTreesCache::WriteToFile(const std::filesystem::path &file_path) const
+    -> bool {
+  auto stream = std::ostringstream{};
+
+  {
+    const auto lock = std::scoped_lock{mutex_};
+    const auto num_entries = static_cast<std::uint64_t>(entries_.size());
+
+    stream.write(reinterpret_cast<const char *>(&num_entries),
+                 sizeof(num_entries));
+
+    for (const auto &[key, entry] : entries_) {
+      stream.write(reinterpret_cast<const char *>(&key), sizeof(key));
+      WriteEntry(stream, entry);
+    }
+  }
+
+  const auto data = std::move(stream).str();
+  const auto checksum = MakeChecksum(data);
+  auto file = std::ofstream{file_path, std::ios::binary | std::ios::trunc};
+
+  file.write(reinterpret_cast<const char *>(&kFileFormat),
+             sizeof(kFileFormat));
+  file.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+  file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+  return static_cast<bool>(file);
+}
+}  // namespace vh::ponc::calc
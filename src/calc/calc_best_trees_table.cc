@@ -0,0 +1,538 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_best_trees_table.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <utility>
+
+namespace vh::ponc::calc {
+namespace {
+///
+constexpr auto kNoRow = RowIndex{-1};
+///
+constexpr auto kNoChildren = -1;
+///
+constexpr auto kMaxNumCells = std::int64_t{std::numeric_limits<int>::max()};
+///
+constexpr auto kMaxOutputRange = std::int64_t{1} << 20;
+///
+constexpr auto kMaxReadChunkSize = std::uint64_t{1} << 16;
+
+///
+template <typename T>
+void WriteVector(std::ostream &stream, const std::vector<T> &values) {
+  const auto size = static_cast<std::uint64_t>(values.size());
+  stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  stream.write(reinterpret_cast<const char *>(values.data()),
+               static_cast<std::streamsize>(size * sizeof(T)));
+}
+
+///
+template <typename T>
+auto ReadVector(std::istream &stream, std::vector<T> &values,
+                std::uint64_t max_size) {
+  auto size = std::uint64_t{};
+  stream.read(reinterpret_cast<char *>(&size), sizeof(size));
+
+  if (!stream || (size > max_size)) {
+    return false;
+  }
+
+  values.clear();
+
+  // vh: Values are read in chunks, so a broken size fails at the end of the
+  // stream before it takes much memory.
+  while (values.size() < size) {
+    const auto offset = values.size();
+    const auto chunk_size = std::min(size - offset, kMaxReadChunkSize);
+
+    values.resize(offset + chunk_size);
+    stream.read(reinterpret_cast<char *>(values.data() + offset),
+                static_cast<std::streamsize>(chunk_size * sizeof(T)));
+
+    if (!stream) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///
+auto AreChildrenValid(const std::vector<NumClients> &children,
+                      int child_offset) {
+  const auto num_children = static_cast<std::int64_t>(children.size());
+
+  return (child_offset >= 0) && (child_offset < num_children) &&
+         (children[child_offset] >= 0) &&
+         (child_offset + 1 + std::int64_t{children[child_offset]} <=
+          num_children);
+}
+
+///
+auto MakeAllRows(int num_rows) {
+  auto rows = std::vector<RowIndex>(num_rows);
+  std::iota(rows.begin(), rows.end(), 0);
+  return rows;
+}
+
+///
+auto GetNumBytesLeft(std::istream &stream) -> std::int64_t {
+  const auto position = stream.tellg();
+  stream.seekg(0, std::ios::end);
+  const auto end = stream.tellg();
+  stream.seekg(position);
+
+  if ((position < 0) || (end < position) || !stream) {
+    return 0;
+  }
+
+  return static_cast<std::int64_t>(end - position);
+}
+}  // namespace
+
+///
+BestTreesTable::BestTreesTable(const std::vector<FlowValue> &sorted_outputs,
+                               int num_levels, int num_extra_rows,
+                               NumClients max_num_clients)
+    : BestTreesTable{
+          sorted_outputs, num_levels, num_extra_rows, max_num_clients,
+          MakeAllRows(static_cast<int>(sorted_outputs.size()) * num_levels +
+                      num_extra_rows)} {}
+
+///
+BestTreesTable::BestTreesTable(const std::vector<FlowValue> &sorted_outputs,
+                               int num_levels, int num_extra_rows,
+                               NumClients max_num_clients,
+                               const std::vector<RowIndex> &stored_rows)
+    : outputs_{sorted_outputs},
+      num_levels_{num_levels},
+      num_rows_{static_cast<int>(sorted_outputs.size()) * num_levels +
+                num_extra_rows},
+      num_columns_{max_num_clients + 1},
+      num_words_per_row_{(num_columns_ + kWordBits - 1) / kWordBits},
+      row_cell_offsets_(num_rows_, kNotStored),
+      row_word_offsets_(num_rows_, kNotStored),
+      row_children_(num_rows_) {
+  Expects(std::is_sorted(outputs_.cbegin(), outputs_.cend()));
+  Expects(num_levels_ > 0);
+
+  // vh: Cells of the stored rows follow each other in the order of the rows
+  // given, so the table of all rows has them in the order of rows.
+  auto num_stored_rows = 0;
+
+  for (const auto row : stored_rows) {
+    Expects((row >= 0) && (row < num_rows_));
+    Expects(row_cell_offsets_[row] == kNotStored);
+
+    row_cell_offsets_[row] = num_stored_rows * num_columns_;
+    row_word_offsets_[row] = num_stored_rows * num_words_per_row_;
+    ++num_stored_rows;
+  }
+
+  costs_.resize(static_cast<size_t>(num_stored_rows) * num_columns_);
+  occupancy_.resize(static_cast<size_t>(num_stored_rows) * num_words_per_row_);
+  family_indices_.resize(static_cast<size_t>(num_stored_rows) * num_columns_);
+  child_offsets_.resize(static_cast<size_t>(num_stored_rows) * num_columns_,
+                        kNoChildren);
+
+  if (outputs_.empty()) {
+    return;
+  }
+
+  min_output_ = outputs_.front();
+  output_rows_.resize(outputs_.back() - min_output_ + 1, kNoRow);
+
+  for (auto row = 0; row < static_cast<int>(outputs_.size()); ++row) {
+    output_rows_[outputs_[row] - min_output_] = row;
+  }
+}
+
+///
+auto BestTreesTable::GetNumRows() const -> int { return num_rows_; }
+
+///
+auto BestTreesTable::IsRowStored(RowIndex row) const -> bool {
+  return (row >= 0) && (row < num_rows_) &&
+         (row_cell_offsets_[row] != kNotStored);
+}
+
+///
+auto BestTreesTable::GetNumOutputRows() const -> int {
+  return static_cast<int>(outputs_.size()) * num_levels_;
+}
+
+///
+auto BestTreesTable::GetMaxNumClients() const -> NumClients {
+  return num_columns_ - 1;
+}
+
+///
+auto BestTreesTable::FindOutputRow(FlowValue output) const
+    -> std::optional<RowIndex> {
+  const auto offset = static_cast<std::int64_t>(output) - min_output_;
+
+  if ((offset < 0) ||
+      (offset >= static_cast<std::int64_t>(output_rows_.size()))) {
+    return std::nullopt;
+  }
+
+  const auto row = output_rows_[offset];
+
+  if (row == kNoRow) {
+    return std::nullopt;
+  }
+
+  return row;
+}
+
+///
+auto BestTreesTable::GetOutput(RowIndex row) const -> FlowValue {
+  Expects((row >= 0) && (row < GetNumOutputRows()));
+  return outputs_[row % static_cast<int>(outputs_.size())];
+}
+
+///
+auto BestTreesTable::GetNumLevels() const -> int { return num_levels_; }
+
+///
+auto BestTreesTable::GetLevel(RowIndex row) const -> int {
+  Expects((row >= 0) && (row < GetNumOutputRows()));
+  return row / static_cast<int>(outputs_.size());
+}
+
+///
+auto BestTreesTable::GetLevelRow(RowIndex row, int level) const -> RowIndex {
+  Expects((row >= 0) && (row < GetNumOutputRows()));
+  Expects((level >= 0) && (level < num_levels_));
+
+  // vh: Rows of each level follow the rows of the previous one in the same
+  // order of outputs.
+  const auto num_outputs = static_cast<int>(outputs_.size());
+  return level * num_outputs + row % num_outputs;
+}
+
+///
+auto BestTreesTable::GetExtraRow(int extra_row_index) const -> RowIndex {
+  const auto row = GetNumOutputRows() + extra_row_index;
+  Expects((row >= 0) && (row < num_rows_));
+  return row;
+}
+
+///
+auto BestTreesTable::GetFamilyIndex(RowIndex row, NumClients num_clients) const
+    -> FamilyIndex {
+  Expects(HasTree(row, num_clients));
+  return family_indices_[GetCellIndex(row, num_clients)];
+}
+
+///
+auto BestTreesTable::GetChildNumClients(RowIndex row,
+                                        NumClients num_clients) const
+    -> std::span<const NumClients> {
+  Expects(HasTree(row, num_clients));
+
+  const auto child_offset = child_offsets_[GetCellIndex(row, num_clients)];
+  Expects(child_offset != kNoChildren);
+
+  // vh: Children of the cell are prefixed with their count.
+  const auto &children = row_children_[row];
+  const auto num_children = children[child_offset];
+
+  return {children.data() + child_offset + 1,
+          static_cast<size_t>(num_children)};
+}
+
+///
+void BestTreesTable::SetTree(RowIndex row, NumClients num_clients,
+                             FamilyIndex family_index, Cost cost,
+                             std::span<const NumClients> child_num_clients) {
+  const auto cell_index = GetCellIndex(row, num_clients);
+  costs_[cell_index] = cost;
+  family_indices_[cell_index] = family_index;
+
+  auto &children = row_children_[row];
+  auto &child_offset = child_offsets_[cell_index];
+  const auto num_children = static_cast<NumClients>(child_num_clients.size());
+
+  if ((child_offset == kNoChildren) ||
+      (children[child_offset] < num_children)) {
+    child_offset = static_cast<int>(children.size());
+    children.resize(children.size() + 1 + num_children);
+  }
+
+  children[child_offset] = num_children;
+  std::copy(child_num_clients.begin(), child_num_clients.end(),
+            children.begin() + child_offset + 1);
+
+  occupancy_[GetWordIndex(row, num_clients)] |= std::uint64_t{1}
+                                                << (num_clients % kWordBits);
+}
+
+///
+void BestTreesTable::ClearTree(RowIndex row, NumClients num_clients) {
+  occupancy_[GetWordIndex(row, num_clients)] &=
+      ~(std::uint64_t{1} << (num_clients % kWordBits));
+}
+
+///
+void BestTreesTable::CompactRow(RowIndex row) {
+  const auto &children = row_children_[row];
+  auto compact_children = std::vector<NumClients>{};
+
+  // vh: Cleared trees keep their children until the row is compacted.
+  for (auto num_clients = 0; num_clients < num_columns_; ++num_clients) {
+    auto &child_offset = child_offsets_[GetCellIndex(row, num_clients)];
+
+    if (!HasTree(row, num_clients)) {
+      child_offset = kNoChildren;
+      continue;
+    }
+
+    if (child_offset == kNoChildren) {
+      continue;
+    }
+
+    const auto num_children = children[child_offset];
+    const auto compact_offset = static_cast<int>(compact_children.size());
+
+    compact_children.insert(
+        compact_children.cend(), children.cbegin() + child_offset,
+        children.cbegin() + child_offset + 1 + num_children);
+    child_offset = compact_offset;
+  }
+
+  row_children_[row] = std::move(compact_children);
+}
+
+///
+void BestTreesTable::CopyRow(const BestTreesTable &source,
+                             RowIndex source_row, RowIndex row,
+                             std::span<const FamilyIndex> family_indices) {
+  const auto num_columns = std::min(source.num_columns_, num_columns_);
+
+  std::copy_n(&source.costs_[source.GetCellIndex(source_row, 0)], num_columns,
+              &costs_[GetCellIndex(row, 0)]);
+  std::copy_n(&source.child_offsets_[source.GetCellIndex(source_row, 0)],
+              num_columns, &child_offsets_[GetCellIndex(row, 0)]);
+  std::transform(
+      &source.family_indices_[source.GetCellIndex(source_row, 0)],
+      &source.family_indices_[source.GetCellIndex(source_row, 0)] +
+          num_columns,
+      &family_indices_[GetCellIndex(row, 0)],
+      [family_indices](const auto family_index) {
+        Expects((family_index >= 0) &&
+                (family_index < static_cast<int>(family_indices.size())));
+        return family_indices[family_index];
+      });
+
+  // vh: Source could have more clients, which are cut from the last word.
+  const auto num_words = (num_columns + kWordBits - 1) / kWordBits;
+  auto *row_words = &occupancy_[GetWordIndex(row, 0)];
+
+  std::fill_n(row_words, num_words_per_row_, std::uint64_t{});
+  std::copy_n(&source.occupancy_[source.GetWordIndex(source_row, 0)],
+              num_words, row_words);
+
+  if (const auto num_last_word_bits = num_columns % kWordBits;
+      num_last_word_bits > 0) {
+    row_words[num_words - 1] &= ~std::uint64_t{} >>
+                                (kWordBits - num_last_word_bits);
+  }
+
+  row_children_[row] = source.row_children_[source_row];
+}
+
+///
+void BestTreesTable::WriteRowToStream(RowIndex row,
+                                      std::ostream &stream) const {
+  const auto *row_words = &occupancy_[GetWordIndex(row, 0)];
+  stream.write(reinterpret_cast<const char *>(row_words),
+               static_cast<std::streamsize>(num_words_per_row_ *
+                                            sizeof(*row_words)));
+
+  // vh: Only the cells with trees are written, which are few in most rows.
+  for (auto num_clients = 0; num_clients < num_columns_; ++num_clients) {
+    if (!HasTree(row, num_clients)) {
+      continue;
+    }
+
+    const auto cell_index = GetCellIndex(row, num_clients);
+    const auto cell =
+        std::array{costs_[cell_index], family_indices_[cell_index],
+                   child_offsets_[cell_index]};
+    stream.write(reinterpret_cast<const char *>(cell.data()), sizeof(cell));
+  }
+
+  WriteVector(stream, row_children_[row]);
+}
+
+///
+auto BestTreesTable::ReadRowFromStream(RowIndex row, std::istream &stream)
+    -> bool {
+  auto *row_words = &occupancy_[GetWordIndex(row, 0)];
+  stream.read(reinterpret_cast<char *>(row_words),
+              static_cast<std::streamsize>(num_words_per_row_ *
+                                           sizeof(*row_words)));
+
+  for (auto num_clients = 0; stream && (num_clients < num_columns_);
+       ++num_clients) {
+    if (!HasTree(row, num_clients)) {
+      continue;
+    }
+
+    const auto cell_index = GetCellIndex(row, num_clients);
+    auto cell = std::array<int, 3>{};
+    stream.read(reinterpret_cast<char *>(cell.data()), sizeof(cell));
+
+    costs_[cell_index] = cell[0];
+    family_indices_[cell_index] = cell[1];
+    child_offsets_[cell_index] = cell[2];
+  }
+
+  auto &children = row_children_[row];
+
+  if (!stream || !ReadVector(stream, children, kMaxNumCells)) {
+    std::fill_n(row_words, num_words_per_row_, std::uint64_t{});
+    return false;
+  }
+
+  for (auto num_clients = 0; num_clients < num_columns_; ++num_clients) {
+    const auto child_offset = child_offsets_[GetCellIndex(row, num_clients)];
+
+    if (!HasTree(row, num_clients) || (child_offset == kNoChildren)) {
+      continue;
+    }
+
+    if (!AreChildrenValid(children, child_offset)) {
+      std::fill_n(row_words, num_words_per_row_, std::uint64_t{});
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///
+void BestTreesTable::WriteToStream(std::ostream &stream) const {
+  // vh: Levels are not stored, since the trees of the limited paths are
+  // never cached. Only the tables of all rows are cached.
+  Expects(num_levels_ == 1);
+  Expects(costs_.size() == static_cast<size_t>(num_rows_) * num_columns_);
+
+  const auto dimensions = std::array{num_rows_, num_columns_};
+  stream.write(reinterpret_cast<const char *>(dimensions.data()),
+               sizeof(dimensions));
+
+  WriteVector(stream, outputs_);
+  WriteVector(stream, costs_);
+  WriteVector(stream, occupancy_);
+  WriteVector(stream, family_indices_);
+  WriteVector(stream, child_offsets_);
+
+  for (const auto &children : row_children_) {
+    WriteVector(stream, children);
+  }
+}
+
+///
+auto BestTreesTable::ReadFromStream(std::istream &stream,
+                                    FamilyIndex max_family_index)
+    -> std::optional<BestTreesTable> {
+  auto dimensions = std::array<int, 2>{};
+  stream.read(reinterpret_cast<char *>(dimensions.data()), sizeof(dimensions));
+
+  auto outputs = std::vector<FlowValue>{};
+
+  if (!stream || !ReadVector(stream, outputs, kMaxOutputRange) ||
+      (std::adjacent_find(outputs.cbegin(), outputs.cend(),
+                          std::greater_equal<>{}) != outputs.cend())) {
+    return std::nullopt;
+  }
+
+  // vh: File could be broken or stale, so its dimensions are checked against
+  // the limits of the table and the size of the file before the table is
+  // made of them.
+  const auto [num_rows, num_columns] = dimensions;
+  const auto num_extra_rows = num_rows - static_cast<int>(outputs.size());
+  const auto num_cells = static_cast<std::int64_t>(num_rows) * num_columns;
+
+  if ((num_extra_rows < 0) || (num_columns <= 0) ||
+      (num_cells > kMaxNumCells) ||
+      (!outputs.empty() && (static_cast<std::int64_t>(outputs.back()) -
+                                outputs.front() >=
+                            kMaxOutputRange)) ||
+      (num_cells * static_cast<std::int64_t>(sizeof(Cost) +
+                                             sizeof(FamilyIndex) +
+                                             sizeof(int)) >
+       GetNumBytesLeft(stream))) {
+    return std::nullopt;
+  }
+
+  auto table = BestTreesTable{outputs, 1, num_extra_rows, num_columns - 1};
+  const auto num_words = table.occupancy_.size();
+
+  if (!ReadVector(stream, table.costs_, num_cells) ||
+      !ReadVector(stream, table.occupancy_, num_words) ||
+      !ReadVector(stream, table.family_indices_, num_cells) ||
+      !ReadVector(stream, table.child_offsets_, num_cells) ||
+      (static_cast<std::int64_t>(table.costs_.size()) != num_cells) ||
+      (table.occupancy_.size() != num_words) ||
+      (static_cast<std::int64_t>(table.family_indices_.size()) != num_cells) ||
+      (static_cast<std::int64_t>(table.child_offsets_.size()) != num_cells)) {
+    return std::nullopt;
+  }
+
+  // vh: Cells of the output rows are mapped to the current families by
+  // their index, which is zero for the client. Extra rows hold the input
+  // families and the root one, which follow the others.
+  const auto num_output_cells = table.GetNumOutputRows() * num_columns;
+
+  if (std::any_of(table.family_indices_.cbegin(),
+                  table.family_indices_.cbegin() + num_output_cells,
+                  [max_family_index](const auto family_index) {
+                    return (family_index < 0) ||
+                           (family_index > max_family_index);
+                  }) ||
+      std::any_of(table.family_indices_.cbegin() + num_output_cells,
+                  table.family_indices_.cend(),
+                  [max_family_index = max_family_index + num_extra_rows](
+                      const auto family_index) {
+                    return (family_index < 0) ||
+                           (family_index > max_family_index);
+                  })) {
+    return std::nullopt;
+  }
+
+  for (auto row = 0; row < num_rows; ++row) {
+    auto &children = table.row_children_[row];
+
+    if (!ReadVector(stream, children, kMaxNumCells)) {
+      return std::nullopt;
+    }
+
+    for (auto num_clients = 0; num_clients < num_columns; ++num_clients) {
+      const auto child_offset =
+          table.child_offsets_[table.GetCellIndex(row, num_clients)];
+
+      if ((child_offset != kNoChildren) &&
+          !AreChildrenValid(children, child_offset)) {
+        return std::nullopt;
+      }
+    }
+  }
+
+  return table;
+}
+}  // namespace vh::ponc::calc
@@ -10,23 +10,39 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <system_error>
 #include <type_traits>
 #include <utility>
 
 namespace vh::ponc::calc {
 ///
-CalculationTask::CalculationTask(Calculator::ConstructorArgs args) {
+CalculationTask::CalculationTask(Calculator::ConstructorArgs args)
+    : start_time_{std::chrono::steady_clock::now()} {
   args.step_callback =
       std::bind_front(&CalculationTask::OnCalculationStep, this);
+  args.best_result_callback =
+      std::bind_front(&CalculationTask::OnBestResult, this);
 
-  task_ = std::async(std::launch::async, [args = std::move(args)]() {
-    return calc::Calculator{args}.TakeResult();
+  // vh: Statistics are read only after the result is ready. Calculator is
+  // kept after that, since it holds the trees for any number of clients.
+  task_ = std::async(std::launch::async, [this, args = std::move(args)]() {
+    auto calculator = std::make_shared<calc::Calculator>(args);
+    statistics_ = calculator->GetStatistics();
+    return calculator;
   });
 }
 
 ///
-CalculationTask::~CalculationTask() { Stop(); }
+CalculationTask::~CalculationTask() {
+  Stop();
+
+  if (task_.valid()) {
+    task_.wait();
+  }
+
+  delete best_result_mailbox_.exchange(nullptr);
+}
 
 ///
 void CalculationTask::Stop() { stop_requested_ = true; }
@@ -44,21 +60,64 @@ auto CalculationTask::IsRunning() const -> bool {
 ///
 auto CalculationTask::GetProgress() const -> float { return progress_; }
 
+///
+auto CalculationTask::GetTimeLeft() const
+    -> std::optional<std::chrono::seconds> {
+  const auto progress = progress_.load();
+
+  if (progress <= 0) {
+    return std::nullopt;
+  }
+
+  // vh: Progress counts the searched states, so the rest of them is expected
+  // to go at the same rate.
+  const auto time_spent = std::chrono::duration<float>{
+      std::chrono::steady_clock::now() - start_time_};
+
+  return std::chrono::duration_cast<std::chrono::seconds>(
+      time_spent * (1 - progress) / progress);
+}
+
 ///
 auto CalculationTask::GetResult() -> std::optional<std::vector<TreeNode>> {
   if (!task_.valid() || IsRunning()) {
     return std::nullopt;
   }
 
-  auto result = task_.get();
+  auto calculator = task_.get();
+  auto result = calculator->TakeResult();
 
-  task_ = std::future<std::vector<TreeNode>>{};
+  task_ = std::future<std::shared_ptr<Calculator>>{};
+  finished_calculator_ = std::move(calculator);
   stop_requested_ = false;
   progress_ = 0;
+  delete best_result_mailbox_.exchange(nullptr);
+  best_result_.reset();
 
   return std::move(result);
 }
 
+///
+auto CalculationTask::GetFinishedCalculator() const
+    -> std::shared_ptr<const Calculator> {
+  return finished_calculator_;
+}
+
+///
+auto CalculationTask::GetStatistics() const -> const Calculator::Statistics & {
+  return statistics_;
+}
+
+///
+auto CalculationTask::GetBestResult() -> const std::optional<BestResult> & {
+  if (auto *best_result = best_result_mailbox_.exchange(nullptr)) {
+    best_result_ = std::move(*best_result);
+    delete best_result;
+  }
+
+  return best_result_;
+}
+
 ///
 auto CalculationTask::OnCalculationStep(const calc::Calculator &calculator)
     -> calc::Calculator::StepStatus {
@@ -66,4 +125,19 @@ auto CalculationTask::OnCalculationStep(const calc::Calculator &calculator)
   return stop_requested_ ? calc::Calculator::StepStatus::kStopCalculation
                          : calc::Calculator::StepStatus::kContinueToNextStep;
 }
-}  // namespace vh::ponc::calc
\ No newline at end of file
+
+///
+void CalculationTask::OnBestResult(std::vector<TreeNode> calculated_trees) {
+  auto best_result = std::make_unique<BestResult>(
+      BestResult{.calculated_trees = std::move(calculated_trees)});
+
+  for (const auto &tree : best_result->calculated_trees) {
+    best_result->total_cost += tree.tree_cost;
+    best_result->num_clients += tree.num_clients;
+  }
+
+  // vh: Mailbox holds only the latest result, which the UI thread takes
+  // without waiting on the calculation.
+  delete best_result_mailbox_.exchange(best_result.release());
+}
+}  // namespace vh::ponc::calc
@@ -7,111 +7,484 @@
 #include "calc_calculator.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cmath>
 #include <compare>
+#include <cstdint>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <numeric>
 #include <optional>
 #include <set>
-#include <unordered_set>
+#include <span>
+#include <sstream>
+#include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "calc_convolution_search.h"
+#include "calc_reachable_outputs.h"
 #include "calc_resolution.h"
 #include "calc_tree_node.h"
+#include "calc_worker_pool.h"
 #include "cpp_assert.h"
 
 namespace vh::ponc::calc {
 namespace {
 ///
-auto MakePermutationTree(
-    const TreeNode &family_node,
-    const std::vector<std::optional<const TreeNode *>> &permutation) {
-  auto permutation_tree = family_node;
+constexpr auto kNoRow = RowIndex{-1};
+///
+constexpr auto kRootExtraRow = 0;
+///
+constexpr auto kFirstInputExtraRow = 1;
+///
+constexpr auto kClientFamily = FamilyIndex{0};
+///
+constexpr auto kNoOutput = OutputIndex{-1};
+///
+constexpr auto kNoLevel = -1;
+///
+constexpr auto kNoTreeCost = std::numeric_limits<Cost>::max();
+///
+constexpr auto kNumAnytimePasses = 3;
+///
+constexpr auto kPassClientsShift = 2;
+///
+constexpr auto kNumStepsPerStopCheck = 1024;
+///
+constexpr auto kProgressSmoothing = 0.25;
+///
+constexpr auto kMaxNumOutputRangeTries = 3;
+///
+constexpr auto kHashOffset = std::uint64_t{0xCBF29CE484222325};
+///
+constexpr auto kHashPrime = std::uint64_t{0x100000001B3};
 
-  for (auto output_index = 0;
-       output_index < static_cast<OutputIndex>(permutation.size());
-       ++output_index) {
-    const auto &best_output_tree = permutation[output_index];
+///
+auto HashCombine(std::uint64_t hash, std::int64_t value) {
+  for (auto byte = 0; byte < static_cast<int>(sizeof(value)); ++byte) {
+    hash ^= (static_cast<std::uint64_t>(value) >> (byte * CHAR_BIT)) & 0xFFU;
+    hash *= kHashPrime;
+  }
 
-    if (!best_output_tree.has_value()) {
-      continue;
+  return hash;
+}
+
+///
+template <typename T>
+void WriteValue(std::ostream &stream, T value) {
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+///
+template <typename T>
+auto ReadValue(std::istream &stream, T &value) {
+  stream.read(reinterpret_cast<char *>(&value), sizeof(value));
+  return static_cast<bool>(stream);
+}
+
+///
+template <typename T>
+using StreamedValue =
+    std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+
+///
+template <typename T>
+void WriteValues(std::ostream &stream, const std::vector<T> &values) {
+  WriteValue(stream, static_cast<std::uint64_t>(values.size()));
+
+  for (const auto value : values) {
+    WriteValue(stream, static_cast<StreamedValue<T>>(value));
+  }
+}
+
+///
+template <typename T>
+auto ReadValues(std::istream &stream, std::vector<T> &values) {
+  auto size = std::uint64_t{};
+
+  if (!ReadValue(stream, size)) {
+    return false;
+  }
+
+  values.clear();
+
+  // vh: Values are read one by one, so a broken size fails at the end of
+  // the stream. Flags are read as bytes, since not every byte is a bool.
+  for (; size > 0; --size) {
+    auto value = StreamedValue<T>{};
+
+    if (!ReadValue(stream, value)) {
+      return false;
+    }
+
+    values.emplace_back(static_cast<T>(value));
+  }
+
+  return true;
+}
+
+///
+void WriteFamilies(std::ostream &stream,
+                   const std::vector<TreeNode> &family_nodes) {
+  WriteValue(stream, static_cast<std::uint64_t>(family_nodes.size()));
+
+  for (const auto &family_node : family_nodes) {
+    WriteValue(stream, static_cast<std::uint64_t>(family_node.family_id.Get()));
+    WriteValue(stream, family_node.node_cost);
+    WriteValue(stream, family_node.tree_cost);
+    WriteValue(stream, family_node.num_clients);
+    WriteValues(stream, family_node.outputs);
+  }
+}
+
+///
+auto ReadFamilies(std::istream &stream, std::vector<TreeNode> &family_nodes) {
+  auto num_family_nodes = std::uint64_t{};
+
+  if (!ReadValue(stream, num_family_nodes)) {
+    return false;
+  }
+
+  family_nodes.clear();
+
+  for (; num_family_nodes > 0; --num_family_nodes) {
+    auto &family_node = family_nodes.emplace_back();
+    auto family_id = std::uint64_t{};
+
+    if (!ReadValue(stream, family_id) ||
+        !ReadValue(stream, family_node.node_cost) ||
+        !ReadValue(stream, family_node.tree_cost) ||
+        !ReadValue(stream, family_node.num_clients) ||
+        !ReadValues(stream, family_node.outputs)) {
+      return false;
     }
 
-    permutation_tree.tree_cost += (*best_output_tree)->tree_cost;
-    permutation_tree.num_clients += (*best_output_tree)->num_clients;
-    permutation_tree.child_nodes.emplace(output_index, **best_output_tree);
+    family_node.family_id =
+        core::FamilyId{static_cast<std::uintptr_t>(family_id)};
   }
 
-  return permutation_tree;
+  return true;
 }
 
 ///
-constexpr auto kRootInput = std::numeric_limits<FlowValue>::max();
+auto GetNumLimitLevels(int limit) { return (limit > 0) ? (limit + 1) : 1; }
+
+///
+auto FindPassNumClients(NumClients num_clients, bool anytime) {
+  if (!anytime) {
+    return std::vector<NumClients>{num_clients};
+  }
+
+  // vh: Every pass has four times more clients, so the early passes, which
+  // give the intermediate results, take a small part of the whole time.
+  auto pass_num_clients = std::vector<NumClients>{};
+
+  for (auto pass_index = kNumAnytimePasses - 1; pass_index >= 0;
+       --pass_index) {
+    const auto pass_clients = num_clients >> (kPassClientsShift * pass_index);
+
+    if ((pass_clients > 0) && (pass_num_clients.empty() ||
+                               (pass_clients > pass_num_clients.back()))) {
+      pass_num_clients.emplace_back(pass_clients);
+    }
+  }
+
+  return pass_num_clients;
+}
 }  // namespace
 
 ///
 Calculator::Calculator(const ConstructorArgs &args)
     : min_output_{ToCalculatorResolution(args.settings.min_output)},
       max_output_{ToCalculatorResolution(args.settings.max_output)},
+      requested_max_output_{max_output_},
       num_clients_{args.settings.num_clients},
+      engine_{args.settings.engine},
+      num_layouts_{std::max(args.settings.num_layouts, 1)},
+      flow_step_{ToCalculatorFlowStep(args.settings.flow_resolution)},
+      only_output_trees_{args.only_output_trees},
+      beam_width_{std::max(args.settings.beam_width, 0)},
+      max_depth_{std::max(args.settings.max_depth, 0)},
+      max_devices_{std::max(args.settings.max_devices, 0)},
+      num_levels_{GetNumPathLevels(args.settings)},
+      num_workers_{WorkerPool::GetNumWorkers(args.settings.num_processes)},
       input_nodes_{args.input_nodes},
       client_node_{args.client_node},
       family_nodes_{args.family_nodes},
-      step_callback_{args.step_callback} {
+      step_callback_{args.step_callback},
+      best_result_callback_{args.best_result_callback},
+      best_trees_cache_{args.best_trees_cache},
+      thread_pool_{args.thread_pool} {
+  if (const auto num_threads =
+          ThreadPool::GetNumThreads(args.settings.num_threads);
+      (thread_pool_ == nullptr) && (num_threads > 1)) {
+    thread_pool_ = std::make_shared<ThreadPool>(num_threads);
+  }
+
   std::stable_sort(family_nodes_.begin(), family_nodes_.end(),
                    [](const auto &left, const auto &right) {
                      return std::pair{left.node_cost, left.outputs.size()} <
                             std::pair{right.node_cost, right.outputs.size()};
                    });
 
-  FindUniqueOutputs();
-  FindBestOutputTrees();
-  FindBestRootTree();
+  root_family_.outputs.resize(input_nodes_.size());
+
+  if (max_devices_ > 0) {
+    max_depth_ = std::min(max_depth_, max_devices_);
+  }
+
+  // vh: Beam drops most of the trees, which the alternative layouts are made
+  // of.
+  if (beam_width_ > 0) {
+    num_layouts_ = 1;
+  }
+
+  if (!UsesCache(args.settings)) {
+    best_trees_cache_.reset();
+  }
+
+  RemoveDominatedFamilies();
+
+  // vh: Coarser grid snaps the outputs, so the exact ones are kept to check
+  // the results and to search again on a finer grid.
+  exact_input_nodes_ = input_nodes_;
+  exact_family_nodes_ = family_nodes_;
+
+  UseFlowStep(flow_step_);
+
+  if (best_trees_cache_ != nullptr) {
+    FindCachedBestTrees();
+  }
+
+  // vh: Cached trees make the whole calculation fast, so intermediate results
+  // are not needed.
+  const auto show_intermediate_results =
+      (best_result_callback_ != nullptr) && !cached_entry_.has_value();
+
+  const auto pass_num_clients = FindPassNumClients(
+      args.settings.num_clients, show_intermediate_results);
+
+  for (const auto num_clients : pass_num_clients) {
+    num_work_units_ += static_cast<std::int64_t>(unique_outputs_.size()) *
+                       num_levels_ * num_clients;
+  }
+
+  for (const auto num_clients : pass_num_clients) {
+    num_clients_ = num_clients;
+    FindBestTrees();
+
+    if ((num_clients_ == pass_num_clients.back()) || IsStopped()) {
+      break;
+    }
+
+    ReportBestResult();
+  }
+
+  FitResultToOutputRange();
+
+  if (stopped_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  if (best_trees_cache_ != nullptr) {
+    StoreCachedBestTrees();
+  }
+
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+
+  if (const auto root_num_clients =
+          best_trees_.FindMaxNumClients(root_row, num_clients_);
+      root_num_clients > 0) {
+    result_cost_ = best_trees_.GetCost(root_row, root_num_clients);
+    lower_bound_cost_ = FindLowerBoundCost(root_num_clients);
+  }
+}
+
+///
+auto Calculator::RunWorker() -> int {
+  // vh: First request sets up the worker, the rest of them find the rows.
+  auto worker = std::unique_ptr<Calculator>{};
+
+  return WorkerPool::RunWorker([&worker](const auto &request) -> std::string {
+    if (worker != nullptr) {
+      return worker->ProcessWorkerRequest(request);
+    }
+
+    worker = std::unique_ptr<Calculator>{new Calculator{}};
+    auto request_stream = std::istringstream{request};
+
+    if (!worker->ReadWorkerSetup(request_stream)) {
+      return {};
+    }
+
+    auto reply = std::ostringstream{};
+    WriteValue(reply, worker->best_trees_.GetNumOutputRows());
+    return std::move(reply).str();
+  });
+}
+
+///
+auto Calculator::UsesCache(const core::CalculatorSettings &settings) -> bool {
+  // vh: Beam drops most of the trees, which the cached rows are made of.
+  // Cache holds only the best trees, which are not enough to find the
+  // alternative layouts. Cached trees are found for the paths of any length.
+  return (settings.beam_width <= 0) && (settings.num_layouts <= 1) &&
+         (GetNumPathLevels(settings) <= 1);
+}
+
+///
+auto Calculator::GetNumPathLevels(const core::CalculatorSettings &settings)
+    -> int {
+  // vh: Path never has more splitters than devices, so the depth above the
+  // number of devices adds no levels.
+  auto max_depth = std::max(settings.max_depth, 0);
+
+  if (settings.max_devices > 0) {
+    max_depth = std::min(max_depth, settings.max_devices);
+  }
+
+  return GetNumLimitLevels(max_depth) *
+         GetNumLimitLevels(std::max(settings.max_devices, 0));
 }
 
 ///
 auto Calculator::GetProgress() const -> float {
-  if (unique_outputs_.empty() || best_trees_.empty()) {
+  const auto num_done_states = GetNumDoneStates();
+
+  if (num_done_states <= 0) {
     return 0;
   }
 
-  const auto min_output = *unique_outputs_.cbegin();
-  const auto max_output = *unique_outputs_.crbegin();
-  const auto working_on_output =
-      std::clamp(best_trees_.crbegin()->first, min_output, max_output);
+  const auto num_states_left =
+      static_cast<double>(
+          num_work_units_ -
+          num_done_work_units_.load(std::memory_order_relaxed)) *
+      num_states_per_work_unit_.load(std::memory_order_relaxed);
+
+  return static_cast<float>(static_cast<double>(num_done_states) /
+                            (static_cast<double>(num_done_states) +
+                             num_states_left));
+}
+
+///
+auto Calculator::GetStatistics() const -> Statistics {
+  return {.num_expanded_nodes =
+              num_expanded_nodes_.load(std::memory_order_relaxed),
+          .num_pruned_nodes = num_pruned_nodes_.load(std::memory_order_relaxed),
+          .num_removed_families = num_removed_families_,
+          .num_removed_outputs = num_removed_outputs_,
+          .result_cost = result_cost_,
+          .lower_bound_cost = lower_bound_cost_};
+}
+
+///
+auto Calculator::TakeResult() -> std::vector<TreeNode> { return MakeResult(); }
+
+///
+auto Calculator::GetCostCurve() const -> std::vector<CostCurvePoint> {
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+  auto cost_curve = std::vector<CostCurvePoint>{};
+
+  // vh: Root row holds the best trees for every number of clients, so the
+  // whole curve comes from a single run.
+  for (auto num_clients = 1; num_clients <= num_clients_; ++num_clients) {
+    if (best_trees_.HasTree(root_row, num_clients) &&
+        IsResultInRange(MakeCostCurveResult(num_clients))) {
+      cost_curve.emplace_back(CostCurvePoint{
+          .num_clients = num_clients,
+          .total_cost = best_trees_.GetCost(root_row, num_clients)});
+    }
+  }
+
+  return cost_curve;
+}
+
+///
+auto Calculator::MakeLayoutResults() const
+    -> std::vector<std::vector<TreeNode>> {
+  if (!alternative_trees_.has_value()) {
+    return {MakeResult()};
+  }
+
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+  const auto root_num_clients =
+      best_trees_.FindMaxNumClients(root_row, num_clients_);
+
+  if (root_num_clients <= 0) {
+    return {input_nodes_};
+  }
+
+  auto search = LayoutSearch{};
+  auto layout_results = std::vector<std::vector<TreeNode>>{};
+
+  for (auto rank = 0; rank < num_layouts_; ++rank) {
+    if (FindLayoutDerivation(search, root_row, root_num_clients, rank) ==
+        nullptr) {
+      break;
+    }
+
+    const auto root_tree =
+        MakeLayoutTree(search, root_row, root_num_clients, rank);
+
+    auto calculated_trees = std::vector<TreeNode>{};
+    calculated_trees.reserve(input_nodes_.size());
+
+    for (auto input_index = 0;
+         input_index < static_cast<int>(input_nodes_.size()); ++input_index) {
+      const auto input_tree = root_tree.child_nodes.find(input_index);
+
+      calculated_trees.emplace_back((input_tree != root_tree.child_nodes.cend())
+                                        ? input_tree->second
+                                        : input_nodes_[input_index]);
+    }
+
+    if (IsResultInRange(calculated_trees)) {
+      layout_results.emplace_back(std::move(calculated_trees));
+    }
+  }
+
+  if (layout_results.empty()) {
+    return {MakeResult()};
+  }
 
-  return static_cast<float>(working_on_output - min_output) /
-         static_cast<float>(max_output - min_output);
+  return layout_results;
 }
 
 ///
-auto Calculator::TakeResult() -> std::vector<TreeNode> {
-  const auto best_output_trees = best_trees_.find(kRootInput);
+auto Calculator::MakeCostCurveResult(NumClients num_clients) const
+    -> std::vector<TreeNode> {
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
 
-  if (best_output_trees == best_trees_.cend()) {
-    return std::move(input_nodes_);
+  if ((num_clients <= 0) || (num_clients > num_clients_) ||
+      !best_trees_.HasTree(root_row, num_clients)) {
+    return input_nodes_;
   }
 
-  Expects(!best_output_trees->second.empty());
-  const auto best_output_tree = best_output_trees->second.crbegin();
+  const auto input_num_clients =
+      best_trees_.GetChildNumClients(root_row, num_clients);
 
-  Expects(best_output_tree->second.outputs.size() == input_nodes_.size());
+  Expects(input_num_clients.size() == input_nodes_.size());
 
   auto calculated_trees = std::vector<TreeNode>{};
   calculated_trees.reserve(input_nodes_.size());
 
-  for (auto output_index = 0;
-       output_index < static_cast<OutputIndex>(input_nodes_.size());
-       ++output_index) {
-    const auto calculated_tree =
-        best_output_tree->second.child_nodes.find(output_index);
+  for (auto input_index = 0;
+       input_index < static_cast<int>(input_nodes_.size()); ++input_index) {
+    const auto input_clients = input_num_clients[input_index];
 
-    if (calculated_tree == best_output_tree->second.child_nodes.cend()) {
-      calculated_trees.emplace_back(std::move(input_nodes_[output_index]));
+    if (input_clients <= 0) {
+      calculated_trees.emplace_back(input_nodes_[input_index]);
       continue;
     }
 
-    calculated_trees.emplace_back(calculated_tree->second);
+    calculated_trees.emplace_back(MakeTree(
+        best_trees_.GetExtraRow(kFirstInputExtraRow + input_index),
+        input_clients));
   }
 
   return calculated_trees;
@@ -123,213 +496,1926 @@ auto Calculator::IsOutputInRange(FlowValue ouput) const {
 }
 
 ///
-auto Calculator::IsStopped() {
-  return step_callback_(*this) == StepStatus::kStopCalculation;
+auto Calculator::IsStopped() -> bool {
+  if (stopped_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+
+  if (step_callback_(*this) == StepStatus::kStopCalculation) {
+    stopped_.store(true, std::memory_order_relaxed);
+    return true;
+  }
+
+  return false;
+}
+
+///
+template <int kNumOutputs>
+auto Calculator::IsStopped(PermutationSearch<kNumOutputs> &search) -> bool {
+  // vh: Callback is only asked once in a while, since the search makes
+  // millions of steps, each of which is cheaper than the call.
+  if (++search.num_steps_since_stop_check < kNumStepsPerStopCheck) {
+    return stopped_.load(std::memory_order_relaxed);
+  }
+
+  search.num_steps_since_stop_check = 0;
+  AddStatistics(search.statistics);
+  search.statistics = {};
+
+  return IsStopped();
 }
 
 ///
-void Calculator::FindUniqueOutputs() {
-  for (const auto &input_node : input_nodes_) {
-    for (const auto output : input_node.outputs) {
-      unique_outputs_.emplace(output);
-    }
+void Calculator::RemoveDominatedFamilies() {
+  const auto num_families = static_cast<int>(family_nodes_.size());
+  auto sorted_outputs = std::vector<std::vector<FlowValue>>{};
+  sorted_outputs.reserve(num_families);
+
+  for (const auto &family_node : family_nodes_) {
+    auto &outputs = sorted_outputs.emplace_back(family_node.outputs);
+    std::sort(outputs.begin(), outputs.end());
   }
 
-  auto visited_outputs = std::unordered_set<FlowValue>{};
+  // vh: Family is dominated by one which has the same outputs and some more
+  // for the same or lower cost. Outputs with higher flow don't dominate lower
+  // ones, since they could put clients above the max output.
+  const auto is_dominated = [this, num_families,
+                             &sorted_outputs](const auto family_index) {
+    const auto &family_node = family_nodes_[family_index];
+    const auto &outputs = sorted_outputs[family_index];
 
-  while (visited_outputs.size() < unique_outputs_.size()) {
-    for (const auto output : unique_outputs_) {
-      if (visited_outputs.contains(output)) {
+    for (auto other_index = 0; other_index < num_families; ++other_index) {
+      if (other_index == family_index) {
         continue;
       }
 
-      for (const auto &family_node : family_nodes_) {
-        for (const auto family_output : family_node.outputs) {
-          const auto output_sum = output + family_output;
+      const auto &other_node = family_nodes_[other_index];
+      const auto &other_outputs = sorted_outputs[other_index];
 
-          if (output_sum >= min_output_) {
-            unique_outputs_.emplace(output_sum);
-          }
-        }
+      if ((other_node.node_cost > family_node.node_cost) ||
+          !std::includes(other_outputs.cbegin(), other_outputs.cend(),
+                         outputs.cbegin(), outputs.cend())) {
+        continue;
       }
 
-      visited_outputs.emplace(output);
-    }
-  }
-}
+      if (const auto families_are_equal =
+              (other_node.node_cost == family_node.node_cost) &&
+              (other_outputs == outputs);
+          families_are_equal && (other_index > family_index)) {
+        continue;
+      }
 
-///
-void Calculator::FindBestOutputTrees() {
-  for (const auto output : unique_outputs_) {
-    if (IsStopped()) {
-      return;
+      return true;
     }
 
-    if (IsOutputInRange(output)) {
-      best_trees_.emplace(
-          output, std::map{std::pair{client_node_.num_clients, client_node_}});
-    }
+    return false;
+  };
+
+  auto family_nodes = std::vector<TreeNode>{};
 
-    for (const auto &family_node : family_nodes_) {
-      FindBestTreesForOutput(output, family_node);
+  for (auto family_index = 0; family_index < num_families; ++family_index) {
+    if (!is_dominated(family_index)) {
+      family_nodes.emplace_back(std::move(family_nodes_[family_index]));
     }
   }
+
+  num_removed_families_ = num_families - static_cast<int>(family_nodes.size());
+  family_nodes_ = std::move(family_nodes);
 }
 
 ///
-void Calculator::FindBestTreesForOutput(FlowValue output,
-                                        const TreeNode &family_node) {
-  auto permutation =
-      std::vector<std::optional<const TreeNode *>>(family_node.outputs.size());
-  auto num_clients_indices = std::unordered_map<FlowValue, NumClientsIndex>{};
+void Calculator::SnapOutputsToFlowStep(FlowValue flow_step) {
+  // vh: Every flow is the sum of an input output and the family outputs on
+  // the way to it. When all of them are rounded down to the step, the flows
+  // get onto the grid of the step and there are fewer unique outputs. Flow
+  // of a client is then never above the real one and is lower by less than
+  // the step for each node on its path, including the input. So clients never
+  // get below the min output, but could get above the max output by less than
+  // (depth + 1) * step, which is checked on the results.
+  if (flow_step <= 1) {
+    return;
+  }
 
-  for (const auto family_output : family_node.outputs) {
-    const auto output_sum = output + family_output;
-    num_clients_indices.emplace(output_sum, 0);
+  for (auto &input_node : input_nodes_) {
+    for (auto &output : input_node.outputs) {
+      output = SnapToFlowStep(output, flow_step);
+    }
   }
 
-  MakeBestTreesPermutation(output, family_node, permutation, 0,
-                           num_clients_indices);
+  for (auto &family_node : family_nodes_) {
+    for (auto &output : family_node.outputs) {
+      output = SnapToFlowStep(output, flow_step);
+    }
+  }
 }
 
 ///
-auto Calculator::TestBestTreesPermutation(
-    FlowValue output, const TreeNode &family_node,
-    std::vector<std::optional<const TreeNode *>> &permutation,
-    FlowValue output_index) {
-  auto permutation_num_clients = 0;
-  auto permutation_tree_cost = family_node.node_cost;
+void Calculator::UseFlowStep(FlowValue flow_step) {
+  input_nodes_ = exact_input_nodes_;
+  family_nodes_ = exact_family_nodes_;
+  snapped_flow_step_ = flow_step;
+  SnapOutputsToFlowStep(flow_step);
+  FindUniqueOutputs();
+}
 
-  for (const auto &best_output_tree : permutation) {
-    if (!best_output_tree.has_value()) {
-      continue;
-    }
+///
+void Calculator::FindUniqueOutputs() {
+  auto reachable_outputs_args =
+      ReachableOutputs::ConstructorArgs{.min_output = min_output_};
 
-    permutation_num_clients += (*best_output_tree)->num_clients;
-    permutation_tree_cost += (*best_output_tree)->tree_cost;
+  for (const auto &input_node : input_nodes_) {
+    reachable_outputs_args.start_outputs.insert(
+        reachable_outputs_args.start_outputs.cend(),
+        input_node.outputs.cbegin(), input_node.outputs.cend());
   }
 
-  if (permutation_num_clients > num_clients_) {
-    return false;
+  for (const auto &family_node : family_nodes_) {
+    reachable_outputs_args.family_outputs.insert(
+        reachable_outputs_args.family_outputs.cend(),
+        family_node.outputs.cbegin(), family_node.outputs.cend());
   }
 
-  const auto best_existing_tree = GetBestTree(output, permutation_num_clients);
+  auto reachable_outputs = ReachableOutputs{reachable_outputs_args};
 
-  if (best_existing_tree.has_value() &&
-      permutation_tree_cost > (*best_existing_tree)->tree_cost) {
-    return false;
+  num_removed_outputs_ =
+      reachable_outputs.RemoveOutputsNotLeadingTo(min_output_, max_output_);
+  unique_outputs_ = reachable_outputs.GetSortedOutputs();
+}
+
+///
+void Calculator::FindCachedBestTrees() {
+  cache_key_ = MakeCacheKey();
+  auto cached_entry = best_trees_cache_->Find(cache_key_);
+
+  // vh: Client cost is a part of every tree, so nothing could be reused.
+  if (!cached_entry.has_value() ||
+      (cached_entry->client_cost != client_node_.tree_cost)) {
+    return;
   }
 
-  if (const auto permutation_is_ready =
-          output_index >=
-          static_cast<OutputIndex>(family_node.outputs.size())) {
-    if (permutation_num_clients <= 0) {
-      return false;
+  cached_entry_ = std::move(*cached_entry);
+
+  const auto &cached_best_trees = *cached_entry_->best_trees;
+  const auto num_families = static_cast<int>(family_nodes_.size());
+
+  cached_num_clients_ =
+      std::min(cached_best_trees.GetMaxNumClients(), num_clients_);
+  cached_family_indices_.assign(cached_entry_->family_ids.size() + 1,
+                                kClientFamily);
+  increased_cost_families_.assign(num_families + 1, false);
+  decreased_cost_families_.assign(num_families + 1, false);
+
+  // vh: Families are sorted by cost, so their indices could change.
+  for (auto cached_index = 0;
+       cached_index < static_cast<int>(cached_entry_->family_ids.size());
+       ++cached_index) {
+    const auto family_node = std::find_if(
+        family_nodes_.cbegin(), family_nodes_.cend(),
+        [family_id = cached_entry_->family_ids[cached_index]](
+            const auto &family_node) {
+          return family_node.family_id == family_id;
+        });
+
+    // vh: Entry of other families could come with a broken file or a hash
+    // collision, and its trees would point to the wrong families.
+    if (family_node == family_nodes_.cend()) {
+      cached_entry_.reset();
+      return;
     }
 
-    if (!best_existing_tree.has_value()) {
-      best_trees_[output][permutation_num_clients] =
-          MakePermutationTree(family_node, permutation);
-      return false;
-    }
+    const auto family_index = kClientFamily + 1 +
+                              static_cast<FamilyIndex>(std::distance(
+                                  family_nodes_.cbegin(), family_node));
+    const auto cached_cost = cached_entry_->family_costs[cached_index];
 
-    if (permutation_tree_cost < (*best_existing_tree)->tree_cost) {
-      **best_existing_tree = MakePermutationTree(family_node, permutation);
-    }
+    cached_family_indices_[kClientFamily + 1 + cached_index] = family_index;
+    increased_cost_families_[family_index] =
+        family_node->node_cost > cached_cost;
+    decreased_cost_families_[family_index] =
+        family_node->node_cost < cached_cost;
+  }
 
-    // TODO(vh): Compare equal cost trees.
-    return false;
+  // vh: Permutations could miss the best trees, and which ones they miss
+  // depends on the costs, the client count and the trees kept in the row.
+  // Rows are only reused when none of these changed, so the result is the
+  // same as in a run without the cache.
+  if ((engine_ != core::CalculatorEngine::kConvolution) &&
+      ((cached_best_trees.GetMaxNumClients() != num_clients_) ||
+       std::any_of(increased_cost_families_.cbegin(),
+                   increased_cost_families_.cend(),
+                   [](const auto increased) { return increased; }) ||
+       std::any_of(decreased_cost_families_.cbegin(),
+                   decreased_cost_families_.cend(),
+                   [](const auto decreased) { return decreased; }))) {
+    cached_entry_.reset();
+    return;
   }
 
-  return true;
+  // vh: Cached outputs are kept, so the stored trees grow with every run.
+  auto cached_outputs = std::vector<FlowValue>{};
+
+  for (auto row = 0; row < cached_best_trees.GetNumOutputRows(); ++row) {
+    cached_outputs.emplace_back(cached_best_trees.GetOutput(row));
+  }
+
+  auto unique_outputs = std::vector<FlowValue>{};
+  std::set_union(unique_outputs_.cbegin(), unique_outputs_.cend(),
+                 cached_outputs.cbegin(), cached_outputs.cend(),
+                 std::back_inserter(unique_outputs));
+  unique_outputs_ = std::move(unique_outputs);
 }
 
 ///
-// NOLINTNEXTLINE(*-no-recursion)
-void Calculator::MakeBestTreesPermutation(
-    FlowValue output, const TreeNode &family_node,
-    std::vector<std::optional<const TreeNode *>> &permutation,
-    FlowValue output_index,
-    std::unordered_map<FlowValue, NumClientsIndex> num_clients_indices) {
-  if (IsStopped()) {
-    return;
+auto Calculator::MakeCacheKey() const -> BestTreesCache::Key {
+  auto hash = kHashOffset;
+
+  // vh: Trees of the outputs don't depend on the inputs. Client count and
+  // costs are not a part of the key, since trees could be updated for them.
+  for (const auto value :
+       {std::int64_t{min_output_}, std::int64_t{max_output_},
+        static_cast<std::int64_t>(engine_),
+        static_cast<std::int64_t>(client_node_.family_id.Get()),
+        std::int64_t{client_node_.num_clients},
+        static_cast<std::int64_t>(family_nodes_.size())}) {
+    hash = HashCombine(hash, value);
   }
 
-  if (!TestBestTreesPermutation(output, family_node, permutation,
-                                output_index)) {
-    return;
+  auto family_nodes = std::vector<const TreeNode *>{};
+
+  for (const auto &family_node : family_nodes_) {
+    family_nodes.emplace_back(&family_node);
   }
 
-  const auto next_ouput_index = output_index + 1;
+  std::sort(family_nodes.begin(), family_nodes.end(),
+            [](const auto *left, const auto *right) {
+              return left->family_id.Get() < right->family_id.Get();
+            });
 
-  Expects(output_index >= 0);
-  const auto output_sum = output + family_node.outputs[output_index];
-  const auto best_output_trees = best_trees_.find(output_sum);
+  for (const auto *family_node : family_nodes) {
+    hash = HashCombine(hash,
+                       static_cast<std::int64_t>(family_node->family_id.Get()));
+    hash = HashCombine(hash,
+                       static_cast<std::int64_t>(family_node->outputs.size()));
+
+    for (const auto output : family_node->outputs) {
+      hash = HashCombine(hash, output);
+    }
+  }
 
-  if (best_output_trees != best_trees_.cend()) {
-    const auto num_clients_index = num_clients_indices.find(output_sum);
-    Expects(num_clients_index != num_clients_indices.cend());
+  return hash;
+}
 
-    auto best_output_tree = best_output_trees->second.crbegin();
-    std::advance(best_output_tree, num_clients_index->second);
+///
+auto Calculator::MakeInputsKey() const -> BestTreesCache::Key {
+  auto hash =
+      HashCombine(kHashOffset, static_cast<std::int64_t>(input_nodes_.size()));
 
-    for (; best_output_tree != best_output_trees->second.crend();
-         ++best_output_tree) {
-      permutation[output_index] = &best_output_tree->second;
-      MakeBestTreesPermutation(output, family_node, permutation,
-                               next_ouput_index, num_clients_indices);
+  for (const auto &input_node : input_nodes_) {
+    hash = HashCombine(hash, std::int64_t{input_node.node_cost});
+    hash = HashCombine(hash,
+                       static_cast<std::int64_t>(input_node.outputs.size()));
 
-      ++num_clients_index->second;
+    for (const auto output : input_node.outputs) {
+      hash = HashCombine(hash, output);
     }
   }
 
-  permutation[output_index] = std::nullopt;
-  MakeBestTreesPermutation(output, family_node, permutation, next_ouput_index,
-                           num_clients_indices);
+  return hash;
 }
 
 ///
-auto Calculator::GetBestTree(FlowValue output, NumClients num_clients)
-    -> std::optional<TreeNode *> {
-  const auto best_output_trees = best_trees_.find(output);
-
-  if (best_output_trees == best_trees_.cend()) {
-    return std::nullopt;
+void Calculator::StoreCachedBestTrees() const {
+  auto entry = BestTreesCache::Entry{
+      .best_trees = std::make_shared<const BestTreesTable>(best_trees_),
+      .client_cost = client_node_.tree_cost};
+
+  // vh: Root tree is not found when only the output trees are.
+  if (!only_output_trees_) {
+    entry.inputs_key = MakeInputsKey();
   }
 
-  const auto best_num_clients_tree =
-      best_output_trees->second.find(num_clients);
-
-  if (best_num_clients_tree == best_output_trees->second.cend()) {
-    return std::nullopt;
+  for (const auto &family_node : family_nodes_) {
+    entry.family_ids.emplace_back(family_node.family_id);
+    entry.family_costs.emplace_back(family_node.node_cost);
   }
 
-  return &best_num_clients_tree->second;
+  best_trees_cache_->Store(cache_key_, std::move(entry));
 }
 
 ///
-void Calculator::FindBestRootTree() {
-  auto root_family = TreeNode{};
-  root_family.outputs.reserve(input_nodes_.size());
+auto Calculator::SplitOutputsIntoWaves() const
+    -> std::vector<std::vector<RowIndex>> {
+  auto family_outputs = std::set<FlowValue>{};
+
+  for (const auto &family_node : family_nodes_) {
+    family_outputs.insert(family_node.outputs.cbegin(),
+                          family_node.outputs.cend());
+  }
 
-  auto next_node_input = kRootInput - 1;
+  // vh: Rows could only be split if every family output lowers the flow,
+  // otherwise a row would depend on itself or on the higher ones.
+  if (!family_outputs.empty() && (*family_outputs.crbegin() >= 0)) {
+    return {};
+  }
 
-  for (const auto &input_node : input_nodes_) {
-    root_family.outputs.emplace_back(next_node_input - kRootInput);
+  const auto num_output_rows = best_trees_.GetNumOutputRows();
 
-    auto input_node_family = input_node;
+  auto row_waves = std::vector<std::vector<RowIndex>>{};
+  auto wave_indices = std::vector<int>(num_output_rows);
+  auto child_rows = std::vector<RowIndex>{};
 
-    std::transform(input_node_family.outputs.cbegin(),
-                   input_node_family.outputs.cend(),
-                   input_node_family.outputs.begin(),
-                   [next_node_input](const auto output) {
-                     return output - next_node_input;
-                   });
+  // vh: Children are on lower outputs and on the same or lower levels, so
+  // they come before the row and already have their waves.
+  for (auto row = 0; row < num_output_rows; ++row) {
+    auto wave_index = 0;
+
+    for (auto family_index = kClientFamily + 1;
+         family_index <= static_cast<FamilyIndex>(family_nodes_.size());
+         ++family_index) {
+      FindChildRows(row, family_index, child_rows);
+
+      for (const auto child_row : child_rows) {
+        if (child_row != kNoRow) {
+          wave_index = std::max(wave_index, wave_indices[child_row] + 1);
+        }
+      }
+    }
+
+    wave_indices[row] = wave_index;
+
+    if (wave_index >= static_cast<int>(row_waves.size())) {
+      row_waves.resize(wave_index + 1);
+    }
+
+    row_waves[wave_index].emplace_back(row);
+  }
+
+  return row_waves;
+}
+
+///
+void Calculator::FindBestTrees() {
+  // vh: Extra rows hold the root tree and the trees of every input node.
+  best_trees_ = BestTreesTable{
+      unique_outputs_, num_levels_,
+      kFirstInputExtraRow + static_cast<int>(input_nodes_.size()),
+      num_clients_};
+  min_costs_per_client_.assign(best_trees_.GetNumRows(), std::nullopt);
+  cached_rows_.assign(best_trees_.GetNumOutputRows(), false);
+  changed_rows_.assign(best_trees_.GetNumOutputRows(), true);
+
+  if (num_layouts_ > 1) {
+    alternative_trees_.emplace(AlternativeTrees::ConstructorArgs{
+        .num_rows = best_trees_.GetNumRows(),
+        .max_num_clients = num_clients_,
+        .max_num_trees = num_layouts_});
+  }
+
+  if (cached_entry_.has_value()) {
+    const auto &cached_best_trees = *cached_entry_->best_trees;
+
+    for (auto row = 0; row < best_trees_.GetNumOutputRows(); ++row) {
+      if (const auto cached_row =
+              cached_best_trees.FindOutputRow(best_trees_.GetOutput(row))) {
+        best_trees_.CopyRow(cached_best_trees, *cached_row, row,
+                            cached_family_indices_);
+        cached_rows_[row] = true;
+      }
+    }
+  }
+
+  FindBestOutputTrees();
+
+  // vh: Batch finds the output trees of all diagrams at once and leaves the
+  // root trees to each of them.
+  if (!only_output_trees_) {
+    FindBestRootTree();
+  }
+}
+
+///
+void Calculator::FindBestOutputTrees() {
+  // vh: Workers only exchange the best trees, which are not enough to find
+  // the alternative layouts.
+  if ((num_workers_ > 0) && !alternative_trees_.has_value()) {
+    if (const auto row_waves = SplitOutputsIntoWaves(); !row_waves.empty()) {
+      FindBestOutputTreesInWorkers(row_waves);
+      return;
+    }
+  }
+
+  if (thread_pool_ != nullptr) {
+    if (const auto row_waves = SplitOutputsIntoWaves(); !row_waves.empty()) {
+      FindBestOutputTreesInWaves(row_waves);
+      return;
+    }
+  }
+
+  for (auto row = 0; row < best_trees_.GetNumOutputRows(); ++row) {
+    if (IsStopped()) {
+      return;
+    }
+
+    FindBestTreesForOutput(row);
+  }
+}
+
+///
+void Calculator::FindBestOutputTreesInWaves(
+    const std::vector<std::vector<RowIndex>> &row_waves) {
+  Expects(thread_pool_ != nullptr);
+
+  for (const auto &wave : row_waves) {
+    if (IsStopped()) {
+      return;
+    }
+
+    // vh: Outputs of the wave only read trees of the previous waves, so they
+    // are independent and each of them is written by a single task.
+    auto tasks = std::vector<ThreadPool::Task>{};
+    tasks.reserve(wave.size());
+
+    for (const auto row : wave) {
+      tasks.emplace_back([this, row]() { FindBestTreesForOutput(row); });
+    }
+
+    thread_pool_->RunAndWait(std::move(tasks));
+  }
+}
+
+///
+void Calculator::FindBestOutputTreesInWorkers(
+    const std::vector<std::vector<RowIndex>> &row_waves) {
+  // vh: Workers get the families and outputs of the table first. Each wave
+  // is split into ranges of outputs, one per worker. Worker gets only the
+  // rows which its range reads and keeps only them and the range, so the
+  // whole table is only in this process, which merges the results.
+  auto worker_pool = WorkerPool{num_workers_};
+  const auto num_workers = worker_pool.GetSize();
+  auto merged_rows = std::vector<bool>(best_trees_.GetNumOutputRows());
+
+  // vh: If workers could not be made or any of them fails, the rest of the
+  // rows are found in this process.
+  const auto find_rest_in_process = [this, &row_waves,
+                                     &merged_rows](auto wave) {
+    for (; wave != row_waves.cend(); ++wave) {
+      for (const auto row : *wave) {
+        if (IsStopped()) {
+          return;
+        }
+
+        if (!merged_rows[row]) {
+          FindBestTreesForOutput(row);
+        }
+      }
+    }
+  };
+
+  if ((num_workers <= 0) || !SetUpWorkers(worker_pool)) {
+    find_rest_in_process(row_waves.cbegin());
+    return;
+  }
+
+  for (auto wave = row_waves.cbegin(); wave != row_waves.cend(); ++wave) {
+    if (IsStopped()) {
+      return;
+    }
+
+    const auto num_wave_rows = static_cast<int>(wave->size());
+    auto requests = std::vector<std::string>{};
+    requests.reserve(num_workers);
+
+    for (auto worker_index = 0; worker_index < num_workers; ++worker_index) {
+      const auto first_row = num_wave_rows * worker_index / num_workers;
+      const auto last_row = num_wave_rows * (worker_index + 1) / num_workers;
+      const auto rows =
+          std::span{*wave}.subspan(first_row, last_row - first_row);
+      const auto read_rows = FindReadRows(rows);
+      auto request = std::ostringstream{};
+
+      WriteValue(request, static_cast<std::uint64_t>(rows.size()));
+
+      for (const auto row : rows) {
+        WriteValue(request, row);
+      }
+
+      WriteValue(request, static_cast<std::uint64_t>(read_rows.size()));
+
+      for (const auto row : read_rows) {
+        WriteValue(request, row);
+      }
+
+      for (const auto row : read_rows) {
+        WriteRowRecord(row, request);
+      }
+
+      requests.emplace_back(std::move(request).str());
+    }
+
+    auto replies = worker_pool.Exchange(requests);
+    auto replies_merged = replies.has_value();
+
+    for (auto worker_index = 0; replies_merged && (worker_index < num_workers);
+         ++worker_index) {
+      auto reply_stream = std::istringstream{(*replies)[worker_index]};
+      auto statistics = Statistics{};
+      auto num_records = std::uint64_t{};
+
+      replies_merged =
+          ReadValue(reply_stream, statistics.num_expanded_nodes) &&
+          ReadValue(reply_stream, statistics.num_pruned_nodes) &&
+          ReadValue(reply_stream, num_records);
+
+      if (!replies_merged) {
+        break;
+      }
+
+      AddStatistics(statistics);
+      replies_merged = ReadRowRecords(reply_stream, num_records, merged_rows);
+    }
+
+    if (!replies_merged) {
+      find_rest_in_process(wave);
+      return;
+    }
+  }
+}
+
+///
+void Calculator::WriteWorkerSetup(std::ostream &stream) const {
+  WriteValue(stream, min_output_);
+  WriteValue(stream, max_output_);
+  WriteValue(stream, num_clients_);
+  WriteValue(stream, engine_);
+  WriteValue(stream, beam_width_);
+  WriteValue(stream, max_depth_);
+  WriteValue(stream, max_devices_);
+  WriteValue(stream, num_levels_);
+  WriteFamilies(stream, input_nodes_);
+  WriteFamilies(stream, {client_node_});
+  WriteFamilies(stream, family_nodes_);
+  WriteValues(stream, unique_outputs_);
+  WriteValue(stream, cached_num_clients_);
+  WriteValues(stream, cached_rows_);
+  WriteValues(stream, increased_cost_families_);
+  WriteValues(stream, decreased_cost_families_);
+}
+
+///
+auto Calculator::ReadWorkerSetup(std::istream &stream) -> bool {
+  auto client_nodes = std::vector<TreeNode>{};
+
+  if (!ReadValue(stream, min_output_) || !ReadValue(stream, max_output_) ||
+      !ReadValue(stream, num_clients_) || !ReadValue(stream, engine_) ||
+      !ReadValue(stream, beam_width_) || !ReadValue(stream, max_depth_) ||
+      !ReadValue(stream, max_devices_) || !ReadValue(stream, num_levels_) ||
+      !ReadFamilies(stream, input_nodes_) ||
+      !ReadFamilies(stream, client_nodes) ||
+      !ReadFamilies(stream, family_nodes_) ||
+      !ReadValues(stream, unique_outputs_) ||
+      !ReadValue(stream, cached_num_clients_) ||
+      !ReadValues(stream, cached_rows_) ||
+      !ReadValues(stream, increased_cost_families_) ||
+      !ReadValues(stream, decreased_cost_families_)) {
+    return false;
+  }
+
+  const auto num_output_rows =
+      static_cast<std::int64_t>(unique_outputs_.size()) * num_levels_;
+
+  if ((client_nodes.size() != 1) || (num_clients_ < 0) ||
+      (num_levels_ <= 0) ||
+      !std::is_sorted(unique_outputs_.cbegin(), unique_outputs_.cend()) ||
+      (static_cast<std::int64_t>(cached_rows_.size()) != num_output_rows)) {
+    return false;
+  }
+
+  client_node_ = std::move(client_nodes.front());
+  root_family_.outputs.resize(input_nodes_.size());
+  num_layouts_ = 1;
+
+  // vh: Progress and stop are handled by the process which made the worker.
+  step_callback_ = [](const auto &) { return StepStatus::kContinueToNextStep; };
+
+  best_trees_ = BestTreesTable{
+      unique_outputs_, num_levels_,
+      kFirstInputExtraRow + static_cast<int>(input_nodes_.size()),
+      num_clients_, {}};
+  min_costs_per_client_.assign(best_trees_.GetNumRows(), std::nullopt);
+  changed_rows_.assign(best_trees_.GetNumOutputRows(), true);
+  return true;
+}
+
+///
+auto Calculator::SetUpWorkers(WorkerPool &worker_pool) const -> bool {
+  auto setup = std::ostringstream{};
+  WriteWorkerSetup(setup);
+
+  const auto replies = worker_pool.Exchange(
+      std::vector<std::string>(worker_pool.GetSize(), std::move(setup).str()));
+
+  if (!replies.has_value()) {
+    return false;
+  }
+
+  // vh: Worker replies with the number of its rows, which must be the same
+  // as here for the rows to mean the same outputs.
+  return std::all_of(replies->cbegin(), replies->cend(),
+                     [this](const auto &reply) {
+                       auto reply_stream = std::istringstream{reply};
+                       auto num_output_rows = int{};
+
+                       return ReadValue(reply_stream, num_output_rows) &&
+                              (num_output_rows ==
+                               best_trees_.GetNumOutputRows());
+                     });
+}
+
+///
+auto Calculator::FindReadRows(std::span<const RowIndex> rows) const
+    -> std::vector<RowIndex> {
+  auto read_rows = std::vector<RowIndex>{};
+  auto child_rows = std::vector<RowIndex>{};
+
+  // vh: Cached rows keep their trees, which are updated in place.
+  for (const auto row : rows) {
+    if (cached_rows_[row]) {
+      read_rows.emplace_back(row);
+    }
+
+    for (auto family_index = kClientFamily + 1;
+         family_index <= static_cast<FamilyIndex>(family_nodes_.size());
+         ++family_index) {
+      FindChildRows(row, family_index, child_rows);
+      std::copy_if(child_rows.cbegin(), child_rows.cend(),
+                   std::back_inserter(read_rows),
+                   [](const auto child_row) { return child_row != kNoRow; });
+    }
+  }
+
+  std::sort(read_rows.begin(), read_rows.end());
+  read_rows.erase(std::unique(read_rows.begin(), read_rows.end()),
+                  read_rows.end());
+  return read_rows;
+}
+
+///
+auto Calculator::ReadRows(std::istream &stream,
+                          std::vector<RowIndex> &rows) const -> bool {
+  auto num_rows = std::uint64_t{};
+
+  if (!ReadValue(stream, num_rows) ||
+      (num_rows > static_cast<std::uint64_t>(best_trees_.GetNumOutputRows()))) {
+    return false;
+  }
+
+  rows.resize(num_rows);
+
+  return std::all_of(rows.begin(), rows.end(), [this, &stream](auto &row) {
+    return ReadValue(stream, row) && (row >= 0) &&
+           (row < best_trees_.GetNumOutputRows());
+  });
+}
+
+///
+auto Calculator::ProcessWorkerRequest(const std::string &request)
+    -> std::string {
+  auto request_stream = std::istringstream{request};
+  auto rows = std::vector<RowIndex>{};
+  auto read_rows = std::vector<RowIndex>{};
+
+  if (!ReadRows(request_stream, rows) ||
+      !ReadRows(request_stream, read_rows)) {
+    return {};
+  }
+
+  // vh: Worker keeps only the rows of the request. Cached rows of the range
+  // come with the trees which are updated in place.
+  auto stored_rows = read_rows;
+
+  for (const auto row : rows) {
+    if (!std::binary_search(read_rows.cbegin(), read_rows.cend(), row)) {
+      stored_rows.emplace_back(row);
+    }
+  }
+
+  std::sort(stored_rows.begin(), stored_rows.end());
+
+  if (std::adjacent_find(stored_rows.cbegin(), stored_rows.cend()) !=
+      stored_rows.cend()) {
+    return {};
+  }
+
+  best_trees_ = BestTreesTable{
+      unique_outputs_, num_levels_,
+      kFirstInputExtraRow + static_cast<int>(input_nodes_.size()),
+      num_clients_, stored_rows};
+
+  auto merged_rows = std::vector<bool>(best_trees_.GetNumOutputRows());
+
+  if (!ReadRowRecords(request_stream, read_rows.size(), merged_rows) ||
+      (FindReadRows(rows) != read_rows)) {
+    return {};
+  }
+
+  const auto start_statistics = GetStatistics();
+  auto records = std::ostringstream{};
+
+  for (const auto row : rows) {
+    FindBestTreesForOutput(row);
+    WriteRowRecord(row, records);
+  }
+
+  const auto statistics = GetStatistics();
+  auto reply = std::ostringstream{};
+
+  WriteValue(reply, statistics.num_expanded_nodes -
+                        start_statistics.num_expanded_nodes);
+  WriteValue(reply,
+             statistics.num_pruned_nodes - start_statistics.num_pruned_nodes);
+  WriteValue(reply, static_cast<std::uint64_t>(rows.size()));
+  reply << std::move(records).str();
+
+  return std::move(reply).str();
+}
+
+///
+void Calculator::WriteRowRecord(RowIndex row, std::ostream &stream) const {
+  WriteValue(stream, row);
+  WriteValue(stream, changed_rows_[row]);
+  best_trees_.WriteRowToStream(row, stream);
+}
+
+///
+auto Calculator::ReadRowRecords(std::istream &stream,
+                                std::uint64_t num_records,
+                                std::vector<bool> &merged_rows) -> bool {
+  for (auto record_index = std::uint64_t{0}; record_index < num_records;
+       ++record_index) {
+    auto row = RowIndex{};
+    auto row_changed = std::uint8_t{};
+
+    if (!ReadValue(stream, row) || !ReadValue(stream, row_changed) ||
+        (row < 0) || (row >= best_trees_.GetNumOutputRows()) ||
+        !best_trees_.IsRowStored(row) ||
+        !best_trees_.ReadRowFromStream(row, stream)) {
+      return false;
+    }
+
+    changed_rows_[row] = row_changed;
+    merged_rows[row] = true;
+    UpdateMinCostPerClient(row);
+    UpdateWorkProgress();
+  }
+
+  return true;
+}
+
+///
+void Calculator::FindBestTreesForOutput(RowIndex row) {
+  auto searched_families = SearchedFamilies::kAll;
+  auto cached_costs = std::vector<Cost>{};
+
+  if (cached_rows_[row]) {
+    cached_costs = GetCachedCosts(row);
+    searched_families = ClearOutdatedTrees(row);
+  }
+
+  if (searched_families == SearchedFamilies::kNone) {
+    changed_rows_[row] = false;
+    UpdateMinCostPerClient(row);
+    num_done_work_units_.fetch_add(num_clients_, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto output = best_trees_.GetOutput(row);
+
+  if (IsOutputInRange(output)) {
+    AddTree(row, client_node_.num_clients, kClientFamily,
+            client_node_.tree_cost, {});
+  }
+
+  auto child_rows = std::vector<RowIndex>{};
+
+  for (auto family_index = kClientFamily + 1;
+       family_index <= static_cast<FamilyIndex>(family_nodes_.size());
+       ++family_index) {
+    if ((searched_families == SearchedFamilies::kDecreasedCost) &&
+        !decreased_cost_families_[family_index]) {
+      continue;
+    }
+
+    FindChildRows(row, family_index, child_rows);
+    FindBestTreesForOutput(row, family_index, child_rows);
+  }
+
+  if (cached_rows_[row]) {
+    changed_rows_[row] = (GetCachedCosts(row) != cached_costs);
+  }
+
+  if (beam_width_ > 0) {
+    KeepBeamTrees(row);
+  }
+
+  UpdateMinCostPerClient(row);
+  UpdateWorkProgress();
+}
+
+///
+auto Calculator::GetCachedCosts(RowIndex row) const -> std::vector<Cost> {
+  auto costs = std::vector<Cost>(cached_num_clients_ + 1, kNoTreeCost);
+
+  for (auto num_clients =
+           best_trees_.FindMaxNumClients(row, cached_num_clients_);
+       num_clients > 0;
+       num_clients = best_trees_.FindMaxNumClients(row, num_clients - 1)) {
+    costs[num_clients] = best_trees_.GetCost(row, num_clients);
+  }
+
+  return costs;
+}
+
+///
+auto Calculator::ClearOutdatedTrees(RowIndex row) -> SearchedFamilies {
+  auto child_rows = std::vector<RowIndex>{};
+  auto child_row_changed = false;
+
+  for (auto family_index = kClientFamily + 1;
+       (family_index <= static_cast<FamilyIndex>(family_nodes_.size())) &&
+       !child_row_changed;
+       ++family_index) {
+    FindChildRows(row, family_index, child_rows);
+    child_row_changed = std::any_of(
+        child_rows.cbegin(), child_rows.cend(), [this](const auto child_row) {
+          return (child_row != kNoRow) && changed_rows_[child_row];
+        });
+  }
+
+  // vh: Tree is outdated if its own family got more expensive or if it
+  // takes trees from the outputs which have changed in this run.
+  auto trees_cleared = false;
+
+  for (auto num_clients =
+           best_trees_.FindMaxNumClients(row, cached_num_clients_);
+       num_clients > 0;
+       num_clients = best_trees_.FindMaxNumClients(row, num_clients - 1)) {
+    const auto family_index = best_trees_.GetFamilyIndex(row, num_clients);
+
+    if (family_index == kClientFamily) {
+      continue;
+    }
+
+    // vh: Permutations search the row again from scratch, since the kept
+    // trees would change which trees they find.
+    auto tree_is_outdated =
+        increased_cost_families_[family_index] ||
+        (child_row_changed &&
+         (engine_ != core::CalculatorEngine::kConvolution));
+
+    if (!tree_is_outdated && child_row_changed) {
+      const auto child_num_clients =
+          best_trees_.GetChildNumClients(row, num_clients);
+      FindChildRows(row, family_index, child_rows);
+
+      for (auto output_index = 0;
+           output_index < static_cast<OutputIndex>(child_rows.size());
+           ++output_index) {
+        if ((child_num_clients[output_index] > 0) &&
+            changed_rows_[child_rows[output_index]]) {
+          tree_is_outdated = true;
+          break;
+        }
+      }
+    }
+
+    if (tree_is_outdated) {
+      best_trees_.ClearTree(row, num_clients);
+      trees_cleared = true;
+    }
+  }
+
+  // vh: Other trees are kept and bound the search of the updated ones.
+  if (trees_cleared || child_row_changed ||
+      (num_clients_ > cached_num_clients_)) {
+    return SearchedFamilies::kAll;
+  }
+
+  if (std::any_of(decreased_cost_families_.cbegin(),
+                  decreased_cost_families_.cend(),
+                  [](const auto decreased) { return decreased; })) {
+    return SearchedFamilies::kDecreasedCost;
+  }
+
+  return SearchedFamilies::kNone;
+}
+
+///
+void Calculator::FindBestTreesForOutput(
+    RowIndex row, FamilyIndex family_index,
+    const std::vector<RowIndex> &child_rows) {
+  const auto &family_node = GetFamily(family_index);
+  Expects(child_rows.size() == family_node.outputs.size());
+
+  if (engine_ == core::CalculatorEngine::kConvolution) {
+    if (!IsStopped()) {
+      auto convolution_search = ConvolutionSearch{
+          best_trees_, alternative_trees_.has_value() ? &*alternative_trees_
+                                                      : nullptr};
+      convolution_search.FindBestTrees(row, family_index,
+                                       family_node.node_cost, child_rows);
+      AddStatistics(
+          {.num_expanded_nodes = convolution_search.GetNumExpandedNodes()});
+    }
+
+    return;
+  }
+
+  const auto permutation_kernel =
+      FindPermutationKernel(static_cast<int>(child_rows.size()));
+  (this->*permutation_kernel)(row, family_index, child_rows);
+}
+
+///
+auto Calculator::FindPermutationKernel(int num_outputs) -> PermutationKernel {
+  // vh: Families mostly have 1, 2, 4, 8 or 16 outputs. Their kernels keep
+  // the permutation in arrays of fixed size, and the rest use vectors.
+  static constexpr auto kFixedKernels =
+      std::array{&Calculator::FindBestTreesPermutation<1>,
+                 &Calculator::FindBestTreesPermutation<2>,
+                 &Calculator::FindBestTreesPermutation<4>,
+                 &Calculator::FindBestTreesPermutation<8>,
+                 &Calculator::FindBestTreesPermutation<16>};
+
+  const auto kernel_index =
+      std::countr_zero(static_cast<unsigned>(num_outputs));
+
+  if (std::has_single_bit(static_cast<unsigned>(num_outputs)) &&
+      (kernel_index < static_cast<int>(kFixedKernels.size()))) {
+    return kFixedKernels[kernel_index];
+  }
+
+  return &Calculator::FindBestTreesPermutation<kAnyNumOutputs>;
+}
+
+///
+template <int kNumOutputs>
+void Calculator::FindBestTreesPermutation(
+    RowIndex row, FamilyIndex family_index,
+    const std::vector<RowIndex> &child_rows) {
+  auto search =
+      PermutationSearch<kNumOutputs>{.row = row, .family_index = family_index};
+
+  if constexpr (kNumOutputs == kAnyNumOutputs) {
+    const auto num_outputs = child_rows.size();
+
+    search.child_rows = child_rows;
+    search.symmetric_outputs.resize(num_outputs);
+    search.max_num_clients_left.resize(num_outputs + 1);
+    search.min_costs_per_client_left.resize(num_outputs + 1);
+    search.permutation.resize(num_outputs);
+  } else {
+    Expects(child_rows.size() == kNumOutputs);
+    std::copy(child_rows.cbegin(), child_rows.cend(),
+              search.child_rows.begin());
+  }
+
+  FindSymmetricOutputs(search.child_rows, search.symmetric_outputs);
+  FindPermutationBounds(search);
+  MakeBestTreesPermutation(search, 0);
+  AddStatistics(search.statistics);
+}
+
+///
+template <int kNumOutputs>
+void Calculator::FindPermutationBounds(
+    PermutationSearch<kNumOutputs> &search) const {
+  const auto &child_rows = search.child_rows;
+  const auto num_outputs = static_cast<OutputIndex>(child_rows.size());
+
+  search.max_num_clients_left[num_outputs] = 0;
+  search.min_costs_per_client_left[num_outputs] =
+      std::numeric_limits<double>::infinity();
+
+  for (auto output_index = num_outputs - 1; output_index >= 0;
+       --output_index) {
+    const auto child_row = child_rows[output_index];
+    auto max_num_clients = search.max_num_clients_left[output_index + 1];
+    auto min_cost_per_client =
+        search.min_costs_per_client_left[output_index + 1];
+
+    if (child_row != kNoRow) {
+      // vh: Trees of the rows which are not processed yet can still change,
+      // so such rows only get the weakest bounds.
+      const auto &child_min_cost_per_client = min_costs_per_client_[child_row];
+      const auto child_max_num_clients =
+          child_min_cost_per_client.has_value()
+              ? best_trees_.FindMaxNumClients(child_row, num_clients_)
+              : num_clients_;
+
+      max_num_clients =
+          std::min(num_clients_, max_num_clients + child_max_num_clients);
+      min_cost_per_client = std::min(min_cost_per_client,
+                                     child_min_cost_per_client.value_or(0.0));
+    }
+
+    search.max_num_clients_left[output_index] = max_num_clients;
+    search.min_costs_per_client_left[output_index] = min_cost_per_client;
+  }
+}
+
+///
+template <int kNumOutputs>
+auto Calculator::IsPermutationBounded(
+    const PermutationSearch<kNumOutputs> &search, OutputIndex output_index,
+    NumClients permutation_num_clients, Cost permutation_tree_cost) const {
+  const auto max_num_clients =
+      std::min(num_clients_, permutation_num_clients +
+                                 search.max_num_clients_left[output_index]);
+  const auto min_cost_per_client =
+      search.min_costs_per_client_left[output_index];
+
+  // vh: Every client added by the remaining outputs costs at least the
+  // cheapest cost per client among them, so if no completion can beat the
+  // existing trees, the whole subtree of the search is skipped.
+  for (auto num_clients = std::max(permutation_num_clients, 1);
+       num_clients <= max_num_clients; ++num_clients) {
+    const auto prune_cost = GetPruneCost(search.row, num_clients);
+
+    if (prune_cost == kNoPruneCost) {
+      return false;
+    }
+
+    const auto num_added_clients = num_clients - permutation_num_clients;
+    const auto min_tree_cost =
+        (num_added_clients > 0)
+            ? (permutation_tree_cost + num_added_clients * min_cost_per_client)
+            : permutation_tree_cost;
+
+    if (min_tree_cost < prune_cost) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+///
+template <int kNumOutputs>
+auto Calculator::TestBestTreesPermutation(
+    PermutationSearch<kNumOutputs> &search, OutputIndex output_index) {
+  const auto &family_node = GetFamily(search.family_index);
+  const auto &child_rows = search.child_rows;
+  const auto &permutation = search.permutation;
+
+  auto permutation_num_clients = 0;
+  auto permutation_tree_cost = family_node.node_cost;
+
+  for (auto child_index = 0;
+       child_index < static_cast<OutputIndex>(permutation.size());
+       ++child_index) {
+    const auto child_num_clients = permutation[child_index];
+
+    if (child_num_clients <= 0) {
+      continue;
+    }
+
+    permutation_num_clients += child_num_clients;
+    permutation_tree_cost +=
+        best_trees_.GetCost(child_rows[child_index], child_num_clients);
+  }
+
+  if (permutation_num_clients > num_clients_) {
+    return false;
+  }
+
+  if (permutation_tree_cost >
+      GetPruneCost(search.row, permutation_num_clients)) {
+    ++search.statistics.num_pruned_nodes;
+    return false;
+  }
+
+  if (const auto permutation_is_ready =
+          output_index >= static_cast<OutputIndex>(child_rows.size())) {
+    if (permutation_num_clients <= 0) {
+      return false;
+    }
+
+    AddTree(search.row, permutation_num_clients, search.family_index,
+            permutation_tree_cost, permutation);
+    return false;
+  }
+
+  if (IsPermutationBounded(search, output_index, permutation_num_clients,
+                           permutation_tree_cost)) {
+    ++search.statistics.num_pruned_nodes;
+    return false;
+  }
+
+  return true;
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+template <int kNumOutputs>
+void Calculator::MakeBestTreesPermutation(
+    PermutationSearch<kNumOutputs> &search, OutputIndex output_index) {
+  if (IsStopped(search)) {
+    return;
+  }
+
+  if (!TestBestTreesPermutation(search, output_index)) {
+    return;
+  }
+
+  ++search.statistics.num_expanded_nodes;
+
+  const auto next_ouput_index = output_index + 1;
+
+  Expects(output_index >= 0);
+  const auto child_row = search.child_rows[output_index];
+  auto &permutation = search.permutation;
+
+  if (child_row != kNoRow) {
+    // vh: Output which is symmetric to the previous one only takes trees with
+    // the same or less clients, so each multiset of trees is tried once.
+    const auto symmetric_output = search.symmetric_outputs[output_index];
+    const auto max_num_clients = (symmetric_output == kNoOutput)
+                                     ? num_clients_
+                                     : permutation[symmetric_output];
+
+    for (auto child_num_clients =
+             best_trees_.FindMaxNumClients(child_row, max_num_clients);
+         child_num_clients > 0;
+         child_num_clients = best_trees_.FindMaxNumClients(
+             child_row, child_num_clients - 1)) {
+      permutation[output_index] = child_num_clients;
+      MakeBestTreesPermutation(search, next_ouput_index);
+    }
+  }
+
+  permutation[output_index] = 0;
+  MakeBestTreesPermutation(search, next_ouput_index);
+}
+
+///
+void Calculator::AddTree(RowIndex row, NumClients num_clients,
+                         FamilyIndex family_index, Cost cost,
+                         std::span<const NumClients> child_num_clients) {
+  if (!best_trees_.HasTree(row, num_clients) ||
+      (cost < best_trees_.GetCost(row, num_clients))) {
+    best_trees_.SetTree(row, num_clients, family_index, cost,
+                        child_num_clients);
+  }
+
+  if (alternative_trees_.has_value()) {
+    alternative_trees_->AddTree(row, num_clients, family_index, cost,
+                                child_num_clients);
+  }
+}
+
+///
+void Calculator::KeepBeamTrees(RowIndex row) {
+  auto trees = std::vector<std::pair<double, NumClients>>{};
+
+  for (auto num_clients = best_trees_.FindMaxNumClients(row, num_clients_);
+       num_clients > 0;
+       num_clients = best_trees_.FindMaxNumClients(row, num_clients - 1)) {
+    trees.emplace_back(
+        static_cast<double>(best_trees_.GetCost(row, num_clients)) /
+            num_clients,
+        num_clients);
+  }
+
+  // vh: Trees with the most and the fewest clients are kept in addition to
+  // the cheapest ones per client, so the parents could still get close to
+  // any number of clients.
+  const auto num_kept_trees = beam_width_ + 2;
+
+  if (static_cast<int>(trees.size()) <= num_kept_trees) {
+    return;
+  }
+
+  std::swap(trees.front(), trees[trees.size() - 2]);
+  std::nth_element(trees.begin(), trees.begin() + beam_width_,
+                   trees.end() - 2);
+
+  for (auto tree = trees.cbegin() + beam_width_; tree != trees.cend() - 2;
+       ++tree) {
+    best_trees_.ClearTree(row, tree->second);
+  }
+
+  best_trees_.CompactRow(row);
+}
+
+///
+void Calculator::UpdateMinCostPerClient(RowIndex row) {
+  auto min_cost_per_client = std::numeric_limits<double>::infinity();
+
+  for (auto num_clients = best_trees_.FindMaxNumClients(row, num_clients_);
+       num_clients > 0;
+       num_clients = best_trees_.FindMaxNumClients(row, num_clients - 1)) {
+    min_cost_per_client =
+        std::min(min_cost_per_client,
+                 static_cast<double>(best_trees_.GetCost(row, num_clients)) /
+                     num_clients);
+  }
+
+  min_costs_per_client_[row] = min_cost_per_client;
+}
+
+///
+auto Calculator::GetNumDoneStates() const -> std::int64_t {
+  return num_expanded_nodes_.load(std::memory_order_relaxed) +
+         num_pruned_nodes_.load(std::memory_order_relaxed);
+}
+
+///
+void Calculator::UpdateWorkProgress() {
+  num_done_work_units_.fetch_add(num_clients_, std::memory_order_relaxed);
+
+  const auto num_done_states = GetNumDoneStates();
+  const auto num_row_states =
+      num_done_states - num_states_at_last_row_.exchange(
+                            num_done_states, std::memory_order_relaxed);
+
+  // vh: Higher outputs have more trees to combine, so the states left are
+  // estimated from the latest outputs rather than from all of them.
+  const auto num_states_per_work_unit =
+      static_cast<double>(num_row_states) / num_clients_;
+  const auto prev_num_states_per_work_unit =
+      num_states_per_work_unit_.load(std::memory_order_relaxed);
+
+  num_states_per_work_unit_.store(
+      prev_num_states_per_work_unit +
+          kProgressSmoothing *
+              (num_states_per_work_unit - prev_num_states_per_work_unit),
+      std::memory_order_relaxed);
+}
+
+///
+void Calculator::AddStatistics(const Statistics &statistics) {
+  num_expanded_nodes_.fetch_add(statistics.num_expanded_nodes,
+                                std::memory_order_relaxed);
+  num_pruned_nodes_.fetch_add(statistics.num_pruned_nodes,
+                              std::memory_order_relaxed);
+}
+
+///
+void Calculator::FindSymmetricOutputs(
+    std::span<const RowIndex> child_rows,
+    std::span<OutputIndex> symmetric_outputs) {
+  Expects(symmetric_outputs.size() == child_rows.size());
+
+  for (auto output_index = 0;
+       output_index < static_cast<OutputIndex>(child_rows.size());
+       ++output_index) {
+    symmetric_outputs[output_index] = kNoOutput;
+
+    for (auto previous_index = output_index - 1; previous_index >= 0;
+         --previous_index) {
+      if (child_rows[previous_index] == child_rows[output_index]) {
+        symmetric_outputs[output_index] = previous_index;
+        break;
+      }
+    }
+  }
+}
+
+///
+void Calculator::FindBestRootTree() {
+  if (FindCachedRootTree()) {
+    return;
+  }
+
+  auto child_rows = std::vector<RowIndex>{};
+  const auto first_input_family =
+      kClientFamily + 1 + static_cast<FamilyIndex>(family_nodes_.size());
+
+  for (auto input_index = 0;
+       input_index < static_cast<int>(input_nodes_.size()); ++input_index) {
+    const auto input_row =
+        best_trees_.GetExtraRow(kFirstInputExtraRow + input_index);
+    const auto input_family = first_input_family + input_index;
+
+    FindChildRows(input_row, input_family, child_rows);
+    FindBestTreesForOutput(input_row, input_family, child_rows);
+    UpdateMinCostPerClient(input_row);
+  }
+
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+  const auto root_family =
+      first_input_family + static_cast<FamilyIndex>(input_nodes_.size());
+
+  FindChildRows(root_row, root_family, child_rows);
+  FindBestTreesForOutput(root_row, root_family, child_rows);
+}
+
+///
+auto Calculator::FindCachedRootTree() -> bool {
+  // vh: Root and input trees are made of the output rows and the inputs, so
+  // they are the same if none of them has changed.
+  if (!cached_entry_.has_value() || (cached_num_clients_ != num_clients_) ||
+      (cached_entry_->inputs_key != MakeInputsKey()) ||
+      std::any_of(changed_rows_.cbegin(), changed_rows_.cend(),
+                  [](const auto changed) { return changed != 0; })) {
+    return false;
+  }
+
+  const auto &cached_best_trees = *cached_entry_->best_trees;
+
+  if (cached_best_trees.GetNumRows() != best_trees_.GetNumRows()) {
+    return false;
+  }
+
+  // vh: Input and root families follow the others, so only their indices
+  // are kept.
+  auto family_indices = cached_family_indices_;
+  const auto root_family =
+      kClientFamily + 1 +
+      static_cast<FamilyIndex>(family_nodes_.size() + input_nodes_.size());
+
+  for (auto family_index = static_cast<FamilyIndex>(family_indices.size());
+       family_index <= root_family; ++family_index) {
+    family_indices.emplace_back(family_index);
+  }
+
+  for (auto extra_row_index = kRootExtraRow;
+       extra_row_index <
+       kFirstInputExtraRow + static_cast<int>(input_nodes_.size());
+       ++extra_row_index) {
+    const auto row = best_trees_.GetExtraRow(extra_row_index);
+    best_trees_.CopyRow(cached_best_trees,
+                        cached_best_trees.GetExtraRow(extra_row_index), row,
+                        family_indices);
+
+    if (extra_row_index >= kFirstInputExtraRow) {
+      UpdateMinCostPerClient(row);
+    }
+  }
+
+  return true;
+}
+
+///
+auto Calculator::FindLowerBoundCost(NumClients num_clients) const -> Cost {
+  // vh: Bound of a row is a convex function of its clients, which is kept as
+  // the cost of each next client. Bounds of the children are then combined by
+  // taking their cheapest clients first.
+  auto row_client_costs = std::vector<std::vector<double>>(
+      best_trees_.GetNumRows());
+  auto row_costs = std::vector<double>{};
+  auto child_rows = std::vector<RowIndex>{};
+  auto next_clients = std::vector<std::pair<double, std::pair<int, int>>>{};
+
+  const auto add_family_costs = [this, &row_client_costs, &row_costs,
+                                 &child_rows, &next_clients](
+                                    const auto row, const auto family_index) {
+    FindChildRows(row, family_index, child_rows);
+    next_clients.clear();
+
+    for (auto output_index = 0;
+         output_index < static_cast<int>(child_rows.size()); ++output_index) {
+      const auto child_row = child_rows[output_index];
+
+      if ((child_row != kNoRow) && !row_client_costs[child_row].empty()) {
+        next_clients.emplace_back(row_client_costs[child_row].front(),
+                                  std::pair{output_index, 0});
+      }
+    }
+
+    std::make_heap(next_clients.begin(), next_clients.end(), std::greater{});
+    auto family_cost = static_cast<double>(GetFamily(family_index).node_cost);
+
+    for (auto family_num_clients = 1;
+         (family_num_clients <= num_clients_) && !next_clients.empty();
+         ++family_num_clients) {
+      std::pop_heap(next_clients.begin(), next_clients.end(), std::greater{});
+      const auto [client_cost, client_index] = next_clients.back();
+      next_clients.pop_back();
+
+      family_cost += client_cost;
+      row_costs[family_num_clients] =
+          std::min(row_costs[family_num_clients], family_cost);
+
+      const auto [output_index, child_client] = client_index;
+      const auto &child_client_costs =
+          row_client_costs[child_rows[output_index]];
+
+      if (child_client + 1 < static_cast<int>(child_client_costs.size())) {
+        next_clients.emplace_back(child_client_costs[child_client + 1],
+                                  std::pair{output_index, child_client + 1});
+        std::push_heap(next_clients.begin(), next_clients.end(),
+                       std::greater{});
+      }
+    }
+  };
+
+  // vh: Lower convex hull of the row costs is never above them and keeps the
+  // cost of each next client from going down.
+  const auto find_client_costs = [&row_costs](auto &client_costs) {
+    auto hull = std::vector<int>{0};
+
+    for (auto point = 1; point < static_cast<int>(row_costs.size()); ++point) {
+      if (row_costs[point] == std::numeric_limits<double>::infinity()) {
+        continue;
+      }
+
+      while (hull.size() > 1) {
+        const auto first = hull[hull.size() - 2];
+        const auto second = hull.back();
+
+        if ((row_costs[second] - row_costs[first]) * (point - first) <
+            (row_costs[point] - row_costs[first]) * (second - first)) {
+          break;
+        }
+
+        hull.pop_back();
+      }
+
+      hull.emplace_back(point);
+    }
+
+    client_costs.clear();
+
+    for (auto hull_index = 1; hull_index < static_cast<int>(hull.size());
+         ++hull_index) {
+      const auto first = hull[hull_index - 1];
+      const auto second = hull[hull_index];
+
+      client_costs.insert(
+          client_costs.cend(), second - first,
+          (row_costs[second] - row_costs[first]) / (second - first));
+    }
+  };
+
+  const auto reset_row_costs = [this, &row_costs]() {
+    row_costs.assign(num_clients_ + 1, std::numeric_limits<double>::infinity());
+    row_costs[0] = 0;
+  };
+
+  for (auto row = 0; row < best_trees_.GetNumOutputRows(); ++row) {
+    reset_row_costs();
+
+    if (IsOutputInRange(best_trees_.GetOutput(row)) &&
+        (client_node_.num_clients <= num_clients_)) {
+      row_costs[client_node_.num_clients] = client_node_.tree_cost;
+    }
+
+    for (auto family_index = kClientFamily + 1;
+         family_index <= static_cast<FamilyIndex>(family_nodes_.size());
+         ++family_index) {
+      add_family_costs(row, family_index);
+    }
+
+    find_client_costs(row_client_costs[row]);
+  }
+
+  const auto first_input_family =
+      kClientFamily + 1 + static_cast<FamilyIndex>(family_nodes_.size());
+
+  for (auto input_index = 0;
+       input_index < static_cast<int>(input_nodes_.size()); ++input_index) {
+    const auto input_row =
+        best_trees_.GetExtraRow(kFirstInputExtraRow + input_index);
+
+    reset_row_costs();
+    add_family_costs(input_row, first_input_family + input_index);
+    find_client_costs(row_client_costs[input_row]);
+  }
+
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+
+  reset_row_costs();
+  add_family_costs(root_row, first_input_family +
+                                 static_cast<FamilyIndex>(input_nodes_.size()));
+  find_client_costs(row_client_costs[root_row]);
+
+  const auto &root_client_costs = row_client_costs[root_row];
+
+  if (static_cast<int>(root_client_costs.size()) < num_clients) {
+    return 0;
+  }
+
+  return static_cast<Cost>(std::floor(
+      std::accumulate(root_client_costs.cbegin(),
+                      root_client_costs.cbegin() + num_clients, 0.0)));
+}
+
+///
+auto Calculator::GetFamily(FamilyIndex family_index) const
+    -> const TreeNode & {
+  if (family_index == kClientFamily) {
+    return client_node_;
+  }
+
+  auto index = family_index - (kClientFamily + 1);
+
+  if (index < static_cast<int>(family_nodes_.size())) {
+    return family_nodes_[index];
+  }
+
+  index -= static_cast<int>(family_nodes_.size());
+
+  if (index < static_cast<int>(input_nodes_.size())) {
+    return input_nodes_[index];
+  }
+
+  Expects(index == static_cast<int>(input_nodes_.size()));
+  return root_family_;
+}
+
+///
+auto Calculator::FindChildLevel(RowIndex row, FamilyIndex family_index) const
+    -> int {
+  // vh: Paths start at the inputs with all the splitters and devices left.
+  if (row >= best_trees_.GetNumOutputRows()) {
+    return num_levels_ - 1;
+  }
+
+  // vh: Level of the row is the number of splitters and devices which are
+  // still allowed on the paths from its node to the clients. Families which
+  // exceed it get no child rows, so their trees are never searched.
+  const auto num_device_levels = GetNumLimitLevels(max_devices_);
+  const auto level = best_trees_.GetLevel(row);
+
+  auto depth_left = level / num_device_levels;
+  auto devices_left = level % num_device_levels;
+
+  if ((max_depth_ > 0) && (GetFamily(family_index).outputs.size() > 1)) {
+    --depth_left;
+  }
+
+  if (max_devices_ > 0) {
+    --devices_left;
+  }
+
+  if ((depth_left < 0) || (devices_left < 0)) {
+    return kNoLevel;
+  }
+
+  return depth_left * num_device_levels + devices_left;
+}
+
+///
+void Calculator::FindChildRows(RowIndex row, FamilyIndex family_index,
+                               std::vector<RowIndex> &child_rows) const {
+  child_rows.clear();
+
+  if (row == best_trees_.GetExtraRow(kRootExtraRow)) {
+    for (auto input_index = 0;
+         input_index < static_cast<int>(input_nodes_.size()); ++input_index) {
+      child_rows.emplace_back(
+          best_trees_.GetExtraRow(kFirstInputExtraRow + input_index));
+    }
+
+    return;
+  }
+
+  // vh: Outputs of the input nodes are absolute flow values.
+  const auto output =
+      (row < best_trees_.GetNumOutputRows()) ? best_trees_.GetOutput(row) : 0;
+  const auto child_level = FindChildLevel(row, family_index);
+
+  for (const auto family_output : GetFamily(family_index).outputs) {
+    const auto child_row = best_trees_.FindOutputRow(output + family_output);
+
+    child_rows.emplace_back((child_row.has_value() && (child_level != kNoLevel))
+                                ? best_trees_.GetLevelRow(*child_row,
+                                                          child_level)
+                                : kNoRow);
+  }
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+auto Calculator::MakeTree(RowIndex row, NumClients num_clients) const
+    -> TreeNode {
+  const auto family_index = best_trees_.GetFamilyIndex(row, num_clients);
+
+  auto tree = GetFamily(family_index);
+  tree.tree_cost = best_trees_.GetCost(row, num_clients);
+  tree.num_clients = num_clients;
+
+  const auto child_num_clients =
+      best_trees_.GetChildNumClients(row, num_clients);
+
+  if (child_num_clients.empty()) {
+    return tree;
+  }
+
+  auto child_rows = std::vector<RowIndex>{};
+  FindChildRows(row, family_index, child_rows);
+
+  for (auto output_index = 0;
+       output_index < static_cast<OutputIndex>(child_num_clients.size());
+       ++output_index) {
+    const auto output_num_clients = child_num_clients[output_index];
+
+    if (output_num_clients <= 0) {
+      continue;
+    }
+
+    tree.child_nodes.emplace(
+        output_index, MakeTree(child_rows[output_index], output_num_clients));
+  }
+
+  return tree;
+}
+
+///
+auto Calculator::MakeResult() const -> std::vector<TreeNode> {
+  const auto root_row = best_trees_.GetExtraRow(kRootExtraRow);
+  return MakeCostCurveResult(
+      best_trees_.FindMaxNumClients(root_row, num_clients_));
+}
+
+///
+void Calculator::ReportBestResult() const {
+  if (auto result = MakeResult(); IsResultInRange(result)) {
+    best_result_callback_(std::move(result));
+  }
+}
+
+///
+void Calculator::FitResultToOutputRange() {
+  const auto find_num_result_clients = [this]() {
+    return best_trees_.FindMaxNumClients(
+        best_trees_.GetExtraRow(kRootExtraRow), num_clients_);
+  };
+
+  const auto coarse_num_clients = find_num_result_clients();
+
+  // vh: Search on a coarse grid could put clients above the max output. It
+  // is repeated with the max output lowered by the excess, and if that loses
+  // clients or doesn't help, on the exact grid.
+  for (auto num_tries = 0; snapped_flow_step_ > 1; ++num_tries) {
+    if (IsStopped()) {
+      return;
+    }
+
+    const auto result = MakeResult();
+    const auto keeps_clients = find_num_result_clients() >= coarse_num_clients;
+
+    if (keeps_clients && IsResultInRange(result)) {
+      return;
+    }
+
+    const auto client_outputs = FindClientOutputs(result);
+    const auto excess = client_outputs.has_value()
+                            ? (client_outputs->second - requested_max_output_)
+                            : 0;
+
+    if (keeps_clients && (excess > 0) &&
+        (num_tries < kMaxNumOutputRangeTries) &&
+        (max_output_ - excess >= min_output_)) {
+      max_output_ -= excess;
+      UseFlowStep(snapped_flow_step_);
+    } else {
+      max_output_ = requested_max_output_;
+      UseFlowStep(1);
+    }
+
+    // vh: Cached trees are only valid for the requested range.
+    cached_entry_.reset();
+    best_trees_cache_.reset();
+
+    num_work_units_ += static_cast<std::int64_t>(unique_outputs_.size()) *
+                       num_levels_ * num_clients_;
+    FindBestTrees();
+  }
+}
+
+///
+auto Calculator::IsResultInRange(const std::vector<TreeNode> &trees) const
+    -> bool {
+  if (snapped_flow_step_ <= 1) {
+    return true;
+  }
+
+  const auto client_outputs = FindClientOutputs(trees);
+  return !client_outputs.has_value() ||
+         ((client_outputs->first >= min_output_) &&
+          (client_outputs->second <= requested_max_output_));
+}
+
+///
+auto Calculator::FindClientOutputs(const std::vector<TreeNode> &trees) const
+    -> std::optional<std::pair<FlowValue, FlowValue>> {
+  Expects(trees.size() == exact_input_nodes_.size());
+
+  auto client_outputs = std::optional<std::pair<FlowValue, FlowValue>>{};
+
+  // vh: Flows are summed from the exact outputs, since the result could be
+  // found on a coarse grid.
+  for (auto input_index = 0; input_index < static_cast<int>(trees.size());
+       ++input_index) {
+    FindClientOutputs(trees[input_index],
+                      exact_input_nodes_[input_index].outputs, 0,
+                      client_outputs);
+  }
+
+  return client_outputs;
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+void Calculator::FindClientOutputs(
+    const TreeNode &tree, const std::vector<FlowValue> &outputs,
+    FlowValue flow,
+    std::optional<std::pair<FlowValue, FlowValue>> &client_outputs) const {
+  for (const auto &[output_index, child_tree] : tree.child_nodes) {
+    Expects((output_index >= 0) &&
+            (output_index < static_cast<OutputIndex>(outputs.size())));
+    const auto child_flow = flow + outputs[output_index];
+
+    if (child_tree.child_nodes.empty()) {
+      client_outputs =
+          client_outputs.has_value()
+              ? std::pair{std::min(client_outputs->first, child_flow),
+                          std::max(client_outputs->second, child_flow)}
+              : std::pair{child_flow, child_flow};
+      continue;
+    }
+
+    const auto family_node = std::find_if(
+        exact_family_nodes_.cbegin(), exact_family_nodes_.cend(),
+        [family_id = child_tree.family_id](const auto &family_node) {
+          return family_node.family_id == family_id;
+        });
+
+    Expects(family_node != exact_family_nodes_.cend());
+    FindClientOutputs(child_tree, family_node->outputs, child_flow,
+                      client_outputs);
+  }
+}
+
+///
+auto Calculator::InitLayoutCell(LayoutSearch &search, RowIndex row,
+                                NumClients num_clients) const -> LayoutCell & {
+  const auto [cell_iter, cell_added] =
+      search.try_emplace(std::pair{row, num_clients});
+  auto &cell = cell_iter->second;
+
+  if (!cell_added) {
+    return cell;
+  }
+
+  Expects(alternative_trees_.has_value());
+  cell.trees = alternative_trees_->GetSortedTrees(row, num_clients);
+
+  for (auto tree_index = 0; tree_index < static_cast<int>(cell.trees.size());
+       ++tree_index) {
+    auto &child_rows = cell.child_rows.emplace_back();
+    FindChildRows(row, cell.trees[tree_index].family_index, child_rows);
+
+    AddLayoutCandidate(
+        search, cell, tree_index,
+        std::vector<int>(cell.trees[tree_index].child_num_clients.size()));
+  }
+
+  return cell;
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+void Calculator::AddLayoutCandidate(LayoutSearch &search, LayoutCell &cell,
+                                    int tree_index,
+                                    std::vector<int> child_ranks) const {
+  const auto &tree = cell.trees[tree_index];
+  const auto &child_rows = cell.child_rows[tree_index];
+
+  // vh: Children on the same row with the same number of clients could be
+  // swapped, so their ranks don't increase to keep the layouts distinct.
+  for (auto output_index = 0;
+       output_index < static_cast<OutputIndex>(child_ranks.size());
+       ++output_index) {
+    for (auto previous_index = output_index - 1; previous_index >= 0;
+         --previous_index) {
+      if ((child_rows[previous_index] == child_rows[output_index]) &&
+          (tree.child_num_clients[previous_index] ==
+           tree.child_num_clients[output_index])) {
+        if (child_ranks[output_index] > child_ranks[previous_index]) {
+          return;
+        }
+
+        break;
+      }
+    }
+  }
+
+  if (!cell.tried_candidates.emplace(tree_index, child_ranks).second) {
+    return;
+  }
+
+  auto cost = GetFamily(tree.family_index).node_cost;
+
+  for (auto output_index = 0;
+       output_index < static_cast<OutputIndex>(child_ranks.size());
+       ++output_index) {
+    const auto child_num_clients = tree.child_num_clients[output_index];
+
+    if (child_num_clients <= 0) {
+      continue;
+    }
+
+    const auto *child_derivation =
+        FindLayoutDerivation(search, child_rows[output_index],
+                             child_num_clients, child_ranks[output_index]);
+
+    if (child_derivation == nullptr) {
+      return;
+    }
+
+    cost += child_derivation->cost;
+  }
+
+  cell.candidates.emplace_back(LayoutDerivation{
+      .cost = cost, .tree_index = tree_index, .child_ranks = child_ranks});
+  std::push_heap(cell.candidates.begin(), cell.candidates.end(),
+                 [](const auto &left, const auto &right) {
+                   return left.cost > right.cost;
+                 });
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+auto Calculator::FindLayoutDerivation(LayoutSearch &search, RowIndex row,
+                                      NumClients num_clients, int rank) const
+    -> const LayoutDerivation * {
+  auto &cell = InitLayoutCell(search, row, num_clients);
+
+  // vh: Derivations are found lazily in the order of cost. Every next one
+  // differs from the found one by a single child which takes its next rank.
+  while ((static_cast<int>(cell.derivations.size()) <= rank) &&
+         !cell.candidates.empty()) {
+    std::pop_heap(cell.candidates.begin(), cell.candidates.end(),
+                  [](const auto &left, const auto &right) {
+                    return left.cost > right.cost;
+                  });
+
+    const auto &derivation =
+        cell.derivations.emplace_back(std::move(cell.candidates.back()));
+    cell.candidates.pop_back();
+
+    const auto tree_index = derivation.tree_index;
+    const auto child_ranks = derivation.child_ranks;
+
+    for (auto output_index = 0;
+         output_index < static_cast<OutputIndex>(child_ranks.size());
+         ++output_index) {
+      if (cell.trees[tree_index].child_num_clients[output_index] <= 0) {
+        continue;
+      }
+
+      auto next_child_ranks = child_ranks;
+      ++next_child_ranks[output_index];
+
+      AddLayoutCandidate(search, cell, tree_index, std::move(next_child_ranks));
+    }
+  }
+
+  if (static_cast<int>(cell.derivations.size()) <= rank) {
+    return nullptr;
+  }
+
+  return &cell.derivations[rank];
+}
+
+///
+// NOLINTNEXTLINE(*-no-recursion)
+auto Calculator::MakeLayoutTree(LayoutSearch &search, RowIndex row,
+                                NumClients num_clients, int rank) const
+    -> TreeNode {
+  const auto *found_derivation =
+      FindLayoutDerivation(search, row, num_clients, rank);
+  Expects(found_derivation != nullptr);
+
+  const auto derivation = *found_derivation;
+  const auto &cell = search.at(std::pair{row, num_clients});
+  const auto &alternative_tree = cell.trees[derivation.tree_index];
+  const auto child_rows = cell.child_rows[derivation.tree_index];
+
+  auto tree = GetFamily(alternative_tree.family_index);
+  tree.tree_cost = derivation.cost;
+  tree.num_clients = num_clients;
+
+  const auto child_num_clients = alternative_tree.child_num_clients;
+
+  for (auto output_index = 0;
+       output_index < static_cast<OutputIndex>(child_num_clients.size());
+       ++output_index) {
+    const auto output_num_clients = child_num_clients[output_index];
+
+    if (output_num_clients <= 0) {
+      continue;
+    }
 
-    FindBestTreesForOutput(next_node_input, input_node_family);
-    --next_node_input;
+    tree.child_nodes.emplace(
+        output_index,
+        MakeLayoutTree(search, child_rows[output_index], output_num_clients,
+                       derivation.child_ranks[output_index]));
   }
 
-  FindBestTreesForOutput(kRootInput, root_family);
+  return tree;
 }
-}  // namespace vh::ponc::calc
\ No newline at end of file
+}  // namespace vh::ponc::calc
@@ -0,0 +1,137 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_convolution_search.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+namespace {
+///
+constexpr auto kNoTreeCost = std::numeric_limits<Cost>::max();
+}  // namespace
+
+///
+ConvolutionSearch::ConvolutionSearch(BestTreesTable &best_trees,
+                                     AlternativeTrees *alternative_trees)
+    : best_trees_{&best_trees},
+      alternative_trees_{alternative_trees},
+      max_num_clients_{best_trees.GetMaxNumClients()},
+      costs_(max_num_clients_ + 1),
+      next_costs_(max_num_clients_ + 1) {}
+
+///
+void ConvolutionSearch::FindBestTrees(RowIndex row, FamilyIndex family_index,
+                                      Cost node_cost,
+                                      const std::vector<RowIndex> &child_rows) {
+  const auto num_outputs = static_cast<int>(child_rows.size());
+
+  std::fill(costs_.begin(), costs_.end(), kNoTreeCost);
+  costs_[0] = node_cost;
+  choices_.assign(static_cast<size_t>(num_outputs) * (max_num_clients_ + 1), 0);
+
+  // vh: Each output is combined with the best partial trees of the previous
+  // outputs, which is a (min, +) convolution over the number of clients.
+  for (auto output_index = 0; output_index < num_outputs; ++output_index) {
+    FoldOutput(child_rows[output_index], output_index);
+  }
+
+  UpdateBestTrees(row, family_index, num_outputs);
+}
+
+///
+auto ConvolutionSearch::GetNumExpandedNodes() const -> std::int64_t {
+  return num_expanded_nodes_;
+}
+
+///
+void ConvolutionSearch::FoldOutput(RowIndex child_row,
+                                   OutputIndex output_index) {
+  std::copy(costs_.cbegin(), costs_.cend(), next_costs_.begin());
+
+  if (child_row < 0) {
+    return;
+  }
+
+  auto *output_choices = &choices_[static_cast<size_t>(output_index) *
+                                   (max_num_clients_ + 1)];
+
+  for (auto num_clients = 0; num_clients < max_num_clients_; ++num_clients) {
+    const auto partial_cost = costs_[num_clients];
+
+    if (partial_cost == kNoTreeCost) {
+      continue;
+    }
+
+    for (auto child_num_clients = best_trees_->FindMaxNumClients(
+             child_row, max_num_clients_ - num_clients);
+         child_num_clients > 0;
+         child_num_clients = best_trees_->FindMaxNumClients(
+             child_row, child_num_clients - 1)) {
+      const auto cost =
+          partial_cost + best_trees_->GetCost(child_row, child_num_clients);
+      const auto total_num_clients = num_clients + child_num_clients;
+      ++num_expanded_nodes_;
+
+      if (cost < next_costs_[total_num_clients]) {
+        next_costs_[total_num_clients] = cost;
+        output_choices[total_num_clients] = child_num_clients;
+      }
+    }
+  }
+
+  costs_.swap(next_costs_);
+}
+
+///
+void ConvolutionSearch::UpdateBestTrees(RowIndex row, FamilyIndex family_index,
+                                        int num_outputs) {
+  child_num_clients_.resize(num_outputs);
+
+  for (auto num_clients = 1; num_clients <= max_num_clients_; ++num_clients) {
+    const auto cost = costs_[num_clients];
+
+    if (cost == kNoTreeCost) {
+      continue;
+    }
+
+    const auto tree_is_best = !best_trees_->HasTree(row, num_clients) ||
+                              (cost < best_trees_->GetCost(row, num_clients));
+
+    // vh: Alternative layouts take the best tree of every family.
+    if (!tree_is_best && (alternative_trees_ == nullptr)) {
+      continue;
+    }
+
+    auto remaining_num_clients = num_clients;
+
+    for (auto output_index = num_outputs - 1; output_index >= 0;
+         --output_index) {
+      const auto output_num_clients =
+          choices_[static_cast<size_t>(output_index) * (max_num_clients_ + 1) +
+                   remaining_num_clients];
+
+      child_num_clients_[output_index] = output_num_clients;
+      remaining_num_clients -= output_num_clients;
+    }
+
+    Expects(remaining_num_clients == 0);
+
+    if (alternative_trees_ != nullptr) {
+      alternative_trees_->AddTree(row, num_clients, family_index, cost,
+                                  child_num_clients_);
+    }
+
+    if (tree_is_best) {
+      best_trees_->SetTree(row, num_clients, family_index, cost,
+                           child_num_clients_);
+    }
+  }
+}
+}  // namespace vh::ponc::calc
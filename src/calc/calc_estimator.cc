@@ -0,0 +1,208 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_estimator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "calc_reachable_outputs.h"
+#include "calc_resolution.h"
+#include "calc_thread_pool.h"
+#include "calc_worker_pool.h"
+
+namespace vh::ponc::calc {
+namespace {
+///
+struct StatesModel {
+  ///
+  double factor{};
+  ///
+  double clients_power{};
+  ///
+  double beam_factor{};
+  ///
+  double beam_width_power{};
+  ///
+  double beam_clients_power{};
+  ///
+  double seconds_per_state{};
+};
+
+// vh: Models are fitted to the states and the time of the runs with
+// 64 to 1000 clients and all families, so they only give the order of the
+// numbers on other machines.
+///
+constexpr auto kConvolutionModel = StatesModel{.factor = 0.49,
+                                               .clients_power = 1.6,
+                                               .beam_factor = 0.32,
+                                               .beam_width_power = 1,
+                                               .beam_clients_power = 0.75,
+                                               .seconds_per_state = 10e-9};
+///
+constexpr auto kPermutationsModel = StatesModel{.factor = 0.0174,
+                                                .clients_power = 1.53,
+                                                .beam_factor = 0.044,
+                                                .beam_width_power = 0.5,
+                                                .beam_clients_power = 0.75,
+                                                .seconds_per_state = 20e-9};
+///
+constexpr auto kSecondsPerCellOutput = 4e-9;
+///
+constexpr auto kNumExtraBeamTrees = 2;
+///
+constexpr auto kBytesPerCell = 3 * sizeof(int);
+///
+constexpr auto kBytesPerChild = sizeof(NumClients);
+///
+constexpr auto kBytesPerMegabyte = std::int64_t{1024} * 1024;
+///
+constexpr auto kBeamWidths = std::array{64, 32, 16, 8, 4, 2};
+}  // namespace
+
+///
+Estimator::Estimator(const Calculator::ConstructorArgs &args)
+    : settings_{args.settings},
+      num_families_{static_cast<int>(args.family_nodes.size())} {
+  const auto flow_step = ToCalculatorFlowStep(settings_.flow_resolution);
+  const auto min_output = ToCalculatorResolution(settings_.min_output);
+  auto reachable_outputs_args =
+      ReachableOutputs::ConstructorArgs{.min_output = min_output};
+
+  for (const auto &input_node : args.input_nodes) {
+    for (const auto output : input_node.outputs) {
+      reachable_outputs_args.start_outputs.emplace_back(
+          SnapToFlowStep(output, flow_step));
+    }
+  }
+
+  for (const auto &family_node : args.family_nodes) {
+    for (const auto output : family_node.outputs) {
+      reachable_outputs_args.family_outputs.emplace_back(
+          SnapToFlowStep(output, flow_step));
+    }
+
+    num_family_outputs_ += static_cast<int>(family_node.outputs.size());
+  }
+
+  auto reachable_outputs = ReachableOutputs{reachable_outputs_args};
+  reachable_outputs.RemoveOutputsNotLeadingTo(
+      min_output, ToCalculatorResolution(settings_.max_output));
+
+  // vh: Outputs are repeated on every level of the limited paths. Extra rows
+  // hold the root tree and the trees of every input node.
+  num_outputs_ = static_cast<int>(reachable_outputs.GetSortedOutputs().size()) *
+                     Calculator::GetNumPathLevels(settings_) +
+                 1 + static_cast<int>(args.input_nodes.size());
+}
+
+///
+auto Estimator::EstimateCalculation(core::CalculatorEngine engine,
+                                    int beam_width) const -> Estimate {
+  const auto &model = (engine == core::CalculatorEngine::kConvolution)
+                          ? kConvolutionModel
+                          : kPermutationsModel;
+  const auto num_clients = static_cast<double>(settings_.num_clients);
+  const auto num_cells = static_cast<double>(num_outputs_) * (num_clients + 1);
+  const auto num_cell_outputs = num_cells * num_family_outputs_;
+
+  // vh: Every output of a family is combined with the trees of its child.
+  // Their number grows slower than the clients, since most of the
+  // combinations are not reachable or are pruned. Beam keeps only a few.
+  auto num_states = model.factor * num_outputs_ * num_family_outputs_ *
+                    std::pow(num_clients, model.clients_power);
+  auto num_kept_cells = num_cells;
+
+  if (beam_width > 0) {
+    const auto num_beam_trees =
+        static_cast<double>(beam_width + kNumExtraBeamTrees);
+
+    num_states = std::min(
+        num_states, model.beam_factor * num_outputs_ * num_family_outputs_ *
+                        std::pow(num_beam_trees, model.beam_width_power) *
+                        std::pow(num_clients, model.beam_clients_power));
+    num_kept_cells = std::min(num_cells, num_outputs_ * num_beam_trees);
+  }
+
+  const auto mean_num_children =
+      (num_families_ > 0)
+          ? static_cast<double>(num_family_outputs_) / num_families_
+          : 0.0;
+  // vh: Every worker process takes the place of a thread. It keeps only the
+  // rows of its range of a wave and the rows they read, which are about as
+  // many as the children of its rows.
+  const auto num_workers = (settings_.num_layouts > 1)
+                               ? 0
+                               : WorkerPool::GetNumWorkers(
+                                     settings_.num_processes);
+  const auto worker_table_part =
+      (num_workers > 0)
+          ? std::min((mean_num_children + 1) / num_workers, 1.0)
+          : 0.0;
+  const auto memory_size =
+      (num_cells * kBytesPerCell +
+       num_kept_cells * (mean_num_children + 1) * kBytesPerChild) *
+      (1 + num_workers * worker_table_part);
+
+  const auto num_threads =
+      (num_workers > 0) ? num_workers
+                        : ThreadPool::GetNumThreads(settings_.num_threads);
+  const auto duration = (num_states * model.seconds_per_state +
+                         num_cell_outputs * kSecondsPerCellOutput) /
+                        num_threads;
+
+  return {.engine = engine,
+          .beam_width = beam_width,
+          .num_outputs = num_outputs_,
+          .num_states = static_cast<std::int64_t>(num_states),
+          .memory_size = static_cast<std::int64_t>(memory_size),
+          .duration = static_cast<float>(duration)};
+}
+
+///
+auto Estimator::ChooseCalculation() const -> Estimate {
+  if (settings_.engine != core::CalculatorEngine::kAuto) {
+    return EstimateCalculation(settings_.engine, settings_.beam_width);
+  }
+
+  // vh: Exact engine goes first, then the faster one which could miss the
+  // best trees, then narrower and narrower beams.
+  for (const auto engine : {core::CalculatorEngine::kConvolution,
+                            core::CalculatorEngine::kPermutations}) {
+    if (const auto estimate = EstimateCalculation(engine, settings_.beam_width);
+        IsInBudget(estimate)) {
+      return estimate;
+    }
+  }
+
+  for (const auto beam_width : kBeamWidths) {
+    if ((settings_.beam_width > 0) && (beam_width >= settings_.beam_width)) {
+      continue;
+    }
+
+    if (const auto estimate = EstimateCalculation(
+            core::CalculatorEngine::kConvolution, beam_width);
+        IsInBudget(estimate)) {
+      return estimate;
+    }
+  }
+
+  return EstimateCalculation(core::CalculatorEngine::kConvolution,
+                             kBeamWidths.back());
+}
+
+///
+auto Estimator::IsInBudget(const Estimate &estimate) const -> bool {
+  return ((settings_.time_budget <= 0) ||
+          (estimate.duration <= settings_.time_budget)) &&
+         ((settings_.memory_budget <= 0) ||
+          (estimate.memory_size <=
+           settings_.memory_budget * kBytesPerMegabyte));
+}
+}  // namespace vh::ponc::calc
@@ -0,0 +1,131 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_reachable_outputs.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace vh::ponc::calc {
+///
+ReachableOutputs::ReachableOutputs(const ConstructorArgs &args)
+    : min_output_{args.min_output} {
+  if (args.start_outputs.empty()) {
+    return;
+  }
+
+  const auto [min_start_output, max_start_output] = std::minmax_element(
+      args.start_outputs.cbegin(), args.start_outputs.cend());
+
+  // vh: Start outputs are kept even if they are below the min output.
+  min_output_ = std::min(min_output_, *min_start_output);
+  outputs_.resize(*max_start_output - min_output_ + 1);
+
+  // vh: Only the drops of flow lead to new outputs. Outputs which keep or
+  // increase the flow would never let the search end.
+  for (const auto family_output : args.family_outputs) {
+    if (family_output < 0) {
+      family_outputs_.emplace_back(family_output);
+    }
+  }
+
+  std::sort(family_outputs_.begin(), family_outputs_.end(), std::greater{});
+  family_outputs_.erase(
+      std::unique(family_outputs_.begin(), family_outputs_.end()),
+      family_outputs_.end());
+
+  for (const auto output : args.start_outputs) {
+    outputs_[output - min_output_] = true;
+  }
+
+  const auto min_offset = args.min_output - min_output_;
+
+  // vh: Every output only leads to lower ones, so a single sweep from the
+  // highest output visits each of them after all its parents.
+  for (auto offset = GetNumOffsets() - 1; offset >= min_offset; --offset) {
+    if (!outputs_[offset]) {
+      continue;
+    }
+
+    for (const auto family_output : family_outputs_) {
+      const auto child_offset = offset + family_output;
+
+      if (child_offset < min_offset) {
+        break;
+      }
+
+      outputs_[child_offset] = true;
+    }
+  }
+}
+
+///
+auto ReachableOutputs::Contains(FlowValue output) const -> bool {
+  const auto offset = output - min_output_;
+  return (offset >= 0) && (offset < GetNumOffsets()) && outputs_[offset];
+}
+
+///
+auto ReachableOutputs::RemoveOutputsNotLeadingTo(FlowValue min_output,
+                                                 FlowValue max_output)
+    -> int {
+  auto leading_outputs = std::vector<bool>(outputs_.size());
+  auto num_removed_outputs = 0;
+
+  // vh: Children are lower than their parents, so they are already checked
+  // when the sweep from the lowest output gets to the parent.
+  for (auto offset = 0; offset < GetNumOffsets(); ++offset) {
+    if (!outputs_[offset]) {
+      continue;
+    }
+
+    const auto output = min_output_ + offset;
+    auto output_is_leading = (output >= min_output) && (output <= max_output);
+
+    for (const auto family_output : family_outputs_) {
+      if (output_is_leading) {
+        break;
+      }
+
+      const auto child_offset = offset + family_output;
+
+      if (child_offset < 0) {
+        break;
+      }
+
+      output_is_leading = leading_outputs[child_offset];
+    }
+
+    if (output_is_leading) {
+      leading_outputs[offset] = true;
+    } else {
+      ++num_removed_outputs;
+    }
+  }
+
+  outputs_ = std::move(leading_outputs);
+  return num_removed_outputs;
+}
+
+///
+auto ReachableOutputs::GetSortedOutputs() const -> std::vector<FlowValue> {
+  auto sorted_outputs = std::vector<FlowValue>{};
+
+  for (auto offset = 0; offset < GetNumOffsets(); ++offset) {
+    if (outputs_[offset]) {
+      sorted_outputs.emplace_back(min_output_ + offset);
+    }
+  }
+
+  return sorted_outputs;
+}
+
+///
+auto ReachableOutputs::GetNumOffsets() const -> int {
+  return static_cast<int>(outputs_.size());
+}
+}  // namespace vh::ponc::calc
@@ -7,6 +7,7 @@
 #include "calc_resolution.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 
 namespace vh::ponc::calc {
@@ -38,4 +39,17 @@ auto ToCalculatorResolution(const std::vector<float> &values)
 auto FromCalculatorResolution(int value) -> float {
   return static_cast<float>(value) / kResolution;
 }
+
+///
+auto ToCalculatorFlowStep(float flow_resolution) -> int {
+  return std::max(1, static_cast<int>(std::lround(flow_resolution *
+                                                  kResolution)));
+}
+
+///
+auto SnapToFlowStep(int value, int flow_step) -> int {
+  // vh: Values are rounded down, so negative ones move away from zero.
+  const auto remainder = ((value % flow_step) + flow_step) % flow_step;
+  return value - remainder;
+}
 }  // namespace vh::ponc::calc
\ No newline at end of file
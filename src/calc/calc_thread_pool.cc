@@ -0,0 +1,161 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+///
+ThreadPool::ThreadPool(int num_threads) {
+  Expects(num_threads > 0);
+
+  queues_.reserve(num_threads);
+
+  for (auto queue_index = 0; queue_index < num_threads; ++queue_index) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
+  workers_.reserve(num_threads - 1);
+
+  // vh: Queue 0 belongs to the thread which calls RunAndWait.
+  for (auto queue_index = 1; queue_index < num_threads; ++queue_index) {
+    workers_.emplace_back(
+        [this, queue_index](const std::stop_token &stop_token) {
+          Work(stop_token, queue_index);
+        });
+  }
+}
+
+///
+ThreadPool::~ThreadPool() {
+  for (auto &worker : workers_) {
+    worker.request_stop();
+  }
+}
+
+///
+auto ThreadPool::GetNumThreads(int requested_num_threads) -> int {
+  if (requested_num_threads > 0) {
+    return requested_num_threads;
+  }
+
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+///
+auto ThreadPool::GetSize() const -> int {
+  return static_cast<int>(queues_.size());
+}
+
+///
+void ThreadPool::RunAndWait(std::vector<Task> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  num_pending_tasks_ = static_cast<int>(tasks.size());
+
+  for (auto task_index = 0; task_index < static_cast<int>(tasks.size());
+       ++task_index) {
+    auto &queue = *queues_[task_index % queues_.size()];
+    const auto lock = std::lock_guard{queue.mutex};
+    queue.tasks.emplace_back(std::move(tasks[task_index]));
+  }
+
+  {
+    const auto lock = std::lock_guard{mutex_};
+    ++batch_index_;
+  }
+
+  tasks_added_.notify_all();
+
+  while (RunNextTask(0)) {
+  }
+
+  auto lock = std::unique_lock{mutex_};
+  tasks_finished_.wait(lock, [this]() { return num_pending_tasks_ == 0; });
+}
+
+///
+void ThreadPool::Work(const std::stop_token &stop_token, int queue_index) {
+  while (!stop_token.stop_requested()) {
+    auto seen_batch_index = std::uint64_t{};
+
+    {
+      const auto lock = std::lock_guard{mutex_};
+      seen_batch_index = batch_index_;
+    }
+
+    while (RunNextTask(queue_index)) {
+    }
+
+    auto lock = std::unique_lock{mutex_};
+    tasks_added_.wait(lock, stop_token, [this, seen_batch_index]() {
+      return batch_index_ != seen_batch_index;
+    });
+  }
+}
+
+///
+auto ThreadPool::PopTask(int queue_index) -> std::optional<Task> {
+  auto &queue = *queues_[queue_index];
+  const auto lock = std::lock_guard{queue.mutex};
+
+  if (queue.tasks.empty()) {
+    return std::nullopt;
+  }
+
+  auto task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return task;
+}
+
+///
+auto ThreadPool::StealTask(int queue_index) -> std::optional<Task> {
+  const auto num_queues = static_cast<int>(queues_.size());
+
+  for (auto offset = 1; offset < num_queues; ++offset) {
+    auto &queue = *queues_[(queue_index + offset) % num_queues];
+    const auto lock = std::lock_guard{queue.mutex};
+
+    if (queue.tasks.empty()) {
+      continue;
+    }
+
+    auto task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return task;
+  }
+
+  return std::nullopt;
+}
+
+///
+auto ThreadPool::RunNextTask(int queue_index) -> bool {
+  auto task = PopTask(queue_index);
+
+  if (!task.has_value()) {
+    task = StealTask(queue_index);
+  }
+
+  if (!task.has_value()) {
+    return false;
+  }
+
+  (*task)();
+
+  if (--num_pending_tasks_ == 0) {
+    const auto lock = std::lock_guard{mutex_};
+    tasks_finished_.notify_all();
+  }
+
+  return true;
+}
+}  // namespace vh::ponc::calc
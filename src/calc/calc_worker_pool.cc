@@ -0,0 +1,310 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "calc_worker_pool.h"
+
+#ifdef __linux__
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <system_error>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <limits>
+#include <utility>
+
+#include "cpp_assert.h"
+
+namespace vh::ponc::calc {
+#ifdef __linux__
+namespace {
+///
+constexpr auto kMaxMessageSize =
+    std::uint64_t{std::numeric_limits<int>::max()};
+///
+constexpr auto kMaxReceiveChunkSize = std::uint64_t{1} << 16;
+
+///
+auto SendAll(int socket, const char *data, std::size_t size) {
+  while (size > 0) {
+    // vh: Worker could be gone, which must not kill the sending process.
+    const auto num_sent = send(socket, data, size, MSG_NOSIGNAL);
+
+    if (num_sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return false;
+    }
+
+    data += num_sent;
+    size -= static_cast<std::size_t>(num_sent);
+  }
+
+  return true;
+}
+
+///
+auto ReceiveAll(int socket, char *data, std::size_t size) {
+  while (size > 0) {
+    const auto num_received = recv(socket, data, size, 0);
+
+    if (num_received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      return false;
+    }
+
+    if (num_received == 0) {
+      return false;
+    }
+
+    data += num_received;
+    size -= static_cast<std::size_t>(num_received);
+  }
+
+  return true;
+}
+
+///
+auto SendMessage(int socket, const std::string &message) {
+  // vh: Every message is prefixed with its size.
+  const auto size = static_cast<std::uint64_t>(message.size());
+
+  if (size > kMaxMessageSize) {
+    return false;
+  }
+
+  return SendAll(socket, reinterpret_cast<const char *>(&size), sizeof(size)) &&
+         SendAll(socket, message.data(), message.size());
+}
+
+///
+auto ReceiveMessage(int socket) -> std::optional<std::string> {
+  auto size = std::uint64_t{};
+
+  // vh: Size comes from the other process, which could be broken. Messages
+  // are at most as big as the best trees table, whose cells are limited the
+  // same way.
+  if (!ReceiveAll(socket, reinterpret_cast<char *>(&size), sizeof(size)) ||
+      (size > kMaxMessageSize)) {
+    return std::nullopt;
+  }
+
+  auto message = std::string{};
+
+  // vh: Message is received in chunks, so a peer which is cut off fails
+  // before it takes much memory.
+  while (message.size() < size) {
+    const auto offset = message.size();
+    const auto chunk_size = std::min(size - offset, kMaxReceiveChunkSize);
+
+    message.resize(offset + chunk_size);
+
+    if (!ReceiveAll(socket, message.data() + offset, chunk_size)) {
+      return std::nullopt;
+    }
+  }
+
+  return message;
+}
+
+///
+auto FindWorkerExecutable() -> std::string {
+  // vh: Workers are run by the command line tool, which is installed next to
+  // the other executables.
+  auto error = std::error_code{};
+  const auto executable =
+      std::filesystem::read_symlink("/proc/self/exe", error);
+
+  if (error) {
+    return {};
+  }
+
+  const auto worker_executable =
+      executable.parent_path() / WorkerPool::kWorkerExecutable;
+
+  if (!std::filesystem::is_regular_file(worker_executable, error)) {
+    return {};
+  }
+
+  return worker_executable.string();
+}
+
+///
+auto SpawnWorker(const std::string &executable, int socket)
+    -> std::optional<pid_t> {
+  // vh: Worker is a new process of its own rather than a copy of this one,
+  // which could have other threads in the middle of anything. Socket of the
+  // worker becomes its standard input, the rest are closed on exec.
+  auto file_actions = posix_spawn_file_actions_t{};
+
+  if (posix_spawn_file_actions_init(&file_actions) != 0) {
+    return std::nullopt;
+  }
+
+  auto option = std::string{WorkerPool::kWorkerOption};
+  auto arguments = std::array<char *, 3>{
+      const_cast<char *>(executable.c_str()), option.data(), nullptr};
+  auto process_id = pid_t{};
+
+  const auto spawned =
+      (posix_spawn_file_actions_adddup2(&file_actions, socket,
+                                        STDIN_FILENO) == 0) &&
+      (posix_spawn(&process_id, executable.c_str(), &file_actions, nullptr,
+                   arguments.data(), environ) == 0);
+
+  posix_spawn_file_actions_destroy(&file_actions);
+
+  if (!spawned) {
+    return std::nullopt;
+  }
+
+  return process_id;
+}
+}  // namespace
+
+///
+WorkerPool::WorkerPool(int num_workers) {
+  Expects(num_workers > 0);
+
+  const auto executable = FindWorkerExecutable();
+
+  if (executable.empty()) {
+    return;
+  }
+
+  workers_.reserve(num_workers);
+
+  for (auto worker_index = 0; worker_index < num_workers; ++worker_index) {
+    auto sockets = std::array<int, 2>{};
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) !=
+        0) {
+      break;
+    }
+
+    const auto process_id = SpawnWorker(executable, sockets[1]);
+    close(sockets[1]);
+
+    if (!process_id.has_value()) {
+      close(sockets[0]);
+      break;
+    }
+
+    workers_.emplace_back(
+        Worker{.process_id = *process_id, .socket = sockets[0]});
+  }
+}
+
+///
+WorkerPool::~WorkerPool() {
+  // vh: Workers could be in the middle of a long request if the work was
+  // stopped, so they are not waited for.
+  for (const auto &worker : workers_) {
+    close(worker.socket);
+    kill(worker.process_id, SIGKILL);
+  }
+
+  for (const auto &worker : workers_) {
+    while ((waitpid(worker.process_id, nullptr, 0) < 0) && (errno == EINTR)) {
+    }
+  }
+}
+
+///
+auto WorkerPool::GetNumWorkers(int requested_num_workers) -> int {
+  return std::max(requested_num_workers, 0);
+}
+
+///
+auto WorkerPool::RunWorker(const Handler &handler) -> int {
+  // vh: Closed socket means there is no more work.
+  try {
+    while (const auto request = ReceiveMessage(STDIN_FILENO)) {
+      if (!SendMessage(STDIN_FILENO, handler(*request))) {
+        return EXIT_FAILURE;
+      }
+    }
+  } catch (const std::exception &) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+///
+auto WorkerPool::Exchange(const std::vector<std::string> &requests)
+    -> std::optional<std::vector<std::string>> {
+  Expects(requests.size() == workers_.size());
+
+  // vh: Workers read the whole request before they reply, so all of them get
+  // their requests first and work at the same time.
+  for (auto worker_index = 0; worker_index < GetSize(); ++worker_index) {
+    if (!SendMessage(workers_[worker_index].socket, requests[worker_index])) {
+      return std::nullopt;
+    }
+  }
+
+  auto replies = std::vector<std::string>{};
+  replies.reserve(workers_.size());
+
+  for (const auto &worker : workers_) {
+    auto reply = ReceiveMessage(worker.socket);
+
+    if (!reply.has_value()) {
+      return std::nullopt;
+    }
+
+    replies.emplace_back(std::move(*reply));
+  }
+
+  return replies;
+}
+#else
+///
+WorkerPool::WorkerPool(int num_workers) { Expects(num_workers > 0); }
+
+///
+WorkerPool::~WorkerPool() = default;
+
+///
+auto WorkerPool::GetNumWorkers(int /*unused*/) -> int {
+  // vh: Workers are only made on Linux.
+  return 0;
+}
+
+///
+auto WorkerPool::RunWorker(const Handler & /*unused*/) -> int {
+  return EXIT_FAILURE;
+}
+
+///
+auto WorkerPool::Exchange(const std::vector<std::string> & /*unused*/)
+    -> std::optional<std::vector<std::string>> {
+  return std::nullopt;
+}
+#endif
+
+///
+auto WorkerPool::GetSize() const -> int {
+  return static_cast<int>(workers_.size());
+}
+}  // namespace vh::ponc::calc
@@ -0,0 +1,472 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "cli_app.h"
+
+#include <crude_json.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "app_family_groups.h"
+#include "calc_batch_task.h"
+#include "calc_resolution.h"
+#include "core_diagram.h"
+#include "core_i_family.h"
+#include "core_i_node.h"
+#include "core_link.h"
+#include "coreui_calculator_mapper.h"
+#include "coreui_cloner.h"
+#include "cpp_assert.h"
+#include "daemon_task.h"
+#include "flow_algorithms.h"
+#include "flow_node_flow.h"
+#include "json_project_serializer.h"
+#include "json_versifier.h"
+
+namespace vh::ponc::cli {
+namespace {
+///
+constexpr auto kProgressInterval = std::chrono::milliseconds{500};
+///
+constexpr auto kBytesPerMegabyte = 1024 * 1024;
+///
+constexpr auto kReportIndent = 2;
+
+///
+auto EvaluateFlow(const core::Diagram &diagram, const core::Project &project) {
+  const auto flow_trees = flow::BuildFlowTrees(diagram);
+  const auto node_flows = flow::CalculateNodeFlows(
+      flow_trees,
+      [&diagram](const auto node_id) {
+        return core::Diagram::FindNode(diagram, node_id).GetInitialFlow();
+      },
+      [&diagram, &project](const auto pin_id) {
+        const auto link = core::Diagram::FindPinLink(diagram, pin_id);
+        Expects(link.has_value());
+        return core::Link::GetDrop(**link, project);
+      });
+
+  const auto &settings = project.GetSettings().calculator_settings;
+  auto num_clients = 0;
+  auto num_unconnected_clients = 0;
+  auto num_out_of_range_clients = 0;
+  auto client_flows = std::vector<float>{};
+
+  for (const auto &node : diagram.GetNodes()) {
+    const auto &family =
+        core::Project::FindFamily(project, node->GetFamilyId());
+
+    if (family.GetType() != core::FamilyType::kClient) {
+      continue;
+    }
+
+    ++num_clients;
+
+    const auto &input_pin = node->GetInputPinId();
+
+    if (!input_pin.has_value() ||
+        !core::Diagram::HasLink(diagram, *input_pin)) {
+      ++num_unconnected_clients;
+      continue;
+    }
+
+    const auto node_flow = node_flows.find(node->GetId().Get());
+    Expects(node_flow != node_flows.cend());
+    Expects(node_flow->second.input_pin_flow.has_value());
+
+    const auto client_flow = node_flow->second.input_pin_flow->second;
+    client_flows.emplace_back(client_flow);
+
+    if ((client_flow < settings.min_output) ||
+        (client_flow > settings.max_output)) {
+      ++num_out_of_range_clients;
+    }
+  }
+
+  auto flow_json = crude_json::value{};
+  flow_json["clients"] = static_cast<crude_json::number>(num_clients);
+  flow_json["unconnected_clients"] =
+      static_cast<crude_json::number>(num_unconnected_clients);
+  flow_json["out_of_range_clients"] =
+      static_cast<crude_json::number>(num_out_of_range_clients);
+
+  if (!client_flows.empty()) {
+    const auto [min_flow, max_flow] =
+        std::minmax_element(client_flows.cbegin(), client_flows.cend());
+
+    flow_json["min_client_flow"] = static_cast<crude_json::number>(*min_flow);
+    flow_json["max_client_flow"] = static_cast<crude_json::number>(*max_flow);
+  }
+
+  return flow_json;
+}
+
+///
+void PrintEstimate(const calc::Estimator::Estimate &estimate) {
+  std::cerr << "Estimated " << estimate.num_states << " states, "
+            << (estimate.memory_size / kBytesPerMegabyte) << " MB and "
+            << static_cast<int>(std::ceil(estimate.duration)) << " s for "
+            << estimate.num_outputs << " outputs.\n";
+}
+
+///
+void WaitForResults(const calc::BatchTask &batch_task) {
+  while (batch_task.IsRunning()) {
+    std::this_thread::sleep_for(kProgressInterval);
+    std::cerr << "\rCalculating: "
+              << static_cast<int>(batch_task.GetProgress() * 100) << "%"
+              << std::flush;
+  }
+
+  std::cerr << "\rCalculating: 100%\n";
+}
+
+///
+void WaitForResults(const daemon::Task &daemon_task) {
+  auto queued = false;
+
+  while (daemon_task.IsRunning()) {
+    std::this_thread::sleep_for(kProgressInterval);
+
+    if (const auto num_jobs_ahead = daemon_task.GetNumJobsAhead()) {
+      std::cerr << "\rQueued: " << *num_jobs_ahead << " jobs ahead"
+                << std::flush;
+      queued = true;
+      continue;
+    }
+
+    if (queued) {
+      std::cerr << "\n";
+      queued = false;
+    }
+
+    std::cerr << "\rCalculating: "
+              << static_cast<int>(daemon_task.GetProgress() * 100) << "%"
+              << std::flush;
+  }
+
+  std::cerr << "\rCalculating: 100%\n";
+}
+}  // namespace
+
+///
+App::App(Options options)
+    : options_{std::move(options)},
+      best_trees_cache_{std::make_shared<calc::BestTreesCache>()} {}
+
+///
+auto App::Run() -> int {
+  if (!ReadProject()) {
+    return EXIT_FAILURE;
+  }
+
+  const auto diagram_indices = FindDiagramIndices();
+
+  if (!diagram_indices.has_value()) {
+    return EXIT_FAILURE;
+  }
+
+  const auto &diagrams = project_->GetDiagrams();
+  auto diagram_reports = std::vector<crude_json::value>{};
+  diagram_reports.reserve(diagram_indices->size());
+
+  for (const auto diagram_index : *diagram_indices) {
+    auto &diagram_report = diagram_reports.emplace_back();
+    diagram_report["name"] = diagrams[diagram_index].GetName();
+  }
+
+  auto result_indices =
+      std::vector<std::optional<int>>(diagram_indices->size());
+
+  if (options_.calculate) {
+    auto calculated_indices =
+        CalculateDiagrams(*diagram_indices, diagram_reports);
+
+    if (!calculated_indices.has_value()) {
+      return EXIT_FAILURE;
+    }
+
+    result_indices = std::move(*calculated_indices);
+  }
+
+  if (options_.evaluate_flow) {
+    for (auto index = 0; index < static_cast<int>(diagram_indices->size());
+         ++index) {
+      auto &diagram_report = diagram_reports[index];
+      diagram_report["flow"] =
+          EvaluateFlow(diagrams[(*diagram_indices)[index]], *project_);
+
+      if (const auto result_index = result_indices[index]) {
+        diagram_report["calculation"]["flow"] =
+            EvaluateFlow(diagrams[*result_index], *project_);
+      }
+    }
+  }
+
+  if (!options_.output_file.empty() && !WriteProject()) {
+    return EXIT_FAILURE;
+  }
+
+  auto report = crude_json::value{};
+  report["diagrams"] = crude_json::array{
+      std::move_iterator{diagram_reports.begin()},
+      std::move_iterator{diagram_reports.end()}};
+
+  return WriteReport(report) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+///
+auto App::ReadProject() -> bool {
+  auto [json, loaded] =
+      crude_json::value::load(options_.project_file.string());
+
+  if (!loaded) {
+    std::cerr << "Couldn't read project from " << options_.project_file.string()
+              << "\n";
+    return false;
+  }
+
+  json::Versifier::UpgradeToCurrentVersion(json);
+  project_.emplace(
+      json::ProjectSerializer::ParseFromJson(json, CreateFamilyParsers()));
+
+  if (const auto cache_file_path = GetCacheFilePath();
+      !cache_file_path.empty() && std::filesystem::exists(cache_file_path)) {
+    best_trees_cache_->ReadFromFile(cache_file_path);
+  }
+
+  return true;
+}
+
+///
+auto App::FindDiagramIndices() const -> std::optional<std::vector<int>> {
+  const auto &diagrams = project_->GetDiagrams();
+  auto diagram_indices = std::vector<int>{};
+
+  if (options_.diagram_names.empty()) {
+    diagram_indices.resize(diagrams.size());
+    std::iota(diagram_indices.begin(), diagram_indices.end(), 0);
+    return diagram_indices;
+  }
+
+  for (const auto &diagram_name : options_.diagram_names) {
+    const auto diagram =
+        std::find_if(diagrams.cbegin(), diagrams.cend(),
+                     [&diagram_name](const auto &diagram) {
+                       return diagram.GetName() == diagram_name;
+                     });
+
+    if (diagram == diagrams.cend()) {
+      std::cerr << "Project has no diagram " << diagram_name << "\n";
+      return std::nullopt;
+    }
+
+    diagram_indices.emplace_back(
+        static_cast<int>(std::distance(diagrams.cbegin(), diagram)));
+  }
+
+  return diagram_indices;
+}
+
+///
+auto App::CalculateDiagrams(const std::vector<int> &diagram_indices,
+                            std::vector<crude_json::value> &diagram_reports)
+    -> std::optional<std::vector<std::optional<int>>> {
+  auto &project = *project_;
+  const auto &settings = project.GetSettings().calculator_settings;
+
+  if (settings.min_output > settings.max_output) {
+    std::cerr << "Min Output should be <= Max Output.\n";
+    return std::nullopt;
+  }
+
+  auto batch_args = calc::BatchTask::ConstructorArgs{
+      .calculator_args = coreui::CalculatorMapper::MakeCalculatorArgs(project)};
+  batch_args.calculator_args.best_trees_cache = best_trees_cache_;
+
+  auto calculated_indices = std::vector<int>{};
+  auto calculated_diagram_indices = std::vector<int>{};
+
+  for (auto index = 0; index < static_cast<int>(diagram_indices.size());
+       ++index) {
+    auto input_nodes = coreui::CalculatorMapper::GetInputNodes(
+        project.GetDiagrams()[diagram_indices[index]], project, {});
+
+    if (input_nodes.empty()) {
+      diagram_reports[index]["calculation"]["error"] =
+          "Diagram should have free outputs.";
+      continue;
+    }
+
+    batch_args.diagram_input_nodes.emplace_back(std::move(input_nodes));
+    calculated_indices.emplace_back(index);
+    calculated_diagram_indices.emplace_back(diagram_indices[index]);
+  }
+
+  auto result_indices = std::vector<std::optional<int>>(diagram_indices.size());
+
+  if (calculated_indices.empty()) {
+    return result_indices;
+  }
+
+  const auto results =
+      options_.daemon_socket.empty()
+          ? std::optional{CalculateLocally(std::move(batch_args))}
+          : CalculateOnDaemon(calculated_diagram_indices);
+
+  if (!results.has_value()) {
+    return std::nullopt;
+  }
+
+  Expects(results->size() == calculated_indices.size());
+
+  for (auto result_index = 0;
+       result_index < static_cast<int>(calculated_indices.size());
+       ++result_index) {
+    const auto index = calculated_indices[result_index];
+    const auto &calculated_trees = (*results)[result_index];
+
+    auto &calculation_report = diagram_reports[index]["calculation"];
+    calculation_report["clients"] = static_cast<crude_json::number>(
+        std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
+                        [](const auto num_clients, const auto &tree) {
+                          return num_clients + tree.num_clients;
+                        }));
+    calculation_report["cost"] =
+        static_cast<crude_json::number>(calc::FromCalculatorResolution(
+            std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(),
+                            0, [](const auto total_cost, const auto &tree) {
+                              return total_cost + tree.tree_cost;
+                            })));
+
+    auto diagram_copy = coreui::Cloner::Clone(
+        project.GetDiagrams()[diagram_indices[index]], project.GetFamilies());
+
+    if (coreui::CalculatorMapper::PopulateDiagram(diagram_copy, project, {},
+                                                  calculated_trees)
+            .empty()) {
+      continue;
+    }
+
+    // vh: Nodes of the result keep default positions, since only the editor
+    // knows their sizes to arrange them.
+    auto new_diagram_name = core::Diagram::MakeUniqueDiagramName(
+        project.GetDiagrams(), diagram_copy.GetName(), "calc.");
+    calculation_report["diagram"] = new_diagram_name;
+    diagram_copy.SetName(std::move(new_diagram_name));
+
+    project.EmplaceDiagram(std::move(diagram_copy));
+    result_indices[index] = static_cast<int>(project.GetDiagrams().size()) - 1;
+  }
+
+  return result_indices;
+}
+
+///
+auto App::CalculateLocally(calc::BatchTask::ConstructorArgs batch_args) const
+    -> std::vector<std::vector<calc::TreeNode>> {
+  const auto estimate = calc::BatchTask::ChooseCalculation(batch_args);
+  batch_args.calculator_args.settings.engine = estimate.engine;
+  batch_args.calculator_args.settings.beam_width = estimate.beam_width;
+  PrintEstimate(estimate);
+
+  auto batch_task = calc::BatchTask{std::move(batch_args)};
+  WaitForResults(batch_task);
+
+  auto results = batch_task.GetResults();
+  Expects(results.has_value());
+
+  if (const auto cache_file_path = GetCacheFilePath();
+      !cache_file_path.empty() &&
+      !best_trees_cache_->WriteToFile(cache_file_path)) {
+    std::cerr << "Couldn't write cache to " << cache_file_path.string()
+              << "\n";
+  }
+
+  return std::move(*results);
+}
+
+///
+auto App::CalculateOnDaemon(const std::vector<int> &diagram_indices) const
+    -> std::optional<std::vector<std::vector<calc::TreeNode>>> {
+  // vh: Daemon keeps its own cache and chooses the engine on its machine.
+  auto task_args =
+      daemon::Task::ConstructorArgs{.socket_path = options_.daemon_socket,
+                                    .priority = options_.daemon_priority,
+                                    .project = daemon::Task::WriteProject(
+                                        *project_)};
+  task_args.diagrams.reserve(diagram_indices.size());
+
+  for (const auto diagram_index : diagram_indices) {
+    task_args.diagrams.emplace_back(daemon::Task::WriteDiagram(
+        project_->GetDiagrams()[diagram_index], {}));
+  }
+
+  auto daemon_task = daemon::Task{std::move(task_args)};
+  WaitForResults(daemon_task);
+
+  auto result = daemon_task.GetResult();
+  Expects(result.has_value());
+
+  if (!result->error.empty()) {
+    std::cerr << result->error << "\n";
+    return std::nullopt;
+  }
+
+  return std::move(result->calculated_trees);
+}
+
+///
+auto App::GetCacheFilePath() const -> std::filesystem::path {
+  if (!project_->GetSettings().calculator_settings.keep_cache_file) {
+    return {};
+  }
+
+  auto file_path = options_.project_file;
+  file_path.replace_extension(".cache");
+  return file_path;
+}
+
+///
+auto App::WriteProject() const -> bool {
+  const auto json = json::ProjectSerializer::WriteToJson(*project_);
+
+  if (!json.save(options_.output_file.string())) {
+    std::cerr << "Couldn't write project to " << options_.output_file.string()
+              << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+///
+auto App::WriteReport(const crude_json::value &report) const -> bool {
+  if (options_.report_file.empty()) {
+    std::cout << report.dump(kReportIndent) << "\n";
+    return true;
+  }
+
+  if (!report.save(options_.report_file.string(), kReportIndent)) {
+    std::cerr << "Couldn't write report to " << options_.report_file.string()
+              << "\n";
+    return false;
+  }
+
+  return true;
+}
+}  // namespace vh::ponc::cli
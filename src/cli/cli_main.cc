@@ -0,0 +1,35 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "calc_calculator.h"
+#include "calc_worker_pool.h"
+#include "cli_app.h"
+#include "cli_options.h"
+
+///
+auto main(int argc, char **argv) -> int {
+  // vh: Calculator runs its worker processes in this mode of the tool.
+  if (const auto worker_option = vh::ponc::calc::WorkerPool::kWorkerOption;
+      (argc == 2) && (std::string_view{argv[1]} == worker_option)) {
+    return vh::ponc::calc::Calculator::RunWorker();
+  }
+
+  auto options =
+      vh::ponc::cli::Options::Parse(std::span{argv + 1, argv + argc});
+
+  if (!options.has_value()) {
+    std::cerr << vh::ponc::cli::Options::GetUsage();
+    return EXIT_FAILURE;
+  }
+
+  return vh::ponc::cli::App{std::move(*options)}.Run();
+}
@@ -0,0 +1,95 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "cli_options.h"
+
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace vh::ponc::cli {
+///
+auto Options::Parse(std::span<char *const> args) -> std::optional<Options> {
+  auto options = Options{};
+
+  for (auto arg = args.begin(); arg != args.end(); ++arg) {
+    const auto name = std::string_view{*arg};
+
+    // vh: Options with a value take the next argument.
+    const auto take_value = [&arg, &args]() -> std::optional<std::string> {
+      if (std::next(arg) == args.end()) {
+        return std::nullopt;
+      }
+
+      return *++arg;
+    };
+
+    if (name == "--calculate") {
+      options.calculate = true;
+    } else if (name == "--flow") {
+      options.evaluate_flow = true;
+    } else if ((name == "--diagram") || (name == "--output") ||
+               (name == "--report") || (name == "--daemon") ||
+               (name == "--priority")) {
+      auto value = take_value();
+
+      if (!value.has_value()) {
+        return std::nullopt;
+      }
+
+      if (name == "--diagram") {
+        options.diagram_names.emplace_back(std::move(*value));
+      } else if (name == "--output") {
+        options.output_file = std::move(*value);
+      } else if (name == "--report") {
+        options.report_file = std::move(*value);
+      } else if (name == "--daemon") {
+        options.daemon_socket = std::move(*value);
+      } else {
+        try {
+          options.daemon_priority = std::stoi(*value);
+        } catch (const std::exception&) {
+          return std::nullopt;
+        }
+      }
+    } else if (!name.starts_with("--") && options.project_file.empty()) {
+      options.project_file = name;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  if (options.project_file.empty() ||
+      (!options.calculate && !options.evaluate_flow)) {
+    return std::nullopt;
+  }
+
+  return options;
+}
+
+///
+auto Options::GetUsage() -> std::string {
+  return "Usage: ponc-cli PROJECT [--calculate] [--flow] [--diagram NAME]...\n"
+         "                [--output FILE] [--report FILE]\n"
+         "                [--daemon SOCKET [--priority N]]\n"
+         "\n"
+         "  --calculate      Calculate the diagrams and add the results to\n"
+         "                   the project as calc. diagrams.\n"
+         "  --flow           Evaluate flow at the clients of the diagrams and\n"
+         "                   of their results.\n"
+         "  --diagram NAME   Diagram to use, all of them if not specified.\n"
+         "  --output FILE    File to write the updated project to.\n"
+         "  --report FILE    File to write the JSON report to, stdout if not\n"
+         "                   specified.\n"
+         "  --daemon SOCKET  Calculate on ponc-daemon listening on the socket\n"
+         "                   instead of in this process.\n"
+         "  --priority N     Priority of the job in the daemon queue, higher\n"
+         "                   ones start first. 0 by default.\n";
+}
+}  // namespace vh::ponc::cli
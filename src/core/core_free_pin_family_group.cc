@@ -26,6 +26,7 @@
 #include "cpp_safe_ptr.h"
 #include "json_i_family_writer.h"
 #include "json_i_node_parser.h"
+#include "json_value_checker.h"
 #include "style_default_colors.h"
 
 namespace vh::ponc::core {
@@ -56,6 +57,12 @@ class Node : public core::INode {
 ///
 class NodeParser : public json::INodeParser {
  private:
+  ///
+  auto CanParseDataFromJson(const crude_json::value& /*unused*/) const
+      -> bool override {
+    return true;
+  }
+
   ///
   auto ParseFromJson(const core::INode::ConstructorArgs& parsed_args,
                      const crude_json::value& /*unused*/) const
@@ -199,6 +206,15 @@ class FamilyParser : public json::IFamilyParser {
   ///
   auto GetTypeName() const -> std::string override { return kTypeName; }
 
+  ///
+  auto CanParseDataFromJson(const crude_json::value& json) const
+      -> bool override {
+    return json::ValueChecker::HasValue(json, "pin_kind") &&
+           json::ValueChecker::IsInteger(
+               json["pin_kind"], static_cast<int>(ne::PinKind::Output),
+               static_cast<int>(ne::PinKind::Input));
+  }
+
   ///
   auto ParseFromJson(core::FamilyId parsed_id,
                      const crude_json::value& json) const
@@ -60,6 +60,19 @@ void Settings::ResetToDefault(Settings& settings) {
   settings.calculator_settings.min_output = -22;
   settings.calculator_settings.max_output = -18;
   settings.calculator_settings.num_clients = 20;
+  settings.calculator_settings.num_threads = 0;
+  settings.calculator_settings.engine = CalculatorEngine::kPermutations;
+  settings.calculator_settings.keep_cache_file = false;
+  settings.calculator_settings.num_layouts = 1;
+  settings.calculator_settings.flow_resolution = 0.01F;
+  settings.calculator_settings.beam_width = 0;
+  settings.calculator_settings.time_budget = 60;
+  settings.calculator_settings.memory_budget = 1024;
+  settings.calculator_settings.max_depth = 0;
+  settings.calculator_settings.max_devices = 0;
+  settings.calculator_settings.num_processes = 0;
+  settings.calculator_settings.daemon_socket.clear();
+  settings.calculator_settings.daemon_priority = 0;
 
   for (auto& family_settings : settings.calculator_settings.family_settings) {
     family_settings.enabled = true;
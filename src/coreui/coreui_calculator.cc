@@ -9,12 +9,13 @@
 #include <imgui_node_editor.h>
 
 #include <algorithm>
-#include <concepts>
+#include <cmath>
+#include <filesystem>
 #include <iterator>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <sstream>
-#include <stack>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -22,422 +23,441 @@
 #include <vector>
 
 #include "calc_calculator.h"
+#include "calc_estimator.h"
 #include "calc_resolution.h"
 #include "calc_tree_node.h"
-#include "calc_tree_traversal.h"
 #include "calc_types.h"
 #include "core_diagram.h"
-#include "core_i_node.h"
-#include "core_id_generator.h"
-#include "core_link.h"
 #include "core_project.h"
 #include "core_settings.h"
+#include "coreui_calculator_mapper.h"
 #include "coreui_cloner.h"
 #include "coreui_diagram.h"
 #include "coreui_event.h"
+#include "coreui_event_loop.h"
 #include "coreui_log.h"
 #include "coreui_native_facade.h"
 #include "coreui_node_mover.h"
 #include "coreui_project.h"
 #include "cpp_assert.h"
 #include "cpp_scope.h"
+#include "daemon_task.h"
 #include "flow_algorithms.h"
-#include "flow_node_flow.h"
 #include "flow_tree_node.h"
 #include "flow_tree_traversal.h"
 
 namespace vh::ponc::coreui {
 namespace {
 ///
-auto GetNodeOutputs(const core::INode& node) {
-  const auto& output_pins = node.GetOutputPinIds();
+constexpr auto kBytesPerMegabyte = 1024 * 1024;
 
-  if (output_pins.empty()) {
-    return std::vector<float>{};
-  }
+///
+auto GetTotalCost(const std::vector<calc::TreeNode>& calculated_trees) {
+  return std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
+                         [](const auto total_cost, const auto& tree) {
+                           return total_cost + tree.tree_cost;
+                         });
+}
 
-  const auto output_pin_flows = node.GetInitialFlow().output_pin_flows;
+///
+auto GetNumClients(const std::vector<calc::TreeNode>& calculated_trees) {
+  return std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
+                         [](const auto num_clients, const auto& tree) {
+                           return num_clients + tree.num_clients;
+                         });
+}
 
-  auto outputs = std::vector<float>{};
-  outputs.reserve(output_pins.size());
+///
+auto GetOutputTrees(
+    const std::vector<flow::TreeNode>& flow_trees,
+    const std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>&
+        output_root_ids) {
+  auto output_trees = std::vector<flow::TreeNode>{};
+  output_trees.reserve(output_root_ids.size());
 
-  std::transform(output_pins.cbegin(), output_pins.cend(),
-                 std::back_inserter(outputs),
-                 [&output_pin_flows](const auto pin_id) {
-                   const auto pin_id_value = pin_id.Get();
-                   Expects(output_pin_flows.contains(pin_id_value));
-                   return output_pin_flows.at(pin_id_value);
+  std::transform(output_root_ids.cbegin(), output_root_ids.cend(),
+                 std::back_inserter(output_trees),
+                 [&flow_trees](const auto& output_root) {
+                   return flow::FindTreeNode(flow_trees, output_root.second);
                  });
 
-  return outputs;
+  return output_trees;
 }
+}  // namespace
 
 ///
-void TraverseFreeOutputs(
-    const core::Diagram& diagram,
-    const std::invocable<const flow::TreeNode&, flow::PinFlow> auto& visitor,
-    const flow::TreeNode& flow_tree, const flow::NodeFlows& node_flows) {
-  flow::TraverseDepthFirst(
-      flow_tree,
-      [&diagram, &visitor, &node_flows](const auto& tree_node) {
-        const core::INode& node =
-            core::Diagram::FindNode(diagram, tree_node.node_id);
-        const auto output_pins = node.GetOutputPinIds();
-        const auto output_pin_flows = node.GetInitialFlow().output_pin_flows;
+Calculator::Calculator(cpp::SafePtr<Project> parent_project)
+    : parent_project_{std::move(parent_project)},
+      best_trees_cache_{std::make_shared<calc::BestTreesCache>()} {}
 
-        const auto node_id = tree_node.node_id.Get();
-        Expects(node_flows.contains(node_id));
-        const auto& node_flow = node_flows.at(node_id);
+///
+void Calculator::OnFrame() {
+  std::erase_if(stopped_tasks_,
+                [](const auto& task) { return !task->IsRunning(); });
+
+  if (daemon_task_.has_value()) {
+    ProcessDaemonResult();
+    return;
+  }
+
+  if (batch_task_.has_value()) {
+    ProcessBatchResults();
+    return;
+  }
 
-        for (const auto pin_id : output_pins) {
-          const auto pin_id_value = pin_id.Get();
+  if (calculation_task_ == nullptr) {
+    return;
+  }
 
-          if (tree_node.child_nodes.contains(pin_id_value)) {
-            continue;
-          }
+  if (!calculation_task_->GetResult().has_value()) {
+    return;
+  }
 
-          const auto pin_flow = node_flow.output_pin_flows.find(pin_id_value);
-          Expects(pin_flow != node_flow.output_pin_flows.cend());
+  LogStatistics(calculation_task_->GetStatistics());
+  KeepCostCurve();
 
-          visitor(tree_node, *pin_flow);
-        }
-      },
-      [](const auto&) {});
-}
+  auto layout_results = cost_curve_calculator_->MakeLayoutResults();
+  Expects(!layout_results.empty());
 
-///
-void TraverseFreeOutputs(
-    const core::Diagram& diagram, const core::Project& project,
-    const std::invocable<const flow::TreeNode&, flow::PinFlow> auto& visitor) {
-  const auto flow_trees = flow::BuildFlowTrees(diagram);
-  const auto node_flows = flow::CalculateNodeFlows(
-      flow_trees,
-      [&diagram](const auto node_id) {
-        return core::Diagram::FindNode(diagram, node_id).GetInitialFlow();
-      },
-      [&diagram, &project](const auto pin_id) {
-        const auto link = core::Diagram::FindPinLink(diagram, pin_id);
-        Expects(link.has_value());
-        return core::Link::GetDrop(**link, project);
-      });
+  const auto& families = parent_project_->GetProject().GetFamilies();
 
-  for (const auto& flow_tree : flow_trees) {
-    TraverseFreeOutputs(diagram, visitor, flow_tree, node_flows);
+  for (auto layout_result = std::next(layout_results.begin());
+       layout_result != layout_results.end(); ++layout_result) {
+    next_results_.emplace_back(NextResult{
+        .diagram = coreui::Cloner::Clone(*cost_curve_diagram_, families),
+        .calculated_free_outputs = cost_curve_free_outputs_,
+        .calculated_trees = std::move(*layout_result)});
   }
+
+  ProcessResult(layout_results.front());
+  WriteCacheFile();
 }
 
 ///
-auto GetFreeOutputs(const core::Diagram& diagram,
-                    const core::Project& project) {
-  auto free_outputs = std::vector<std::vector<float>>{};
-  auto traversing_node_id = std::optional<ne::NodeId>{};
+auto Calculator::ValidateInputs(
+    const std::vector<calc::TreeNode>& input_nodes) const {
+  if (input_nodes.empty()) {
+    parent_project_->GetLog().Write(
+        LogLevel::kError, "Calculator: Diagram should have free outputs.");
+    return false;
+  }
 
-  TraverseFreeOutputs(diagram, project,
-                      [&free_outputs, &traversing_node_id](
-                          const auto& tree_node, const auto& pin_flow) {
-                        if (!traversing_node_id.has_value() ||
-                            (*traversing_node_id != tree_node.node_id)) {
-                          traversing_node_id = tree_node.node_id;
-                          free_outputs.emplace_back();
-                        }
+  const auto& settings =
+      parent_project_->GetProject().GetSettings().calculator_settings;
 
-                        Expects(!free_outputs.empty());
-                        free_outputs.back().emplace_back(pin_flow.second);
-                      });
+  if (settings.min_output > settings.max_output) {
+    parent_project_->GetLog().Write(
+        LogLevel::kError, "Calculator: Min Output should be <= Max Output.");
+    return false;
+  }
 
-  return free_outputs;
+  return true;
 }
 
 ///
-auto GetInputNodes(const core::Diagram& diagram, const core::Project& project) {
-  const auto free_outputs = GetFreeOutputs(diagram, project);
+void Calculator::Calculate() { Calculate(std::vector<bool>{}); }
 
-  auto input_nodes = std::vector<calc::TreeNode>{};
-  input_nodes.reserve(free_outputs.size());
-
-  std::transform(free_outputs.cbegin(), free_outputs.cend(),
-                 std::back_inserter(input_nodes), [](const auto& free_outputs) {
-                   return calc::TreeNode{
-                       .outputs = calc::ToCalculatorResolution(free_outputs)};
-                 });
+///
+void Calculator::CalculateSelected() {
+  const auto& diagram = parent_project_->GetDiagram().GetDiagram();
+  auto calculated_free_outputs =
+      CalculatorMapper::FindCalculatedFreeOutputs(
+          diagram, parent_project_->GetProject(),
+          NativeFacade::GetSelectedNodes());
+
+  if (std::none_of(calculated_free_outputs.cbegin(),
+                   calculated_free_outputs.cend(),
+                   [](const auto calculated) { return calculated; })) {
+    parent_project_->GetLog().Write(
+        LogLevel::kError,
+        "Calculator: Selected nodes should have free outputs.");
+    return;
+  }
 
-  return input_nodes;
+  Calculate(std::move(calculated_free_outputs));
 }
 
 ///
-auto GetClientFamilyId(const core::Project& project) {
-  const auto& families = project.GetFamilies();
-  const auto client_family =
-      std::find_if(families.cbegin(), families.cend(), [](const auto& family) {
-        const auto& type = family->GetType();
-        return type.has_value() && (*type == core::FamilyType::kClient);
-      });
+void Calculator::Calculate(std::vector<bool> calculated_free_outputs) {
+  const auto& diagram = parent_project_->GetDiagram().GetDiagram();
+  auto& core_project = parent_project_->GetProject();
+  auto input_nodes = CalculatorMapper::GetInputNodes(diagram, core_project,
+                                                    calculated_free_outputs);
 
-  Expects(client_family != families.cend());
-  return (*client_family)->GetId();
-}
+  if (!ValidateInputs(input_nodes)) {
+    return;
+  }
 
-///
-auto GetChildOutputIndex(const calc::TreeNode& parent,
-                         const calc::TreeNode* child) {
-  const auto child_node = std::find_if(
-      parent.child_nodes.cbegin(), parent.child_nodes.cend(),
-      [child](const auto& child_node) { return &child_node.second == child; });
+  if (UsesDaemon()) {
+    auto daemon_results = std::vector<NextResult>{};
+    daemon_results.emplace_back(NextResult{
+        .diagram = coreui::Cloner::Clone(diagram, core_project.GetFamilies()),
+        .calculated_free_outputs = std::move(calculated_free_outputs)});
 
-  Expects(child_node != parent.child_nodes.cend());
-  return child_node->first;
-}
+    SubmitToDaemon(std::move(daemon_results));
+    return;
+  }
 
-///
-auto GetOutputTrees(
-    const std::vector<flow::TreeNode>& flow_trees,
-    const std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>&
-        output_root_ids) {
-  auto output_trees = std::vector<flow::TreeNode>{};
-  output_trees.reserve(output_root_ids.size());
+  auto calculator_args = CalculatorMapper::MakeCalculatorArgs(core_project);
+  calculator_args.input_nodes = std::move(input_nodes);
+  calculator_args.best_trees_cache = best_trees_cache_;
 
-  std::transform(output_root_ids.cbegin(), output_root_ids.cend(),
-                 std::back_inserter(output_trees),
-                 [&flow_trees](const auto& output_root) {
-                   return flow::FindTreeNode(flow_trees, output_root.second);
-                 });
+  estimate_ = calc::Estimator{calculator_args}.ChooseCalculation();
+  calculator_args.settings.engine = estimate_->engine;
+  calculator_args.settings.beam_width = estimate_->beam_width;
+  LogEstimate(*estimate_);
 
-  return output_trees;
+  ReadCacheFile(calculator_args.settings);
+  diagram_copy_.emplace(
+      coreui::Cloner::Clone(diagram, core_project.GetFamilies()));
+  calculated_free_outputs_ = std::move(calculated_free_outputs);
+
+  calculation_task_ =
+      std::make_unique<calc::CalculationTask>(std::move(calculator_args));
 }
 
 ///
-auto GetFirstLevelChild(const std::vector<calc::TreeNode>& tree_nodes,
-                        int output_index)
-    -> std::optional<const calc::TreeNode*> {
-  auto delta = 0;
-
-  for (const auto& tree_node : tree_nodes) {
-    const auto next_delta = delta + static_cast<int>(tree_node.outputs.size());
+void Calculator::CalculateDiagrams(const std::vector<int>& diagram_indices) {
+  auto& core_project = parent_project_->GetProject();
+  const auto& diagrams = core_project.GetDiagrams();
+  const auto& families = core_project.GetFamilies();
 
-    if (output_index < next_delta) {
-      const auto child_index = output_index - delta;
-      const auto child_tree = tree_node.child_nodes.find(child_index);
+  auto batch_args = calc::BatchTask::ConstructorArgs{};
+  batch_diagrams_.clear();
 
-      if (child_tree == tree_node.child_nodes.cend()) {
-        return std::nullopt;
-      }
+  for (const auto diagram_index : diagram_indices) {
+    Expects((diagram_index >= 0) &&
+            (diagram_index < static_cast<int>(diagrams.size())));
+    const auto& diagram = diagrams[diagram_index];
+    auto input_nodes =
+        CalculatorMapper::GetInputNodes(diagram, core_project, {});
 
-      return &child_tree->second;
+    if (input_nodes.empty()) {
+      parent_project_->GetLog().Write(
+          LogLevel::kInfo, "Calculator: Skipped " + diagram.GetName() +
+                               " without free outputs.");
+      continue;
     }
 
-    delta = next_delta;
+    batch_args.diagram_input_nodes.emplace_back(std::move(input_nodes));
+    batch_diagrams_.emplace_back(coreui::Cloner::Clone(diagram, families));
   }
 
-  Expects(false);
-}
-}  // namespace
+  if (batch_args.diagram_input_nodes.empty()) {
+    parent_project_->GetLog().Write(
+        LogLevel::kError, "Calculator: Diagrams should have free outputs.");
+    return;
+  }
 
-///
-Calculator::Calculator(cpp::SafePtr<Project> parent_project)
-    : parent_project_{std::move(parent_project)} {}
-
-///
-auto Calculator::PopulateOutput(const calc::TreeNode& output_tree,
-                                ne::PinId output_pin) {
-  auto& project = parent_project_->GetProject();
-  auto& id_generator = project.GetIdGenerator();
-
-  auto parent_stack =
-      std::stack<std::pair<const calc::TreeNode*, const core::INode*>>{};
-  auto output_root_id = ne::NodeId{};
-
-  calc::TraverseDepthFirst(
-      output_tree,
-      [output_pin, &project, &id_generator, &parent_stack, &output_root_id,
-       &diagram_copy = diagram_copy_](const auto& tree_node) {
-        const auto& family =
-            core::Project::FindFamily(project, tree_node.family_id);
-        const auto& node =
-            diagram_copy->EmplaceNode(family.CreateNode(id_generator));
-
-        auto parent_output_pin = output_pin;
-
-        if (parent_stack.empty()) {
-          output_root_id = node.GetId();
-        } else {
-          const auto& [parent_tree_node, parent_node] = parent_stack.top();
-          const auto parent_output_pins = parent_node->GetOutputPinIds();
-          const auto output_index =
-              GetChildOutputIndex(*parent_tree_node, &tree_node);
-
-          Expects(output_index < static_cast<int>(parent_output_pins.size()));
-          parent_output_pin = parent_output_pins[output_index];
-        }
+  if (!ValidateInputs(batch_args.diagram_input_nodes.front())) {
+    batch_diagrams_.clear();
+    return;
+  }
 
-        const auto input_pin =
-            core::INode::GetFirstPinOfKind(node, ne::PinKind::Input);
-        const auto link = core::Link{.id = id_generator.Generate<ne::LinkId>(),
-                                     .start_pin_id = parent_output_pin,
-                                     .end_pin_id = input_pin};
+  if (UsesDaemon()) {
+    auto daemon_results = std::vector<NextResult>{};
+    daemon_results.reserve(batch_diagrams_.size());
+
+    for (auto& diagram : batch_diagrams_) {
+      daemon_results.emplace_back(NextResult{.diagram = std::move(diagram)});
+    }
+
+    batch_diagrams_.clear();
+    SubmitToDaemon(std::move(daemon_results));
+    return;
+  }
 
-        diagram_copy->EmplaceLink(link);
+  batch_args.calculator_args =
+      CalculatorMapper::MakeCalculatorArgs(core_project);
+  batch_args.calculator_args.best_trees_cache = best_trees_cache_;
 
-        parent_stack.emplace(&tree_node, &node);
-      },
-      [&parent_stack](const auto&) { parent_stack.pop(); });
+  estimate_ = calc::BatchTask::ChooseCalculation(batch_args);
+  batch_args.calculator_args.settings.engine = estimate_->engine;
+  batch_args.calculator_args.settings.beam_width = estimate_->beam_width;
+  LogEstimate(*estimate_);
 
-  return output_root_id;
+  ReadCacheFile(batch_args.calculator_args.settings);
+  batch_task_.emplace(std::move(batch_args));
 }
 
 ///
-auto Calculator::PopulateDiagram(
-    const std::vector<calc::TreeNode>& calculated_trees) {
-  Expects(diagram_copy_.has_value());
+auto Calculator::UsesDaemon() const -> bool {
+  return !parent_project_->GetProject()
+              .GetSettings()
+              .calculator_settings.daemon_socket.empty();
+}
 
-  auto& core_project = parent_project_->GetProject();
-  coreui::Cloner::RewireIds(core::Diagram::GetIds(*diagram_copy_),
-                            core_project.GetIdGenerator());
-
-  auto output_root_ids =
-      std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>{};
-  auto output_index = 0;
-
-  TraverseFreeOutputs(
-      *diagram_copy_, core_project,
-      [this, &calculated_trees, &output_root_ids, &output_index](
-          const auto&, const auto& pin_flow) {
-        if (const auto output_tree =
-                GetFirstLevelChild(calculated_trees, output_index)) {
-          const auto output_root_id =
-              PopulateOutput(**output_tree, pin_flow.first);
-          output_root_ids.emplace(pin_flow.first, output_root_id);
-        }
+///
+void Calculator::SubmitToDaemon(std::vector<NextResult> daemon_results) {
+  const auto& core_project = parent_project_->GetProject();
+  const auto& settings = core_project.GetSettings().calculator_settings;
+
+  // vh: Daemon has its own cache and chooses the engine on its machine, so
+  // only the diagrams and settings are sent.
+  auto task_args = daemon::Task::ConstructorArgs{
+      .socket_path = settings.daemon_socket,
+      .priority = settings.daemon_priority,
+      .project = daemon::Task::WriteProject(core_project)};
+  task_args.diagrams.reserve(daemon_results.size());
+
+  for (const auto& daemon_result : daemon_results) {
+    task_args.diagrams.emplace_back(daemon::Task::WriteDiagram(
+        daemon_result.diagram, daemon_result.calculated_free_outputs));
+  }
 
-        ++output_index;
-      });
+  parent_project_->GetLog().Write(
+      LogLevel::kInfo, "Calculator: Submitted " +
+                           std::to_string(daemon_results.size()) +
+                           " diagrams to daemon at " + settings.daemon_socket);
 
-  return output_root_ids;
+  daemon_results_ = std::move(daemon_results);
+  daemon_task_.emplace(std::move(task_args));
 }
 
 ///
-void Calculator::OnFrame() {
-  if (!calculation_task_.has_value()) {
+void Calculator::UpdateEstimate() {
+  const auto& diagram = parent_project_->GetDiagram().GetDiagram();
+  auto& core_project = parent_project_->GetProject();
+  auto input_nodes = CalculatorMapper::GetInputNodes(diagram, core_project, {});
+
+  if (!ValidateInputs(input_nodes)) {
     return;
   }
 
-  const auto result = calculation_task_->GetResult();
+  auto calculator_args = CalculatorMapper::MakeCalculatorArgs(core_project);
+  calculator_args.input_nodes = std::move(input_nodes);
 
-  if (!result.has_value()) {
-    return;
-  }
+  estimate_ = calc::Estimator{calculator_args}.ChooseCalculation();
+}
 
-  ProcessResult(*result);
+///
+auto Calculator::GetEstimate() const
+    -> const std::optional<calc::Estimator::Estimate>& {
+  return estimate_;
 }
 
 ///
-auto Calculator::ValidateInputs(
-    const std::vector<calc::TreeNode>& input_nodes) const {
-  if (input_nodes.empty()) {
-    parent_project_->GetLog().Write(
-        LogLevel::kError, "Calculator: Diagram should have free outputs.");
-    return false;
+void Calculator::Cancel() {
+  diagram_copy_.reset();
+  ReleaseCalculationTask();
+  batch_task_.reset();
+  batch_diagrams_.clear();
+  daemon_task_.reset();
+  daemon_results_.clear();
+}
+
+///
+auto Calculator::IsRunning() const -> bool {
+  if (daemon_task_.has_value()) {
+    return daemon_task_->IsRunning();
   }
 
-  const auto& settings =
-      parent_project_->GetProject().GetSettings().calculator_settings;
+  if (batch_task_.has_value()) {
+    return batch_task_->IsRunning();
+  }
 
-  if (settings.min_output > settings.max_output) {
-    parent_project_->GetLog().Write(
-        LogLevel::kError, "Calculator: Min Output should be <= Max Output.");
-    return false;
+  return (calculation_task_ != nullptr) && calculation_task_->IsRunning();
+}
+
+///
+auto Calculator::GetProgress() const -> float {
+  if (daemon_task_.has_value()) {
+    return daemon_task_->GetProgress();
   }
 
-  return true;
+  if (batch_task_.has_value()) {
+    return batch_task_->GetProgress();
+  }
+
+  Expects(calculation_task_ != nullptr);
+  return calculation_task_->GetProgress();
 }
 
 ///
-auto Calculator::AsFamilyNodes(
-    const std::vector<std::unique_ptr<core::IFamily>>& families) const {
-  const auto& family_settings = parent_project_->GetProject()
-                                    .GetSettings()
-                                    .calculator_settings.family_settings;
+auto Calculator::GetTimeLeft() const -> std::optional<std::chrono::seconds> {
+  if (daemon_task_.has_value()) {
+    return daemon_task_->GetTimeLeft();
+  }
 
-  auto family_nodes = std::vector<calc::TreeNode>{};
+  if (batch_task_.has_value()) {
+    return batch_task_->GetTimeLeft();
+  }
 
-  for (const auto& settings : family_settings) {
-    if (!settings.enabled) {
-      continue;
-    }
+  Expects(calculation_task_ != nullptr);
+  return calculation_task_->GetTimeLeft();
+}
 
-    const auto family = std::find_if(
-        families.cbegin(), families.cend(), [&settings](const auto& family) {
-          return family->GetId() == settings.family_id;
-        });
-    Expects(family != families.cend());
+///
+auto Calculator::GetNumJobsAhead() const -> std::optional<int> {
+  if (!daemon_task_.has_value()) {
+    return std::nullopt;
+  }
 
-    const auto cost = calc::ToCalculatorResolution(settings.cost);
-    const auto sample_node = (*family)->CreateSampleNode();
-    const auto outputs = GetNodeOutputs(*sample_node);
+  return daemon_task_->GetNumJobsAhead();
+}
 
-    family_nodes.emplace_back(
-        calc::TreeNode{.family_id = settings.family_id,
-                       .node_cost = cost,
-                       .tree_cost = cost,
-                       .outputs = calc::ToCalculatorResolution(outputs)});
+///
+auto Calculator::GetBestResult()
+    -> const std::optional<calc::CalculationTask::BestResult>& {
+  // vh: Batch has no single best result to accept.
+  if (calculation_task_ == nullptr) {
+    static const auto kNoBestResult =
+        std::optional<calc::CalculationTask::BestResult>{};
+    return kNoBestResult;
   }
 
-  return family_nodes;
+  return calculation_task_->GetBestResult();
 }
 
 ///
-void Calculator::Calculate() {
-  const auto& diagram = parent_project_->GetDiagram().GetDiagram();
-  auto& core_project = parent_project_->GetProject();
-  auto input_nodes = GetInputNodes(diagram, core_project);
+void Calculator::AcceptBestResult() {
+  Expects(calculation_task_ != nullptr);
 
-  if (!ValidateInputs(input_nodes)) {
+  auto best_result = calculation_task_->GetBestResult();
+
+  if (!best_result.has_value()) {
     return;
   }
 
-  const auto& families = core_project.GetFamilies();
-
-  diagram_copy_.emplace(coreui::Cloner::Clone(diagram, families));
-
-  calculation_task_.emplace(calc::Calculator::ConstructorArgs{
-      .settings = core_project.GetSettings().calculator_settings,
-      .input_nodes = std::move(input_nodes),
-      .client_node =
-          calc::TreeNode{.family_id = GetClientFamilyId(core_project),
-                         .num_clients = 1},
-      .family_nodes = AsFamilyNodes(families)});
+  ReleaseCalculationTask();
+  ProcessResult(best_result->calculated_trees);
 }
 
 ///
-void Calculator::Cancel() {
-  diagram_copy_.reset();
-  calculation_task_.reset();
+void Calculator::ReleaseCalculationTask() {
+  if (calculation_task_ == nullptr) {
+    return;
+  }
+
+  // vh: Calculator only sees the stop at its next step, which could be a
+  // whole wave of workers away, so the task is dropped once it is done
+  // instead of being waited for here.
+  calculation_task_->Stop();
+  stopped_tasks_.emplace_back(std::move(calculation_task_));
 }
 
 ///
-auto Calculator::IsRunning() const -> bool {
-  return calculation_task_.has_value() && calculation_task_->IsRunning();
+auto Calculator::GetCostCurve() const
+    -> const std::vector<calc::Calculator::CostCurvePoint>& {
+  return cost_curve_;
 }
 
 ///
-auto Calculator::GetProgress() const -> float {
-  Expects(calculation_task_.has_value());
-  return calculation_task_->GetProgress();
+void Calculator::AddCostCurveDiagram(calc::NumClients num_clients) {
+  if ((cost_curve_calculator_ == nullptr) || IsRunning()) {
+    return;
+  }
+
+  ProcessCostCurveResult(
+      cost_curve_calculator_->MakeCostCurveResult(num_clients));
 }
 
 ///
 void Calculator::LogResult(const std::vector<calc::TreeNode>& calculated_trees,
                            std::string_view diagram_name) const {
-  const auto total_cost = calc::FromCalculatorResolution(
-      std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
-                      [](const auto total_cost, const auto& tree) {
-                        return total_cost + tree.tree_cost;
-                      }));
-
-  const auto num_clients =
-      std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
-                      [](const auto num_clients, const auto& tree) {
-                        return num_clients + tree.num_clients;
-                      });
+  const auto total_cost =
+      calc::FromCalculatorResolution(GetTotalCost(calculated_trees));
+  const auto num_clients = GetNumClients(calculated_trees);
 
   auto log_stream = std::ostringstream{};
   log_stream << "Calculator: Added " << num_clients << " clients for "
@@ -446,19 +466,271 @@ void Calculator::LogResult(const std::vector<calc::TreeNode>& calculated_trees,
   parent_project_->GetLog().Write(LogLevel::kDone, log_stream.str());
 }
 
+///
+void Calculator::LogBatchResults(const std::vector<NextResult>& results) const {
+  auto total_cost = calc::Cost{};
+  auto num_clients = calc::NumClients{};
+
+  for (const auto& result : results) {
+    const auto diagram_cost = GetTotalCost(result.calculated_trees);
+    const auto diagram_clients = GetNumClients(result.calculated_trees);
+
+    auto log_stream = std::ostringstream{};
+    log_stream << "Calculator: Calculated " << diagram_clients
+               << " clients for "
+               << calc::FromCalculatorResolution(diagram_cost) << "$ ("
+               << result.diagram.GetName() << ")";
+
+    parent_project_->GetLog().Write(LogLevel::kInfo, log_stream.str());
+
+    total_cost += diagram_cost;
+    num_clients += diagram_clients;
+  }
+
+  auto log_stream = std::ostringstream{};
+  log_stream << "Calculator: Calculated " << results.size()
+             << " diagrams with " << num_clients << " clients for "
+             << calc::FromCalculatorResolution(total_cost) << "$.";
+
+  parent_project_->GetLog().Write(LogLevel::kDone, log_stream.str());
+}
+
+///
+void Calculator::LogEstimate(const calc::Estimator::Estimate& estimate) const {
+  auto log_stream = std::ostringstream{};
+  log_stream << "Calculator: Estimated " << estimate.num_states
+             << " states, " << (estimate.memory_size / kBytesPerMegabyte)
+             << " MB and " << static_cast<int>(std::ceil(estimate.duration))
+             << " s for " << estimate.num_outputs << " outputs.";
+
+  parent_project_->GetLog().Write(LogLevel::kInfo, log_stream.str());
+}
+
+///
+void Calculator::LogStatistics(
+    const calc::Calculator::Statistics& statistics) const {
+  auto log_stream = std::ostringstream{};
+  log_stream << "Calculator: Presolve removed "
+             << statistics.num_removed_families << " families and "
+             << statistics.num_removed_outputs << " outputs.";
+
+  parent_project_->GetLog().Write(LogLevel::kInfo, log_stream.str());
+
+  log_stream = std::ostringstream{};
+  log_stream << "Calculator: Expanded " << statistics.num_expanded_nodes
+             << " nodes, pruned " << statistics.num_pruned_nodes << " nodes.";
+
+  parent_project_->GetLog().Write(LogLevel::kInfo, log_stream.str());
+
+  if (statistics.lower_bound_cost <= 0) {
+    return;
+  }
+
+  const auto cost_gap =
+      static_cast<float>(statistics.result_cost - statistics.lower_bound_cost) /
+      static_cast<float>(statistics.lower_bound_cost);
+
+  log_stream = std::ostringstream{};
+  log_stream << "Calculator: Result is at most "
+             << static_cast<int>(std::round(cost_gap * 100))
+             << "% above the lower bound of "
+             << calc::FromCalculatorResolution(statistics.lower_bound_cost)
+             << "$.";
+
+  parent_project_->GetLog().Write(LogLevel::kInfo, log_stream.str());
+}
+
 ///
 auto Calculator::ValidateResult(
     const std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>&
         output_root_ids) const {
   if (output_root_ids.empty()) {
+    Expects(diagram_copy_.has_value());
     parent_project_->GetLog().Write(
-        LogLevel::kDone, "Calculator: Couldn't fit any more clients.");
+        LogLevel::kDone, "Calculator: Couldn't fit any more clients (" +
+                             diagram_copy_->GetName() + ")");
     return false;
   }
 
   return true;
 }
 
+///
+auto Calculator::GetCacheFilePath() const -> std::filesystem::path {
+  const auto& project = parent_project_->GetProject();
+
+  if (!project.GetSettings().calculator_settings.keep_cache_file) {
+    return {};
+  }
+
+  auto file_path = parent_project_->GetFilePath();
+
+  if (!file_path.empty()) {
+    file_path.replace_extension(".cache");
+  }
+
+  return file_path;
+}
+
+///
+void Calculator::ReadCacheFile(const core::CalculatorSettings& settings) {
+  if (!calc::Calculator::UsesCache(settings)) {
+    parent_project_->GetLog().Write(
+        LogLevel::kInfo,
+        "Calculator: Cache isn't used with beam, layouts or path limits.");
+    return;
+  }
+
+  auto file_path = GetCacheFilePath();
+
+  if (file_path.empty() || (file_path == read_cache_file_path_)) {
+    return;
+  }
+
+  if (std::filesystem::exists(file_path) &&
+      best_trees_cache_->ReadFromFile(file_path)) {
+    parent_project_->GetLog().Write(
+        LogLevel::kInfo, "Calculator: Read cache from " + file_path.string());
+  }
+
+  read_cache_file_path_ = std::move(file_path);
+}
+
+///
+void Calculator::WriteCacheFile() const {
+  const auto file_path = GetCacheFilePath();
+
+  if (file_path.empty()) {
+    return;
+  }
+
+  if (!best_trees_cache_->WriteToFile(file_path)) {
+    parent_project_->GetLog().Write(
+        LogLevel::kError,
+        "Calculator: Couldn't write cache to " + file_path.string());
+  }
+}
+
+///
+void Calculator::KeepCostCurve() {
+  Expects(calculation_task_ != nullptr);
+  Expects(diagram_copy_.has_value());
+
+  // vh: Diagram copy is consumed by the result, so any other point of the
+  // curve is added to its own copy later.
+  const auto& families = parent_project_->GetProject().GetFamilies();
+
+  cost_curve_calculator_ = calculation_task_->GetFinishedCalculator();
+  cost_curve_diagram_.emplace(
+      coreui::Cloner::Clone(*diagram_copy_, families));
+  cost_curve_free_outputs_ = calculated_free_outputs_;
+  cost_curve_ = cost_curve_calculator_->GetCostCurve();
+}
+
+///
+void Calculator::ProcessCostCurveResult(
+    const std::vector<calc::TreeNode>& calculated_trees) {
+  Expects(cost_curve_diagram_.has_value());
+
+  const auto& families = parent_project_->GetProject().GetFamilies();
+  diagram_copy_.emplace(
+      coreui::Cloner::Clone(*cost_curve_diagram_, families));
+  calculated_free_outputs_ = cost_curve_free_outputs_;
+
+  ProcessResult(calculated_trees);
+}
+
+///
+void Calculator::ProcessBatchResults() {
+  Expects(batch_task_.has_value());
+  auto results = batch_task_->GetResults();
+
+  if (!results.has_value()) {
+    return;
+  }
+
+  batch_task_.reset();
+
+  Expects(results->size() == batch_diagrams_.size());
+  auto batch_results = std::vector<NextResult>{};
+
+  for (auto diagram_index = 0;
+       diagram_index < static_cast<int>(results->size()); ++diagram_index) {
+    batch_results.emplace_back(NextResult{
+        .diagram = std::move(batch_diagrams_[diagram_index]),
+        .calculated_trees = std::move((*results)[diagram_index])});
+  }
+
+  batch_diagrams_.clear();
+  LogBatchResults(batch_results);
+
+  next_results_.insert(next_results_.end(),
+                       std::make_move_iterator(batch_results.begin()),
+                       std::make_move_iterator(batch_results.end()));
+  ProcessNextResult();
+  WriteCacheFile();
+}
+
+///
+void Calculator::ProcessDaemonResult() {
+  Expects(daemon_task_.has_value());
+  auto result = daemon_task_->GetResult();
+
+  if (!result.has_value()) {
+    return;
+  }
+
+  daemon_task_.reset();
+
+  if (!result->error.empty()) {
+    parent_project_->GetLog().Write(LogLevel::kError,
+                                    "Calculator: " + result->error);
+    daemon_results_.clear();
+    return;
+  }
+
+  Expects(result->calculated_trees.size() == daemon_results_.size());
+
+  for (auto result_index = 0;
+       result_index < static_cast<int>(daemon_results_.size());
+       ++result_index) {
+    daemon_results_[result_index].calculated_trees =
+        std::move(result->calculated_trees[result_index]);
+  }
+
+  LogBatchResults(daemon_results_);
+
+  next_results_.insert(next_results_.end(),
+                       std::make_move_iterator(daemon_results_.begin()),
+                       std::make_move_iterator(daemon_results_.end()));
+  daemon_results_.clear();
+  ProcessNextResult();
+}
+
+///
+void Calculator::ProcessNextResult() {
+  if (next_results_.empty()) {
+    return;
+  }
+
+  // vh: New calculation takes the diagram copy, so the rest is dropped.
+  if ((calculation_task_ != nullptr) || batch_task_.has_value() ||
+      daemon_task_.has_value()) {
+    next_results_.clear();
+    return;
+  }
+
+  // vh: Results are added one after another, so each of them is arranged
+  // and named when the previous one is in the project.
+  auto next_result = std::move(next_results_.front());
+  next_results_.erase(next_results_.begin());
+
+  diagram_copy_.emplace(std::move(next_result.diagram));
+  calculated_free_outputs_ = std::move(next_result.calculated_free_outputs);
+
+  ProcessResult(next_result.calculated_trees);
+}
+
 ///
 void Calculator::ProcessResult(
     const std::vector<calc::TreeNode>& calculated_trees) {
@@ -467,13 +739,17 @@ void Calculator::ProcessResult(
     calculation_task_.reset();
   }};
 
-  const auto output_root_ids = PopulateDiagram(calculated_trees);
+  Expects(diagram_copy_.has_value());
+  const auto output_root_ids = CalculatorMapper::PopulateDiagram(
+      *diagram_copy_, parent_project_->GetProject(), calculated_free_outputs_,
+      calculated_trees);
 
   if (!ValidateResult(output_root_ids)) {
+    parent_project_->GetEventLoop().PostEvent(
+        [this]() { ProcessNextResult(); });
     return;
   }
 
-  Expects(diagram_copy_.has_value());
   auto flow_trees = flow::BuildFlowTrees(*diagram_copy_);
   auto output_trees = GetOutputTrees(flow_trees, output_root_ids);
 
@@ -502,6 +778,7 @@ void Calculator::ProcessResult(
         }
 
         ne::NavigateToSelection();
-      });
+      })
+      .Then([this]() { ProcessNextResult(); });
 }
 }  // namespace vh::ponc::coreui
\ No newline at end of file
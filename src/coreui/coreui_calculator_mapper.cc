@@ -0,0 +1,374 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "coreui_calculator_mapper.h"
+
+#include <imgui_node_editor.h>
+
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stack>
+#include <utility>
+#include <vector>
+
+#include "calc_resolution.h"
+#include "calc_tree_node.h"
+#include "calc_tree_traversal.h"
+#include "core_diagram.h"
+#include "core_i_node.h"
+#include "core_id_generator.h"
+#include "core_link.h"
+#include "core_project.h"
+#include "core_settings.h"
+#include "coreui_cloner.h"
+#include "cpp_assert.h"
+#include "flow_algorithms.h"
+#include "flow_node_flow.h"
+#include "flow_tree_node.h"
+#include "flow_tree_traversal.h"
+
+namespace vh::ponc::coreui {
+namespace {
+///
+auto GetNodeOutputs(const core::INode& node) {
+  const auto& output_pins = node.GetOutputPinIds();
+
+  if (output_pins.empty()) {
+    return std::vector<float>{};
+  }
+
+  const auto output_pin_flows = node.GetInitialFlow().output_pin_flows;
+
+  auto outputs = std::vector<float>{};
+  outputs.reserve(output_pins.size());
+
+  std::transform(output_pins.cbegin(), output_pins.cend(),
+                 std::back_inserter(outputs),
+                 [&output_pin_flows](const auto pin_id) {
+                   const auto pin_id_value = pin_id.Get();
+                   Expects(output_pin_flows.contains(pin_id_value));
+                   return output_pin_flows.at(pin_id_value);
+                 });
+
+  return outputs;
+}
+
+///
+void TraverseFreeOutputs(
+    const core::Diagram& diagram,
+    const std::invocable<const flow::TreeNode&, flow::PinFlow> auto& visitor,
+    const flow::TreeNode& flow_tree, const flow::NodeFlows& node_flows) {
+  flow::TraverseDepthFirst(
+      flow_tree,
+      [&diagram, &visitor, &node_flows](const auto& tree_node) {
+        const core::INode& node =
+            core::Diagram::FindNode(diagram, tree_node.node_id);
+        const auto output_pins = node.GetOutputPinIds();
+        const auto output_pin_flows = node.GetInitialFlow().output_pin_flows;
+
+        const auto node_id = tree_node.node_id.Get();
+        Expects(node_flows.contains(node_id));
+        const auto& node_flow = node_flows.at(node_id);
+
+        for (const auto pin_id : output_pins) {
+          const auto pin_id_value = pin_id.Get();
+
+          if (tree_node.child_nodes.contains(pin_id_value)) {
+            continue;
+          }
+
+          const auto pin_flow = node_flow.output_pin_flows.find(pin_id_value);
+          Expects(pin_flow != node_flow.output_pin_flows.cend());
+
+          visitor(tree_node, *pin_flow);
+        }
+      },
+      [](const auto&) {});
+}
+
+///
+void TraverseFreeOutputs(
+    const core::Diagram& diagram, const core::Project& project,
+    const std::invocable<const flow::TreeNode&, flow::PinFlow> auto& visitor) {
+  const auto flow_trees = flow::BuildFlowTrees(diagram);
+  const auto node_flows = flow::CalculateNodeFlows(
+      flow_trees,
+      [&diagram](const auto node_id) {
+        return core::Diagram::FindNode(diagram, node_id).GetInitialFlow();
+      },
+      [&diagram, &project](const auto pin_id) {
+        const auto link = core::Diagram::FindPinLink(diagram, pin_id);
+        Expects(link.has_value());
+        return core::Link::GetDrop(**link, project);
+      });
+
+  for (const auto& flow_tree : flow_trees) {
+    TraverseFreeOutputs(diagram, visitor, flow_tree, node_flows);
+  }
+}
+
+///
+auto IsFreeOutputCalculated(const std::vector<bool>& calculated_free_outputs,
+                            int free_output_index) {
+  // vh: All free outputs are calculated unless some of them are chosen. The
+  // ones which are not in the list are not chosen.
+  if (calculated_free_outputs.empty()) {
+    return true;
+  }
+
+  return (free_output_index <
+          static_cast<int>(calculated_free_outputs.size())) &&
+         calculated_free_outputs[free_output_index];
+}
+
+///
+auto GetFreeOutputs(const core::Diagram& diagram, const core::Project& project,
+                    const std::vector<bool>& calculated_free_outputs) {
+  auto free_outputs = std::vector<std::vector<float>>{};
+  auto traversing_node_id = std::optional<ne::NodeId>{};
+  auto free_output_index = 0;
+
+  TraverseFreeOutputs(
+      diagram, project,
+      [&calculated_free_outputs, &free_outputs, &traversing_node_id,
+       &free_output_index](const auto& tree_node, const auto& pin_flow) {
+        if (!IsFreeOutputCalculated(calculated_free_outputs,
+                                    free_output_index++)) {
+          return;
+        }
+
+        if (!traversing_node_id.has_value() ||
+            (*traversing_node_id != tree_node.node_id)) {
+          traversing_node_id = tree_node.node_id;
+          free_outputs.emplace_back();
+        }
+
+        Expects(!free_outputs.empty());
+        free_outputs.back().emplace_back(pin_flow.second);
+      });
+
+  return free_outputs;
+}
+
+
+///
+auto GetClientFamilyId(const core::Project& project) {
+  const auto& families = project.GetFamilies();
+  const auto client_family =
+      std::find_if(families.cbegin(), families.cend(), [](const auto& family) {
+        const auto& type = family->GetType();
+        return type.has_value() && (*type == core::FamilyType::kClient);
+      });
+
+  Expects(client_family != families.cend());
+  return (*client_family)->GetId();
+}
+
+///
+auto GetChildOutputIndex(const calc::TreeNode& parent,
+                         const calc::TreeNode* child) {
+  const auto child_node = std::find_if(
+      parent.child_nodes.cbegin(), parent.child_nodes.cend(),
+      [child](const auto& child_node) { return &child_node.second == child; });
+
+  Expects(child_node != parent.child_nodes.cend());
+  return child_node->first;
+}
+
+///
+auto GetFirstLevelChild(const std::vector<calc::TreeNode>& tree_nodes,
+                        int output_index)
+    -> std::optional<const calc::TreeNode*> {
+  auto delta = 0;
+
+  for (const auto& tree_node : tree_nodes) {
+    const auto next_delta = delta + static_cast<int>(tree_node.outputs.size());
+
+    if (output_index < next_delta) {
+      const auto child_index = output_index - delta;
+      const auto child_tree = tree_node.child_nodes.find(child_index);
+
+      if (child_tree == tree_node.child_nodes.cend()) {
+        return std::nullopt;
+      }
+
+      return &child_tree->second;
+    }
+
+    delta = next_delta;
+  }
+
+  Expects(false);
+}
+///
+auto AsFamilyNodes(const core::Project& project) {
+  const auto& families = project.GetFamilies();
+  const auto& family_settings =
+      project.GetSettings().calculator_settings.family_settings;
+
+  auto family_nodes = std::vector<calc::TreeNode>{};
+
+  for (const auto& settings : family_settings) {
+    if (!settings.enabled) {
+      continue;
+    }
+
+    const auto family = std::find_if(
+        families.cbegin(), families.cend(), [&settings](const auto& family) {
+          return family->GetId() == settings.family_id;
+        });
+    Expects(family != families.cend());
+
+    const auto cost = calc::ToCalculatorResolution(settings.cost);
+    const auto sample_node = (*family)->CreateSampleNode();
+    const auto outputs = GetNodeOutputs(*sample_node);
+
+    family_nodes.emplace_back(
+        calc::TreeNode{.family_id = settings.family_id,
+                       .node_cost = cost,
+                       .tree_cost = cost,
+                       .outputs = calc::ToCalculatorResolution(outputs)});
+  }
+
+  return family_nodes;
+}
+
+///
+auto PopulateOutput(core::Diagram& diagram, core::Project& project,
+                    const calc::TreeNode& output_tree, ne::PinId output_pin) {
+  auto& id_generator = project.GetIdGenerator();
+
+  auto parent_stack =
+      std::stack<std::pair<const calc::TreeNode*, const core::INode*>>{};
+  auto output_root_id = ne::NodeId{};
+
+  calc::TraverseDepthFirst(
+      output_tree,
+      [output_pin, &diagram, &project, &id_generator, &parent_stack,
+       &output_root_id](const auto& tree_node) {
+        const auto& family =
+            core::Project::FindFamily(project, tree_node.family_id);
+        const auto& node =
+            diagram.EmplaceNode(family.CreateNode(id_generator));
+
+        auto parent_output_pin = output_pin;
+
+        if (parent_stack.empty()) {
+          output_root_id = node.GetId();
+        } else {
+          const auto& [parent_tree_node, parent_node] = parent_stack.top();
+          const auto parent_output_pins = parent_node->GetOutputPinIds();
+          const auto output_index =
+              GetChildOutputIndex(*parent_tree_node, &tree_node);
+
+          Expects(output_index < static_cast<int>(parent_output_pins.size()));
+          parent_output_pin = parent_output_pins[output_index];
+        }
+
+        const auto input_pin =
+            core::INode::GetFirstPinOfKind(node, ne::PinKind::Input);
+        const auto link = core::Link{.id = id_generator.Generate<ne::LinkId>(),
+                                     .start_pin_id = parent_output_pin,
+                                     .end_pin_id = input_pin};
+
+        diagram.EmplaceLink(link);
+
+        parent_stack.emplace(&tree_node, &node);
+      },
+      [&parent_stack](const auto&) { parent_stack.pop(); });
+
+  return output_root_id;
+}
+}  // namespace
+
+///
+auto CalculatorMapper::FindCalculatedFreeOutputs(
+    const core::Diagram& diagram, const core::Project& project,
+    const std::vector<ne::NodeId>& node_ids) -> std::vector<bool> {
+  auto calculated_free_outputs = std::vector<bool>{};
+
+  TraverseFreeOutputs(
+      diagram, project,
+      [&node_ids, &calculated_free_outputs](const auto& tree_node,
+                                            const auto&) {
+        calculated_free_outputs.emplace_back(
+            std::find(node_ids.cbegin(), node_ids.cend(), tree_node.node_id) !=
+            node_ids.cend());
+      });
+
+  return calculated_free_outputs;
+}
+
+///
+auto CalculatorMapper::GetInputNodes(
+    const core::Diagram& diagram, const core::Project& project,
+    const std::vector<bool>& calculated_free_outputs)
+    -> std::vector<calc::TreeNode> {
+  const auto free_outputs =
+      GetFreeOutputs(diagram, project, calculated_free_outputs);
+
+  auto input_nodes = std::vector<calc::TreeNode>{};
+  input_nodes.reserve(free_outputs.size());
+
+  std::transform(free_outputs.cbegin(), free_outputs.cend(),
+                 std::back_inserter(input_nodes), [](const auto& free_outputs) {
+                   return calc::TreeNode{
+                       .outputs = calc::ToCalculatorResolution(free_outputs)};
+                 });
+
+  return input_nodes;
+}
+
+///
+auto CalculatorMapper::MakeCalculatorArgs(const core::Project& project)
+    -> calc::Calculator::ConstructorArgs {
+  return calc::Calculator::ConstructorArgs{
+      .settings = project.GetSettings().calculator_settings,
+      .client_node = calc::TreeNode{.family_id = GetClientFamilyId(project),
+                                    .num_clients = 1},
+      .family_nodes = AsFamilyNodes(project)};
+}
+
+///
+auto CalculatorMapper::PopulateDiagram(
+    core::Diagram& diagram, core::Project& project,
+    const std::vector<bool>& calculated_free_outputs,
+    const std::vector<calc::TreeNode>& calculated_trees)
+    -> std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>> {
+  coreui::Cloner::RewireIds(core::Diagram::GetIds(diagram),
+                            project.GetIdGenerator());
+
+  auto output_root_ids =
+      std::map<core::IdValue<ne::PinId>, core::IdValue<ne::NodeId>>{};
+  auto free_output_index = 0;
+  auto output_index = 0;
+
+  TraverseFreeOutputs(
+      diagram, project,
+      [&diagram, &project, &calculated_free_outputs, &calculated_trees,
+       &output_root_ids, &free_output_index,
+       &output_index](const auto&, const auto& pin_flow) {
+        if (!IsFreeOutputCalculated(calculated_free_outputs,
+                                    free_output_index++)) {
+          return;
+        }
+
+        if (const auto output_tree =
+                GetFirstLevelChild(calculated_trees, output_index)) {
+          const auto output_root_id =
+              PopulateOutput(diagram, project, **output_tree, pin_flow.first);
+          output_root_ids.emplace(pin_flow.first, output_root_id);
+        }
+
+        ++output_index;
+      });
+
+  return output_root_ids;
+}
+}  // namespace vh::ponc::coreui
@@ -243,6 +243,11 @@ auto Project::OpenFromFile(std::filesystem::path file_path) -> Event& {
 ///
 auto Project::CanSave() const -> bool { return !file_path_.empty(); }
 
+///
+auto Project::GetFilePath() const -> const std::filesystem::path& {
+  return file_path_;
+}
+
 ///
 auto Project::Save() -> Event& { return SaveToFile(file_path_); }
 
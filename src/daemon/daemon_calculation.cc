@@ -0,0 +1,471 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "daemon_calculation.h"
+
+#include <crude_json.h>
+#include <imgui_node_editor.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "app_family_groups.h"
+#include "calc_resolution.h"
+#include "calc_tree_node.h"
+#include "core_connection.h"
+#include "core_diagram.h"
+#include "core_i_family.h"
+#include "core_i_node.h"
+#include "core_id_value.h"
+#include "core_link.h"
+#include "core_project.h"
+#include "core_settings.h"
+#include "coreui_calculator_mapper.h"
+#include "coreui_cloner.h"
+#include "cpp_assert.h"
+#include "json_container_serializer.h"
+#include "json_diagram_serializer.h"
+#include "json_project_serializer.h"
+#include "json_tree_node_serializer.h"
+#include "json_versifier.h"
+
+namespace vh::ponc::daemon {
+namespace {
+///
+auto FindDiagramIndex(const crude_json::array& diagrams_json,
+                      const crude_json::string& name) -> std::optional<int> {
+  const auto diagram_json = std::find_if(
+      diagrams_json.cbegin(), diagrams_json.cend(),
+      [&name](const auto& diagram_json) {
+        return diagram_json.is_object() && diagram_json.contains("name") &&
+               diagram_json["name"].is_string() &&
+               (diagram_json["name"].template get<crude_json::string>() ==
+                name);
+      });
+
+  if (diagram_json == diagrams_json.cend()) {
+    return std::nullopt;
+  }
+
+  return static_cast<int>(std::distance(diagrams_json.cbegin(), diagram_json));
+}
+
+///
+auto ValidateDiagramRequest(
+    const crude_json::value& diagram_request,
+    const crude_json::array& diagrams_json,
+    const std::vector<std::unique_ptr<core::IFamily>>& families)
+    -> std::optional<std::string> {
+  if (!diagram_request.is_object()) {
+    return "Diagram request should be an object.";
+  }
+
+  if (diagram_request.contains("diagram")) {
+    if (!json::DiagramSerializer::CanParseFromJson(diagram_request["diagram"],
+                                                   families)) {
+      return "Diagram is malformed.";
+    }
+  } else if (!diagram_request.contains("name") ||
+             !diagram_request["name"].is_string()) {
+    return "Diagram request should have a diagram or a name.";
+  } else if (const auto& name =
+                 diagram_request["name"].get<crude_json::string>();
+             !FindDiagramIndex(diagrams_json, name).has_value()) {
+    return "Project has no diagram " + name + ".";
+  }
+
+  if (!diagram_request.contains("free_outputs")) {
+    return std::nullopt;
+  }
+
+  const auto& free_outputs_json = diagram_request["free_outputs"];
+
+  if (!free_outputs_json.is_array() ||
+      !std::all_of(free_outputs_json.get<crude_json::array>().cbegin(),
+                   free_outputs_json.get<crude_json::array>().cend(),
+                   [](const auto& json) { return json.is_boolean(); })) {
+    return "Free outputs should be an array of booleans.";
+  }
+
+  return std::nullopt;
+}
+
+///
+auto ValidateProject(const core::Project& project)
+    -> std::optional<std::string> {
+  const auto& settings = project.GetSettings().calculator_settings;
+
+  if (settings.min_output > settings.max_output) {
+    return "Min Output should be <= Max Output.";
+  }
+
+  // vh: Daemon is shared, so a job can't take more threads or processes than
+  // the machine has.
+  if (const auto num_cores =
+          static_cast<int>(std::thread::hardware_concurrency());
+      (num_cores > 0) && ((settings.num_threads > num_cores) ||
+                          (settings.num_processes > num_cores))) {
+    return "Threads and processes should be <= " + std::to_string(num_cores) +
+           ".";
+  }
+
+  const auto& families = project.GetFamilies();
+
+  if (std::none_of(families.cbegin(), families.cend(), [](const auto& family) {
+        const auto type = family->GetType();
+        return type.has_value() && (*type == core::FamilyType::kClient);
+      })) {
+    return "Project should have a client family.";
+  }
+
+  const auto has_family = [&families](const auto family_id) {
+    return std::any_of(families.cbegin(), families.cend(),
+                       [family_id](const auto& family) {
+                         return family->GetId() == family_id;
+                       });
+  };
+
+  if (!std::all_of(settings.family_settings.cbegin(),
+                   settings.family_settings.cend(),
+                   [&has_family](const auto& family_settings) {
+                     return has_family(family_settings.family_id);
+                   })) {
+    return "Calculator settings should be of the project families.";
+  }
+
+  return std::nullopt;
+}
+
+///
+auto ValidateDiagram(const core::Diagram& diagram,
+                     const core::Project& project)
+    -> std::optional<std::string> {
+  auto node_ids = std::set<core::IdValue<ne::NodeId>>{};
+  auto pin_ids = std::set<core::IdValue<ne::PinId>>{};
+  auto input_pin_ids = std::set<core::IdValue<ne::PinId>>{};
+
+  // vh: Flows of the nodes are found by their IDs and the ones of the links
+  // by their pins, so both should be unique.
+  for (const auto& node : diagram.GetNodes()) {
+    if (!node_ids.emplace(node->GetId().Get()).second) {
+      return "Diagram should have unique node IDs.";
+    }
+
+    for (const auto& [pin_id, pin_kind] : core::INode::GetAllPins(*node)) {
+      if (!pin_ids.emplace(pin_id.Get()).second) {
+        return "Diagram should have unique pin IDs.";
+      }
+
+      if (pin_kind == ne::PinKind::Input) {
+        input_pin_ids.emplace(pin_id.Get());
+      }
+    }
+  }
+
+  const auto& connections = project.GetConnections();
+
+  for (const auto& link : diagram.GetLinks()) {
+    if (!pin_ids.contains(link.start_pin_id.Get()) ||
+        input_pin_ids.contains(link.start_pin_id.Get()) ||
+        !input_pin_ids.contains(link.end_pin_id.Get())) {
+      return "Links should connect outputs to inputs of the diagram nodes.";
+    }
+
+    const auto* connection_id =
+        std::get_if<core::ConnectionId>(&link.connection);
+
+    if ((connection_id != nullptr) &&
+        std::none_of(connections.cbegin(), connections.cend(),
+                     [connection_id](const auto& connection) {
+                       return connection.id == *connection_id;
+                     })) {
+      return "Links should use the project connections.";
+    }
+  }
+
+  return std::nullopt;
+}
+
+///
+auto ParseFreeOutputs(const crude_json::value& diagram_request) {
+  if (!diagram_request.contains("free_outputs")) {
+    return std::vector<bool>{};
+  }
+
+  return json::ContainerSerializer::ParseFromJson<bool>(
+      diagram_request["free_outputs"], [](const auto& json) {
+        return json.template get<crude_json::boolean>();
+      });
+}
+
+///
+auto GetTotalCost(const std::vector<calc::TreeNode>& calculated_trees) {
+  return std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
+                         [](const auto total_cost, const auto& tree) {
+                           return total_cost + tree.tree_cost;
+                         });
+}
+
+///
+auto GetNumClients(const std::vector<calc::TreeNode>& calculated_trees) {
+  return std::accumulate(calculated_trees.cbegin(), calculated_trees.cend(), 0,
+                         [](const auto num_clients, const auto& tree) {
+                           return num_clients + tree.num_clients;
+                         });
+}
+}  // namespace
+
+///
+auto Calculation::ValidateRequest(const crude_json::value& request)
+    -> std::optional<std::string> {
+  if (!request.contains("project") || !request["project"].is_object()) {
+    return "Request should have a project.";
+  }
+
+  const auto& project_json = request["project"];
+
+  // vh: Clients write the project with the version of PONC they are built
+  // with. Older projects are not upgraded, since the upgrades expect valid
+  // ones.
+  if (!project_json.contains("version") ||
+      !project_json["version"].is_number() ||
+      (project_json["version"].get<crude_json::number>() !=
+       static_cast<crude_json::number>(
+           json::Versifier::GetCurrentVersion()))) {
+    return "Project should be from this version of PONC.";
+  }
+
+  // vh: Any local user could send the project, and parsers expect a valid
+  // one, so it is checked the same way as they read it.
+  const auto family_parsers = CreateFamilyParsers();
+
+  if (!json::ProjectSerializer::CanParseFromJson(project_json,
+                                                 family_parsers)) {
+    return "Project is malformed.";
+  }
+
+  if (request.contains("priority") && !request["priority"].is_number()) {
+    return "Priority should be a number.";
+  }
+
+  if (!request.contains("diagrams")) {
+    return std::nullopt;
+  }
+
+  if (!request["diagrams"].is_array()) {
+    return "Diagrams should be an array.";
+  }
+
+  const auto& diagrams_json = project_json["diagrams"].get<crude_json::array>();
+  const auto families =
+      json::ProjectSerializer::ParseFamiliesFromJson(project_json,
+                                                     family_parsers);
+
+  for (const auto& diagram_request :
+       request["diagrams"].get<crude_json::array>()) {
+    if (auto error =
+            ValidateDiagramRequest(diagram_request, diagrams_json, families)) {
+      return error;
+    }
+  }
+
+  return std::nullopt;
+}
+
+///
+Calculation::Calculation(ConstructorArgs args) {
+  auto& project_json = args.request["project"];
+  auto& diagrams_json = project_json["diagrams"].get<crude_json::array>();
+
+  if (!args.request.contains("diagrams")) {
+    for (auto diagram_index = 0;
+         diagram_index < static_cast<int>(diagrams_json.size());
+         ++diagram_index) {
+      calculated_diagrams_.emplace_back(
+          CalculatedDiagram{.diagram_index = diagram_index});
+    }
+  } else {
+    // vh: Diagrams given as JSON join the project, so the nodes added to
+    // their results get IDs which they don't use.
+    for (const auto& diagram_request :
+         args.request["diagrams"].get<crude_json::array>()) {
+      auto diagram_index = std::optional<int>{};
+
+      if (diagram_request.contains("diagram")) {
+        diagrams_json.emplace_back(diagram_request["diagram"]);
+        diagram_index = static_cast<int>(diagrams_json.size()) - 1;
+      } else {
+        diagram_index = FindDiagramIndex(
+            diagrams_json, diagram_request["name"].get<crude_json::string>());
+      }
+
+      Expects(diagram_index.has_value());
+      calculated_diagrams_.emplace_back(
+          CalculatedDiagram{.diagram_index = *diagram_index,
+                            .free_outputs = ParseFreeOutputs(diagram_request)});
+    }
+  }
+
+  project_.emplace(json::ProjectSerializer::ParseFromJson(
+      project_json, CreateFamilyParsers()));
+
+  if (const auto error = ValidateProject(*project_)) {
+    for (auto& calculated_diagram : calculated_diagrams_) {
+      calculated_diagram.error = *error;
+    }
+
+    return;
+  }
+
+  auto batch_args = calc::BatchTask::ConstructorArgs{
+      .calculator_args =
+          coreui::CalculatorMapper::MakeCalculatorArgs(*project_)};
+  batch_args.calculator_args.best_trees_cache =
+      std::move(args.best_trees_cache);
+
+  for (auto& calculated_diagram : calculated_diagrams_) {
+    const auto& diagram =
+        project_->GetDiagrams()[calculated_diagram.diagram_index];
+
+    if (auto error = ValidateDiagram(diagram, *project_)) {
+      calculated_diagram.error = std::move(*error);
+      continue;
+    }
+
+    auto input_nodes = coreui::CalculatorMapper::GetInputNodes(
+        diagram, *project_, calculated_diagram.free_outputs);
+
+    if (input_nodes.empty()) {
+      calculated_diagram.error = "Diagram should have free outputs.";
+      continue;
+    }
+
+    batch_args.diagram_input_nodes.emplace_back(std::move(input_nodes));
+  }
+
+  if (batch_args.diagram_input_nodes.empty()) {
+    return;
+  }
+
+  const auto estimate = calc::BatchTask::ChooseCalculation(batch_args);
+  batch_args.calculator_args.settings.engine = estimate.engine;
+  batch_args.calculator_args.settings.beam_width = estimate.beam_width;
+
+  batch_task_.emplace(std::move(batch_args));
+}
+
+///
+void Calculation::Stop() {
+  if (batch_task_.has_value()) {
+    batch_task_->Stop();
+  }
+}
+
+///
+auto Calculation::IsRunning() const -> bool {
+  return batch_task_.has_value() && batch_task_->IsRunning();
+}
+
+///
+auto Calculation::GetProgress() const -> float {
+  return batch_task_.has_value() ? batch_task_->GetProgress() : 1;
+}
+
+///
+auto Calculation::GetTimeLeft() const -> std::optional<std::chrono::seconds> {
+  if (!batch_task_.has_value()) {
+    return std::nullopt;
+  }
+
+  return batch_task_->GetTimeLeft();
+}
+
+///
+auto Calculation::GetResult() -> std::optional<crude_json::value> {
+  auto results = std::vector<std::vector<calc::TreeNode>>{};
+
+  if (batch_task_.has_value()) {
+    auto batch_results = batch_task_->GetResults();
+
+    if (!batch_results.has_value()) {
+      return std::nullopt;
+    }
+
+    batch_task_.reset();
+    results = std::move(*batch_results);
+  }
+
+  auto diagram_results = crude_json::array{};
+  diagram_results.reserve(calculated_diagrams_.size());
+
+  auto next_result = results.cbegin();
+
+  for (const auto& calculated_diagram : calculated_diagrams_) {
+    if (!calculated_diagram.error.empty()) {
+      auto& diagram_result = diagram_results.emplace_back();
+      diagram_result["name"] =
+          project_->GetDiagrams()[calculated_diagram.diagram_index].GetName();
+      diagram_result["error"] = calculated_diagram.error;
+      continue;
+    }
+
+    Expects(next_result != results.cend());
+    diagram_results.emplace_back(
+        MakeDiagramResult(calculated_diagram, *next_result));
+    ++next_result;
+  }
+
+  return crude_json::value{std::move(diagram_results)};
+}
+
+///
+auto Calculation::MakeDiagramResult(
+    const CalculatedDiagram& calculated_diagram,
+    const std::vector<calc::TreeNode>& calculated_trees) -> crude_json::value {
+  auto& project = *project_;
+  auto diagram_copy = coreui::Cloner::Clone(
+      project.GetDiagrams()[calculated_diagram.diagram_index],
+      project.GetFamilies());
+
+  auto diagram_result = crude_json::value{};
+  diagram_result["name"] = diagram_copy.GetName();
+  diagram_result["clients"] =
+      static_cast<crude_json::number>(GetNumClients(calculated_trees));
+  diagram_result["cost"] = static_cast<crude_json::number>(
+      calc::FromCalculatorResolution(GetTotalCost(calculated_trees)));
+  diagram_result["trees"] = json::ContainerSerializer::WriteToJson(
+      calculated_trees, &json::TreeNodeSerializer::WriteToJson);
+
+  if (coreui::CalculatorMapper::PopulateDiagram(
+          diagram_copy, project, calculated_diagram.free_outputs,
+          calculated_trees)
+          .empty()) {
+    return diagram_result;
+  }
+
+  // vh: Results stay in the project, so the next ones get unique names and
+  // IDs. Nodes keep default positions, since only the editor knows their
+  // sizes to arrange them.
+  auto new_diagram_name = core::Diagram::MakeUniqueDiagramName(
+      project.GetDiagrams(), diagram_copy.GetName(), "calc.");
+  diagram_copy.SetName(std::move(new_diagram_name));
+
+  diagram_result["diagram"] =
+      json::DiagramSerializer::WriteToJson(diagram_copy);
+  project.EmplaceDiagram(std::move(diagram_copy));
+
+  return diagram_result;
+}
+}  // namespace vh::ponc::daemon
@@ -0,0 +1,69 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "daemon_job_queue.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "daemon_socket.h"
+
+namespace vh::ponc::daemon {
+///
+auto JobQueue::Push(Job job) -> int {
+  // vh: Jobs of the same priority are taken in the order they came.
+  const auto next_job = std::upper_bound(
+      jobs_.cbegin(), jobs_.cend(), job.priority,
+      [](const auto priority, const auto &job) {
+        return priority > job.priority;
+      });
+
+  const auto job_index = std::distance(jobs_.cbegin(), next_job);
+  jobs_.emplace(next_job, std::move(job));
+  return static_cast<int>(job_index);
+}
+
+///
+auto JobQueue::Pop() -> std::optional<Job> {
+  if (jobs_.empty()) {
+    return std::nullopt;
+  }
+
+  auto job = std::move(jobs_.front());
+  jobs_.erase(jobs_.begin());
+  return job;
+}
+
+///
+auto JobQueue::Remove(JobId job_id, const std::shared_ptr<Socket> &client)
+    -> bool {
+  // vh: Clients only cancel the jobs they submitted.
+  const auto job = std::find_if(
+      jobs_.cbegin(), jobs_.cend(), [job_id, &client](const auto &job) {
+        return (job.id == job_id) && (job.client == client);
+      });
+
+  if (job == jobs_.cend()) {
+    return false;
+  }
+
+  jobs_.erase(job);
+  return true;
+}
+
+///
+void JobQueue::RemoveClientJobs(const std::shared_ptr<Socket> &client) {
+  std::erase_if(jobs_,
+                [&client](const auto &job) { return job.client == client; });
+}
+
+///
+auto JobQueue::GetJobs() const -> const std::vector<Job> & { return jobs_; }
+}  // namespace vh::ponc::daemon
@@ -0,0 +1,33 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "daemon_server.h"
+#include "daemon_socket.h"
+
+///
+auto main(int argc, char **argv) -> int {
+  const auto args = std::span{argv + 1, argv + argc};
+  auto server_args = vh::ponc::daemon::Server::ConstructorArgs{
+      .socket_path = vh::ponc::daemon::Socket::GetDefaultPath()};
+
+  if ((args.size() == 2) && (std::string_view{args[0]} == "--socket")) {
+    server_args.socket_path = args[1];
+  } else if (!args.empty()) {
+    std::cerr << "Usage: ponc-daemon [--socket PATH]\n"
+                 "\n"
+                 "  --socket PATH   Socket to accept calculation jobs on, "
+              << server_args.socket_path.string() << " if not specified.\n";
+    return EXIT_FAILURE;
+  }
+
+  return vh::ponc::daemon::Server{std::move(server_args)}.Run();
+}
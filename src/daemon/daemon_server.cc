@@ -0,0 +1,372 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "daemon_server.h"
+
+#include <poll.h>
+
+#include <crude_json.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "calc_best_trees_cache.h"
+#include "cpp_assert.h"
+#include "daemon_calculation.h"
+#include "daemon_job_queue.h"
+#include "daemon_message_type.h"
+#include "daemon_socket.h"
+
+namespace vh::ponc::daemon {
+namespace {
+///
+constexpr auto kProgressInterval = std::chrono::milliseconds{500};
+
+///
+// NOLINTNEXTLINE(*-non-const-global-variables)
+volatile std::sig_atomic_t stop_requested = 0;
+
+///
+void RequestStop(int /*unused*/) { stop_requested = 1; }
+
+///
+void Log(std::string_view message) {
+  const auto time = std::time(nullptr);
+  auto local_time = std::tm{};
+  localtime_r(&time, &local_time);
+
+  std::cerr << std::put_time(&local_time, "%F %T") << " " << message << "\n";
+}
+
+///
+auto MakeJobEvent(const char *type, JobId job_id) {
+  auto event = crude_json::value{};
+  event["type"] = type;
+  event["job"] = static_cast<crude_json::number>(job_id);
+  return event;
+}
+
+///
+auto MakeError(const std::string &message) {
+  auto event = crude_json::value{};
+  event["type"] = MessageType::kError;
+  event["message"] = message;
+  return event;
+}
+}  // namespace
+
+///
+Server::Server(ConstructorArgs args)
+    : socket_path_{std::move(args.socket_path)},
+      best_trees_cache_{std::make_shared<calc::BestTreesCache>()},
+      next_job_id_{1} {}
+
+///
+auto Server::Run() -> int {
+  const auto listening_socket = Socket::Listen(socket_path_);
+
+  if (!listening_socket.has_value()) {
+    Log("Couldn't listen on " + socket_path_.string() +
+        ", it could be used by another daemon.");
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, &RequestStop);
+  std::signal(SIGTERM, &RequestStop);
+
+  Log("Listening on " + socket_path_.string());
+
+  // vh: Requests are read and results are sent from this thread only, while
+  // the running job calculates in its own threads. Messages which a client
+  // doesn't take at once wait in its socket until it could take more. Poll
+  // timeout is the interval of progress events.
+  while (stop_requested == 0) {
+    DisconnectBrokenClients();
+
+    const auto clients = clients_;
+
+    auto poll_descriptors = std::vector<pollfd>{};
+    poll_descriptors.reserve(clients.size() + 1);
+    poll_descriptors.emplace_back(
+        pollfd{.fd = listening_socket->GetDescriptor(),
+               .events = POLLIN,
+               .revents = 0});
+
+    for (const auto &client : clients) {
+      const auto events = client->HasPendingData() ? (POLLIN | POLLOUT)
+                                                   : POLLIN;
+      poll_descriptors.emplace_back(pollfd{.fd = client->GetDescriptor(),
+                                           .events = static_cast<short>(events),
+                                           .revents = 0});
+    }
+
+    const auto num_ready =
+        poll(poll_descriptors.data(), poll_descriptors.size(),
+             static_cast<int>(kProgressInterval.count()));
+
+    if ((num_ready < 0) && (errno != EINTR)) {
+      Log("Couldn't wait for requests.");
+      return EXIT_FAILURE;
+    }
+
+    if (num_ready > 0) {
+      if ((poll_descriptors.front().revents & POLLIN) != 0) {
+        AcceptClient(*listening_socket);
+      }
+
+      for (auto client_index = 0;
+           client_index < static_cast<int>(clients.size()); ++client_index) {
+        const auto &client = clients[client_index];
+        const auto revents = poll_descriptors[client_index + 1].revents;
+
+        if (((revents & POLLOUT) != 0) && !client->SendPendingData()) {
+          DisconnectClient(client);
+          continue;
+        }
+
+        if (((revents & ~POLLOUT) != 0) && !ReceiveRequests(client)) {
+          DisconnectClient(client);
+        }
+      }
+    }
+
+    ProcessRunningJob();
+    StartNextJob();
+  }
+
+  Log("Stopped.");
+  return EXIT_SUCCESS;
+}
+
+///
+void Server::AcceptClient(const Socket &listening_socket) {
+  auto client = listening_socket.Accept();
+
+  if (!client.has_value()) {
+    return;
+  }
+
+  clients_.emplace_back(std::make_shared<Socket>(std::move(*client)));
+}
+
+///
+auto Server::ReceiveRequests(const std::shared_ptr<Socket> &client) -> bool {
+  const auto requests = client->ReceiveMessages();
+
+  if (!requests.has_value()) {
+    return false;
+  }
+
+  for (const auto &request : *requests) {
+    ProcessRequest(client, request);
+  }
+
+  return true;
+}
+
+///
+void Server::ProcessRequest(const std::shared_ptr<Socket> &client,
+                            const crude_json::value &request) {
+  if (!request.is_object() || !request.contains("type") ||
+      !request["type"].is_string()) {
+    client->SendMessage(MakeError("Request should be an object with a type."));
+    return;
+  }
+
+  const auto &type = request["type"].get<crude_json::string>();
+
+  if (type == MessageType::kSubmit) {
+    Submit(client, request);
+    return;
+  }
+
+  if (type == MessageType::kCancel) {
+    if (!request.contains("job") || !request["job"].is_number()) {
+      client->SendMessage(MakeError("Cancel request should have a job."));
+      return;
+    }
+
+    Cancel(client,
+           static_cast<JobId>(request["job"].get<crude_json::number>()));
+    return;
+  }
+
+  client->SendMessage(MakeError("Unknown request type " + type + "."));
+}
+
+///
+void Server::Submit(const std::shared_ptr<Socket> &client,
+                    crude_json::value request) {
+  if (const auto error = Calculation::ValidateRequest(request)) {
+    client->SendMessage(MakeError(*error));
+    return;
+  }
+
+  const auto priority =
+      request.contains("priority")
+          ? static_cast<int>(request["priority"].get<crude_json::number>())
+          : 0;
+  const auto job_id = next_job_id_++;
+
+  job_queue_.Push(Job{.id = job_id,
+                      .priority = priority,
+                      .client = client,
+                      .request = std::move(request)});
+
+  Log("Queued job " + std::to_string(job_id) + " with priority " +
+      std::to_string(priority) + ".");
+  SendQueuePositions();
+}
+
+///
+void Server::Cancel(const std::shared_ptr<Socket> &client, JobId job_id) {
+  // vh: Running calculation is stopped by its destructor, which waits for
+  // its threads to notice that.
+  if (running_job_.has_value() && (running_job_->id == job_id) &&
+      (running_job_->client == client)) {
+    calculation_.reset();
+    running_job_.reset();
+  } else if (!job_queue_.Remove(job_id, client)) {
+    client->SendMessage(
+        MakeError("Client has no job " + std::to_string(job_id) + "."));
+    return;
+  }
+
+  Log("Cancelled job " + std::to_string(job_id) + ".");
+  client->SendMessage(MakeJobEvent(MessageType::kCancelled, job_id));
+  SendQueuePositions();
+}
+
+///
+void Server::DisconnectClient(const std::shared_ptr<Socket> &client) {
+  // vh: Nobody would receive results of the jobs of the gone client.
+  job_queue_.RemoveClientJobs(client);
+
+  if (running_job_.has_value() && (running_job_->client == client)) {
+    Log("Cancelled job " + std::to_string(running_job_->id) +
+        " of disconnected client.");
+    calculation_.reset();
+    running_job_.reset();
+  }
+
+  std::erase(clients_, client);
+  SendQueuePositions();
+}
+
+///
+void Server::DisconnectBrokenClients() {
+  // vh: Client breaks when it doesn't take its messages, and the daemon must
+  // not keep them for it. Every disconnect sends the queue positions, which
+  // could break other clients.
+  while (true) {
+    const auto client =
+        std::find_if(clients_.cbegin(), clients_.cend(),
+                     [](const auto &client) { return client->IsBroken(); });
+
+    if (client == clients_.cend()) {
+      return;
+    }
+
+    const auto broken_client = *client;
+
+    Log("Disconnected client which couldn't take its messages.");
+    DisconnectClient(broken_client);
+  }
+}
+
+///
+void Server::StartNextJob() {
+  if (running_job_.has_value()) {
+    return;
+  }
+
+  auto job = job_queue_.Pop();
+
+  if (!job.has_value()) {
+    return;
+  }
+
+  Log("Started job " + std::to_string(job->id) + ".");
+  job->client->SendMessage(MakeJobEvent(MessageType::kStarted, job->id));
+
+  calculation_.emplace(
+      Calculation::ConstructorArgs{.request = std::move(job->request),
+                                   .best_trees_cache = best_trees_cache_});
+  running_job_ = std::move(job);
+  progress_time_ = std::chrono::steady_clock::now();
+
+  SendQueuePositions();
+}
+
+///
+void Server::ProcessRunningJob() {
+  if (!calculation_.has_value()) {
+    return;
+  }
+
+  Expects(running_job_.has_value());
+
+  if (auto result = calculation_->GetResult()) {
+    auto event = MakeJobEvent(MessageType::kResult, running_job_->id);
+    event["diagrams"] = std::move(*result);
+
+    Log("Finished job " + std::to_string(running_job_->id) + ".");
+    running_job_->client->SendMessage(event);
+
+    calculation_.reset();
+    running_job_.reset();
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+
+  if ((now - progress_time_) < kProgressInterval) {
+    return;
+  }
+
+  progress_time_ = now;
+
+  auto event = MakeJobEvent(MessageType::kProgress, running_job_->id);
+  event["progress"] =
+      static_cast<crude_json::number>(calculation_->GetProgress());
+
+  if (const auto time_left = calculation_->GetTimeLeft()) {
+    event["time_left"] = static_cast<crude_json::number>(time_left->count());
+  }
+
+  running_job_->client->SendMessage(event);
+}
+
+///
+void Server::SendQueuePositions() const {
+  // vh: Every change of the queue moves some jobs, so the clients are told
+  // how many jobs are ahead of each of theirs.
+  const auto num_running_jobs = running_job_.has_value() ? 1 : 0;
+  const auto &jobs = job_queue_.GetJobs();
+
+  for (auto job_index = 0; job_index < static_cast<int>(jobs.size());
+       ++job_index) {
+    const auto &job = jobs[job_index];
+
+    auto event = MakeJobEvent(MessageType::kQueued, job.id);
+    event["jobs_ahead"] =
+        static_cast<crude_json::number>(job_index + num_running_jobs);
+
+    job.client->SendMessage(event);
+  }
+}
+}  // namespace vh::ponc::daemon
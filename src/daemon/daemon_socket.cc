@@ -0,0 +1,346 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "daemon_socket.h"
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include <crude_json.h>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace vh::ponc::daemon {
+#ifdef __linux__
+namespace {
+///
+constexpr auto kReceiveSize = 64 * 1024;
+///
+constexpr auto kMaxBufferedSize = std::size_t{64} * 1024 * 1024;
+///
+constexpr auto kMessageDelimiter = '\n';
+
+///
+auto MakeAddress(const std::filesystem::path &path)
+    -> std::optional<sockaddr_un> {
+  auto address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  const auto &path_string = path.native();
+
+  if (path_string.empty() || (path_string.size() >= sizeof(address.sun_path))) {
+    return std::nullopt;
+  }
+
+  path_string.copy(static_cast<char *>(address.sun_path), path_string.size());
+  return address;
+}
+
+///
+auto ConnectTo(const std::filesystem::path &path) -> int {
+  const auto address = MakeAddress(path);
+
+  if (!address.has_value()) {
+    return -1;
+  }
+
+  const auto descriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (descriptor < 0) {
+    return -1;
+  }
+
+  if (connect(descriptor, reinterpret_cast<const sockaddr *>(&*address),
+              sizeof(*address)) != 0) {
+    close(descriptor);
+    return -1;
+  }
+
+  return descriptor;
+}
+}  // namespace
+
+///
+auto Socket::Listen(const std::filesystem::path &path)
+    -> std::optional<Socket> {
+  const auto address = MakeAddress(path);
+
+  if (!address.has_value()) {
+    return std::nullopt;
+  }
+
+  // vh: Socket file is left by a daemon which was killed, and is only
+  // replaced if nobody listens to it.
+  if (auto error = std::error_code{}; std::filesystem::exists(path, error)) {
+    if (const auto descriptor = ConnectTo(path); descriptor >= 0) {
+      close(descriptor);
+      return std::nullopt;
+    }
+
+    std::filesystem::remove(path, error);
+  }
+
+  const auto descriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+  if (descriptor < 0) {
+    return std::nullopt;
+  }
+
+  auto listening_socket = Socket{descriptor};
+
+  // vh: Daemon is shared by the users of its group, the others can't connect
+  // to it, even between the bind and setting the permissions.
+  const auto previous_mask = umask(S_IRWXO);
+  const auto bound = bind(descriptor,
+                          reinterpret_cast<const sockaddr *>(&*address),
+                          sizeof(*address)) == 0;
+  umask(previous_mask);
+
+  if (!bound) {
+    return std::nullopt;
+  }
+
+  listening_socket.bound_path_ = path;
+
+  auto error = std::error_code{};
+  std::filesystem::permissions(path,
+                               std::filesystem::perms::owner_read |
+                                   std::filesystem::perms::owner_write |
+                                   std::filesystem::perms::group_read |
+                                   std::filesystem::perms::group_write,
+                               error);
+
+  if (listen(descriptor, SOMAXCONN) != 0) {
+    return std::nullopt;
+  }
+
+  return listening_socket;
+}
+
+///
+auto Socket::Connect(const std::filesystem::path &path)
+    -> std::optional<Socket> {
+  const auto descriptor = ConnectTo(path);
+
+  if (descriptor < 0) {
+    return std::nullopt;
+  }
+
+  return Socket{descriptor};
+}
+
+///
+Socket::~Socket() {
+  if (descriptor_ >= 0) {
+    close(descriptor_);
+  }
+
+  if (!bound_path_.empty()) {
+    auto error = std::error_code{};
+    std::filesystem::remove(bound_path_, error);
+  }
+}
+
+///
+auto Socket::Accept() const -> std::optional<Socket> {
+  // vh: Accepted sockets are served by a single thread, which must not wait
+  // for any client to take its data.
+  const auto descriptor =
+      accept4(descriptor_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+  if (descriptor < 0) {
+    return std::nullopt;
+  }
+
+  return Socket{descriptor};
+}
+
+///
+auto Socket::SendMessage(const crude_json::value &message) -> bool {
+  if (broken_) {
+    return false;
+  }
+
+  // vh: Messages are dumped without indent, so they don't have line breaks
+  // and each line is one message.
+  pending_data_ += message.dump();
+  pending_data_ += kMessageDelimiter;
+
+  // vh: Other side which doesn't read its messages would make them pile up,
+  // so it is cut off after a limit.
+  if (pending_data_.size() > kMaxBufferedSize) {
+    pending_data_.clear();
+    broken_ = true;
+    return false;
+  }
+
+  return SendPendingData();
+}
+
+///
+auto Socket::HasPendingData() const -> bool { return !pending_data_.empty(); }
+
+///
+auto Socket::SendPendingData() -> bool {
+  auto num_sent_total = std::size_t{0};
+
+  // vh: Blocking socket sends everything, while the non-blocking one sends
+  // what fits and keeps the rest until it could take more.
+  while (!broken_ && (num_sent_total < pending_data_.size())) {
+    // vh: Other side could be gone, which must not kill this process.
+    const auto num_sent =
+        send(descriptor_, pending_data_.data() + num_sent_total,
+             pending_data_.size() - num_sent_total, MSG_NOSIGNAL);
+
+    if (num_sent >= 0) {
+      num_sent_total += static_cast<std::size_t>(num_sent);
+      continue;
+    }
+
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      break;
+    }
+
+    if (errno != EINTR) {
+      broken_ = true;
+    }
+  }
+
+  pending_data_.erase(0, num_sent_total);
+  return !broken_;
+}
+
+///
+auto Socket::IsBroken() const -> bool { return broken_; }
+
+///
+auto Socket::ReceiveMessages()
+    -> std::optional<std::vector<crude_json::value>> {
+  auto buffer = std::array<char, kReceiveSize>{};
+  auto num_received = recv(descriptor_, buffer.data(), buffer.size(), 0);
+
+  while ((num_received < 0) && (errno == EINTR)) {
+    num_received = recv(descriptor_, buffer.data(), buffer.size(), 0);
+  }
+
+  if ((num_received < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+    return std::vector<crude_json::value>{};
+  }
+
+  if (num_received <= 0) {
+    return std::nullopt;
+  }
+
+  received_data_.append(buffer.data(), static_cast<std::size_t>(num_received));
+
+  auto messages = std::vector<crude_json::value>{};
+  auto message_start = std::size_t{0};
+
+  for (auto message_end = received_data_.find(kMessageDelimiter);
+       message_end != std::string::npos;
+       message_end = received_data_.find(kMessageDelimiter, message_start)) {
+    messages.emplace_back(crude_json::value::parse(
+        received_data_.substr(message_start, message_end - message_start)));
+    message_start = message_end + 1;
+  }
+
+  received_data_.erase(0, message_start);
+
+  // vh: Rest of the data is a part of the next message, which must end
+  // before the limit.
+  if (received_data_.size() > kMaxBufferedSize) {
+    received_data_.clear();
+    broken_ = true;
+    return std::nullopt;
+  }
+
+  return messages;
+}
+
+///
+void Socket::Shutdown() const { shutdown(descriptor_, SHUT_RDWR); }
+#else
+///
+auto Socket::Listen(const std::filesystem::path & /*unused*/)
+    -> std::optional<Socket> {
+  // vh: Daemon only runs on Linux, the same as worker processes.
+  return std::nullopt;
+}
+
+///
+auto Socket::Connect(const std::filesystem::path & /*unused*/)
+    -> std::optional<Socket> {
+  return std::nullopt;
+}
+
+///
+Socket::~Socket() = default;
+
+///
+auto Socket::Accept() const -> std::optional<Socket> { return std::nullopt; }
+
+///
+auto Socket::SendMessage(const crude_json::value & /*unused*/) -> bool {
+  return false;
+}
+
+///
+auto Socket::HasPendingData() const -> bool { return false; }
+
+///
+auto Socket::SendPendingData() -> bool { return false; }
+
+///
+auto Socket::IsBroken() const -> bool { return true; }
+
+///
+auto Socket::ReceiveMessages()
+    -> std::optional<std::vector<crude_json::value>> {
+  return std::nullopt;
+}
+
+///
+void Socket::Shutdown() const {}
+#endif
+
+///
+auto Socket::GetDefaultPath() -> std::filesystem::path {
+  auto error = std::error_code{};
+  auto directory = std::filesystem::temp_directory_path(error);
+
+  if (error) {
+    directory = "/tmp";
+  }
+
+  return directory / "ponc-daemon.sock";
+}
+
+///
+Socket::Socket(int descriptor) : descriptor_{descriptor} {}
+
+///
+Socket::Socket(Socket &&other) noexcept
+    : descriptor_{std::exchange(other.descriptor_, -1)},
+      bound_path_{std::exchange(other.bound_path_, {})},
+      pending_data_{std::move(other.pending_data_)},
+      received_data_{std::move(other.received_data_)},
+      broken_{other.broken_} {}
+
+///
+auto Socket::GetDescriptor() const -> int { return descriptor_; }
+}  // namespace vh::ponc::daemon
@@ -0,0 +1,209 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "daemon_task.h"
+
+#include <crude_json.h>
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "calc_tree_node.h"
+#include "daemon_message_type.h"
+#include "daemon_socket.h"
+#include "json_container_serializer.h"
+#include "json_diagram_serializer.h"
+#include "json_project_serializer.h"
+#include "json_tree_node_serializer.h"
+
+namespace vh::ponc::daemon {
+namespace {
+///
+auto ParseResult(const crude_json::value &event) {
+  auto result = Task::Result{};
+
+  // vh: Diagrams which daemon couldn't calculate have no trees, the same as
+  // the ones without any more clients.
+  for (const auto &diagram_result :
+       event["diagrams"].get<crude_json::array>()) {
+    auto &calculated_trees = result.calculated_trees.emplace_back();
+
+    if (diagram_result.contains("trees")) {
+      calculated_trees =
+          json::ContainerSerializer::ParseFromJson<calc::TreeNode>(
+              diagram_result["trees"],
+              &json::TreeNodeSerializer::ParseFromJson);
+    }
+  }
+
+  return result;
+}
+}  // namespace
+
+///
+auto Task::WriteProject(const core::Project &project) -> crude_json::value {
+  // vh: Only the calculated diagrams are sent, each one separately.
+  auto project_json = json::ProjectSerializer::WriteToJson(project);
+  project_json["diagrams"] = crude_json::array{};
+  return project_json;
+}
+
+///
+auto Task::WriteDiagram(const core::Diagram &diagram,
+                        const std::vector<bool> &free_outputs)
+    -> crude_json::value {
+  auto diagram_request = crude_json::value{};
+  diagram_request["diagram"] = json::DiagramSerializer::WriteToJson(diagram);
+
+  if (!free_outputs.empty()) {
+    diagram_request["free_outputs"] = json::ContainerSerializer::WriteToJson(
+        free_outputs,
+        [](const auto free_output) { return crude_json::value{free_output}; });
+  }
+
+  return diagram_request;
+}
+
+///
+Task::Task(ConstructorArgs args)
+    : socket_{Socket::Connect(args.socket_path)} {
+  auto request = crude_json::value{};
+  request["type"] = MessageType::kSubmit;
+  request["priority"] = static_cast<crude_json::number>(args.priority);
+  request["project"] = std::move(args.project);
+  request["diagrams"] =
+      crude_json::array{std::move_iterator{args.diagrams.begin()},
+                        std::move_iterator{args.diagrams.end()}};
+
+  task_ = std::async(std::launch::async,
+                     [this, socket_path = std::move(args.socket_path),
+                      request = std::move(request)]() {
+                       return Exchange(socket_path, request);
+                     });
+}
+
+///
+Task::~Task() {
+  Stop();
+
+  if (task_.valid()) {
+    task_.wait();
+  }
+}
+
+///
+void Task::Stop() {
+  // vh: Daemon cancels the jobs of the clients which are gone.
+  if (socket_.has_value()) {
+    socket_->Shutdown();
+  }
+}
+
+///
+auto Task::IsRunning() const -> bool {
+  if (!task_.valid()) {
+    return false;
+  }
+
+  const auto task_status = task_.wait_for(std::chrono::seconds::zero());
+  return task_status != std::future_status::ready;
+}
+
+///
+auto Task::GetProgress() const -> float { return progress_; }
+
+///
+auto Task::GetTimeLeft() const -> std::optional<std::chrono::seconds> {
+  const auto time_left = time_left_.load();
+
+  if (time_left < 0) {
+    return std::nullopt;
+  }
+
+  return std::chrono::seconds{time_left};
+}
+
+///
+auto Task::GetNumJobsAhead() const -> std::optional<int> {
+  const auto num_jobs_ahead = num_jobs_ahead_.load();
+
+  if (num_jobs_ahead < 0) {
+    return std::nullopt;
+  }
+
+  return num_jobs_ahead;
+}
+
+///
+auto Task::GetResult() -> std::optional<Result> {
+  if (!task_.valid() || IsRunning()) {
+    return std::nullopt;
+  }
+
+  return task_.get();
+}
+
+///
+auto Task::Exchange(const std::filesystem::path &socket_path,
+                    const crude_json::value &request) -> Result {
+  if (!socket_.has_value()) {
+    return Result{.error = "Couldn't connect to daemon at " +
+                           socket_path.string() + "."};
+  }
+
+  if (!socket_->SendMessage(request)) {
+    return Result{.error = "Couldn't send the job to daemon."};
+  }
+
+  while (const auto events = socket_->ReceiveMessages()) {
+    for (const auto &event : *events) {
+      if (!event.is_object() || !event.contains("type") ||
+          !event["type"].is_string()) {
+        continue;
+      }
+
+      const auto &type = event["type"].get<crude_json::string>();
+
+      if (type == MessageType::kResult) {
+        return ParseResult(event);
+      }
+
+      if (type == MessageType::kError) {
+        return Result{.error = "Daemon: " +
+                               event["message"].get<crude_json::string>()};
+      }
+
+      ProcessEvent(event);
+    }
+  }
+
+  return Result{.error = "Daemon closed the connection."};
+}
+
+///
+void Task::ProcessEvent(const crude_json::value &event) {
+  const auto &type = event["type"].get<crude_json::string>();
+
+  if (type == MessageType::kQueued) {
+    num_jobs_ahead_ =
+        static_cast<int>(event["jobs_ahead"].get<crude_json::number>());
+  } else if (type == MessageType::kStarted) {
+    num_jobs_ahead_ = -1;
+  } else if (type == MessageType::kProgress) {
+    progress_ = static_cast<float>(event["progress"].get<crude_json::number>());
+    time_left_ = event.contains("time_left")
+                     ? static_cast<int>(
+                           event["time_left"].get<crude_json::number>())
+                     : -1;
+  }
+}
+}  // namespace vh::ponc::daemon
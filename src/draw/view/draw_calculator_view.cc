@@ -9,22 +9,42 @@
 #include <imgui.h>
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <set>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include "calc_calculator.h"
+#include "calc_estimator.h"
+#include "calc_resolution.h"
+#include "core_diagram.h"
 #include "core_i_family.h"
 #include "core_project.h"
 #include "core_settings.h"
 #include "coreui_calculator.h"
 #include "coreui_i_family_traits.h"
 #include "draw_disable_if.h"
+#include "draw_help_marker.h"
 #include "draw_settings_table_row.h"
+#include "draw_string_buffer.h"
 #include "draw_table_flags.h"
 
 namespace vh::ponc::draw {
 namespace {
+///
+constexpr auto kCostCurveHeight = 80.F;
+///
+constexpr auto kMaxNumLayouts = 16;
+///
+constexpr auto kMinFlowResolution = 0.01F;
+///
+constexpr auto kMaxFlowResolution = 1.F;
+///
+constexpr auto kBytesPerMegabyte = 1024 * 1024;
+
 ///
 void DrawProgressBar(const coreui::Calculator& calculator) {
   if (!calculator.IsRunning()) {
@@ -34,12 +54,139 @@ void DrawProgressBar(const coreui::Calculator& calculator) {
   ImGui::SameLine();
 
   const auto progress = calculator.GetProgress();
-  const auto label = std::to_string(static_cast<int>(progress * 100)) + "%";
+  auto label = std::to_string(static_cast<int>(progress * 100)) + "%";
+
+  if (const auto num_jobs_ahead = calculator.GetNumJobsAhead();
+      num_jobs_ahead.has_value()) {
+    label = "Queued, " + std::to_string(*num_jobs_ahead) + " jobs ahead";
+  }
+
+  if (const auto time_left = calculator.GetTimeLeft(); time_left.has_value()) {
+    label += " (" + std::to_string(time_left->count()) + "s left)";
+  }
 
   ImGui::ProgressBar(progress, {-std::numeric_limits<float>::min(), 0},
                      label.c_str());
 }
 
+///
+void DrawBestResult(coreui::Calculator& calculator) {
+  if (!calculator.IsRunning()) {
+    return;
+  }
+
+  const auto& best_result = calculator.GetBestResult();
+
+  if (!best_result.has_value()) {
+    return;
+  }
+
+  ImGui::Text("Current Best: %d clients for %.2f$", best_result->num_clients,
+              calc::FromCalculatorResolution(best_result->total_cost));
+  ImGui::SameLine();
+
+  if (ImGui::Button("Accept Current Best")) {
+    calculator.AcceptBestResult();
+  }
+}
+
+///
+auto GetEngineLabel(core::CalculatorEngine engine) {
+  switch (engine) {
+    case core::CalculatorEngine::kPermutations:
+      return "Permutations";
+    case core::CalculatorEngine::kConvolution:
+      return "Convolution";
+    case core::CalculatorEngine::kAuto:
+      return "Auto";
+  }
+
+  return "";
+}
+
+///
+void DrawEstimate(const coreui::Calculator& calculator) {
+  const auto& estimate = calculator.GetEstimate();
+
+  if (!estimate.has_value()) {
+    return;
+  }
+
+  ImGui::Text("Estimate: %s", GetEngineLabel(estimate->engine));
+
+  if (estimate->beam_width > 0) {
+    ImGui::SameLine();
+    ImGui::Text("(Beam %d)", estimate->beam_width);
+  }
+
+  ImGui::Text("%d outputs, %lld states, %lld MB, %.1fs", estimate->num_outputs,
+              static_cast<long long>(estimate->num_states),
+              static_cast<long long>(estimate->memory_size / kBytesPerMegabyte),
+              estimate->duration);
+}
+
+///
+void DrawCostCurvePlot(
+    const std::vector<calc::Calculator::CostCurvePoint>& cost_curve,
+    int& point_index) {
+  auto costs = std::vector<float>{};
+  costs.reserve(cost_curve.size());
+
+  std::transform(cost_curve.cbegin(), cost_curve.cend(),
+                 std::back_inserter(costs), [](const auto& point) {
+                   return calc::FromCalculatorResolution(point.total_cost);
+                 });
+
+  const auto num_points = static_cast<int>(costs.size());
+
+  ImGui::PlotLines("##Cost Curve", costs.data(), num_points, 0,
+                   "Cost, $ per number of clients",
+                   std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::max(),
+                   {-std::numeric_limits<float>::min(), kCostCurveHeight});
+
+  if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+    const auto plot_width = ImGui::GetItemRectSize().x;
+    const auto mouse_offset =
+        ImGui::GetMousePos().x - ImGui::GetItemRectMin().x;
+
+    point_index = static_cast<int>(mouse_offset / plot_width *
+                                   static_cast<float>(num_points));
+  }
+
+  point_index = std::clamp(point_index, 0, num_points - 1);
+}
+
+///
+void DrawCostCurve(coreui::Calculator& calculator, int& point_index) {
+  const auto& cost_curve = calculator.GetCostCurve();
+
+  if (cost_curve.empty() ||
+      !ImGui::CollapsingHeader("Cost Curve", ImGuiTreeNodeFlags_DefaultOpen)) {
+    return;
+  }
+
+  DrawCostCurvePlot(cost_curve, point_index);
+
+  const auto label =
+      std::to_string(cost_curve[point_index].num_clients) + " clients";
+
+  ImGui::SetNextItemWidth(-std::numeric_limits<float>::min());
+  ImGui::SliderInt("##Cost Curve Point", &point_index, 0,
+                   static_cast<int>(cost_curve.size()) - 1, label.c_str());
+
+  const auto& point = cost_curve[point_index];
+  const auto disable_scope = EnableIf(!calculator.IsRunning());
+
+  ImGui::Text("%d clients for %.2f$", point.num_clients,
+              calc::FromCalculatorResolution(point.total_cost));
+  ImGui::SameLine();
+
+  if (ImGui::Button("Add Diagram")) {
+    calculator.AddCostCurveDiagram(point.num_clients);
+  }
+}
+
 ///
 void DrawRequirements(core::CalculatorSettings& settings) {
   if (ImGui::CollapsingHeader("Requirements", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -60,6 +207,169 @@ void DrawRequirements(core::CalculatorSettings& settings) {
         settings.num_clients = std::max(1, settings.num_clients);
       }
 
+      DrawSettingsTableRow("Max Splitter Depth (0 - Any)");
+
+      if (ImGui::InputInt("##Max Splitter Depth", &settings.max_depth)) {
+        settings.max_depth = std::max(0, settings.max_depth);
+      }
+
+      DrawSettingsTableRow("Max Devices per Path (0 - Any)");
+
+      if (ImGui::InputInt("##Max Devices per Path", &settings.max_devices)) {
+        settings.max_devices = std::max(0, settings.max_devices);
+      }
+
+      DrawSettingsTableRow("Layouts");
+
+      if (ImGui::InputInt("##Layouts", &settings.num_layouts)) {
+        settings.num_layouts =
+            std::clamp(settings.num_layouts, 1, kMaxNumLayouts);
+      }
+
+      ImGui::EndTable();
+    }
+  }
+}
+
+///
+void DrawEngineSettings(core::CalculatorSettings& settings) {
+  if (ImGui::CollapsingHeader("Engine")) {
+    if (ImGui::BeginTable("Engine", 2, kSettingsTableFlags)) {
+      ImGui::TableSetupColumn("Setting", ImGuiTableColumnFlags_NoHeaderLabel);
+      ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_NoHeaderLabel);
+
+      DrawSettingsTableRow("Search");
+
+      auto engine = static_cast<int>(settings.engine);
+
+      if (ImGui::Combo("##Search", &engine,
+                       "Permutations\0Convolution\0Auto\0")) {
+        settings.engine = static_cast<core::CalculatorEngine>(engine);
+      }
+
+      DrawSettingsTableRow("Threads (0 - All Cores)");
+
+      if (ImGui::InputInt("##Threads", &settings.num_threads)) {
+        settings.num_threads = std::max(0, settings.num_threads);
+      }
+
+      DrawSettingsTableRow("Worker Processes (0 - None)");
+
+      if (ImGui::InputInt("##Worker Processes", &settings.num_processes)) {
+        settings.num_processes = std::max(0, settings.num_processes);
+      }
+
+      DrawSettingsTableRow("Keep Cache File");
+
+      const auto uses_cache = calc::Calculator::UsesCache(settings);
+
+      {
+        const auto disable_scope = DisableIf(!uses_cache);
+        ImGui::Checkbox("##Keep Cache File", &settings.keep_cache_file);
+      }
+
+      if (!uses_cache) {
+        ImGui::SameLine();
+        DrawHelpMarker("Cache isn't used with beam, layouts or path limits");
+      }
+
+      DrawSettingsTableRow("Flow Resolution");
+
+      if (ImGui::InputFloat("##Flow Resolution", &settings.flow_resolution, 0,
+                            0, "%.2f")) {
+        settings.flow_resolution = std::clamp(
+            settings.flow_resolution, kMinFlowResolution, kMaxFlowResolution);
+      }
+
+      DrawSettingsTableRow("Beam Width (0 - Exact)");
+
+      if (ImGui::InputInt("##Beam Width", &settings.beam_width)) {
+        settings.beam_width = std::max(0, settings.beam_width);
+      }
+
+      DrawSettingsTableRow("Time Budget (s, 0 - Any)");
+
+      if (ImGui::InputFloat("##Time Budget", &settings.time_budget, 0, 0,
+                            "%.0f")) {
+        settings.time_budget = std::max(0.F, settings.time_budget);
+      }
+
+      DrawSettingsTableRow("Memory Budget (MB, 0 - Any)");
+
+      if (ImGui::InputInt("##Memory Budget", &settings.memory_budget)) {
+        settings.memory_budget = std::max(0, settings.memory_budget);
+      }
+
+      ImGui::EndTable();
+    }
+  }
+}
+
+///
+void DrawDaemonSettings(core::CalculatorSettings& settings,
+                        StringBuffer& socket_buffer) {
+  if (ImGui::CollapsingHeader("Daemon")) {
+    if (ImGui::BeginTable("Daemon", 2, kSettingsTableFlags)) {
+      ImGui::TableSetupColumn("Setting", ImGuiTableColumnFlags_NoHeaderLabel);
+      ImGui::TableSetupColumn("Value", ImGuiTableColumnFlags_NoHeaderLabel);
+
+      DrawSettingsTableRow("Daemon Socket (Empty - Local)");
+      socket_buffer.Set(settings.daemon_socket);
+
+      if (ImGui::InputText("##Daemon Socket", socket_buffer.GetData(),
+                           socket_buffer.GetSize())) {
+        settings.daemon_socket = socket_buffer.AsTrimmed();
+      }
+
+      DrawSettingsTableRow("Daemon Priority");
+      ImGui::InputInt("##Daemon Priority", &settings.daemon_priority);
+
+      ImGui::EndTable();
+    }
+  }
+}
+
+///
+auto GetCalculatedDiagrams(const core::Project& project,
+                           const std::set<std::string>& skipped_diagrams) {
+  const auto& diagrams = project.GetDiagrams();
+  auto diagram_indices = std::vector<int>{};
+
+  for (auto diagram_index = 0;
+       diagram_index < static_cast<int>(diagrams.size()); ++diagram_index) {
+    if (!skipped_diagrams.contains(diagrams[diagram_index].GetName())) {
+      diagram_indices.emplace_back(diagram_index);
+    }
+  }
+
+  return diagram_indices;
+}
+
+///
+void DrawDiagrams(const core::Project& project,
+                  std::set<std::string>& skipped_diagrams) {
+  if (ImGui::CollapsingHeader("Diagrams")) {
+    if (ImGui::BeginTable("Diagrams", 1, kSettingsTableFlags)) {
+      ImGui::TableSetupScrollFreeze(0, 1);
+      ImGui::TableSetupColumn("Calculated Diagram");
+      ImGui::TableHeadersRow();
+
+      for (const auto& diagram : project.GetDiagrams()) {
+        const auto& name = diagram.GetName();
+        auto calculated = !skipped_diagrams.contains(name);
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+
+        if (ImGui::Checkbox(name.c_str(), &calculated)) {
+          if (calculated) {
+            skipped_diagrams.erase(name);
+          } else {
+            skipped_diagrams.emplace(name);
+          }
+        }
+      }
+
       ImGui::EndTable();
     }
   }
@@ -127,6 +437,25 @@ void CalculatorView::Draw(coreui::Calculator& calculator,
     if (ImGui::Button("Calculate")) {
       calculator.Calculate();
     }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Calculate Selected")) {
+      calculator.CalculateSelected();
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Calculate Diagrams")) {
+      calculator.CalculateDiagrams(
+          GetCalculatedDiagrams(project, skipped_diagrams_));
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Estimate")) {
+      calculator.UpdateEstimate();
+    }
   }
 
   ImGui::SameLine();
@@ -140,7 +469,14 @@ void CalculatorView::Draw(coreui::Calculator& calculator,
   }
 
   DrawProgressBar(calculator);
+  DrawBestResult(calculator);
+  DrawEstimate(calculator);
+  DrawCostCurve(calculator, cost_curve_point_index_);
   DrawRequirements(project.GetSettings().calculator_settings);
+  DrawEngineSettings(project.GetSettings().calculator_settings);
+  DrawDaemonSettings(project.GetSettings().calculator_settings,
+                     daemon_socket_buffer_);
+  DrawDiagrams(project, skipped_diagrams_);
   DrawFamilies(project);
 }
 }  // namespace vh::ponc::draw
\ No newline at end of file
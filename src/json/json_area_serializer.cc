@@ -13,8 +13,18 @@
 
 #include "core_area.h"
 #include "json_id_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
+///
+auto AreaSerializer::CanParseFromJson(const crude_json::value& json) -> bool {
+  return ValueChecker::HasValue(json, "id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasString(json, "name") &&
+         ValueChecker::HasNumberArray(json, "pos", 2) &&
+         ValueChecker::HasNumberArray(json, "size", 2);
+}
+
 ///
 auto AreaSerializer::ParseFromJson(const crude_json::value& json)
     -> core::Area {
@@ -9,7 +9,14 @@
 #include <crude_json.h>
 #include <imgui.h>
 
+#include "json_value_checker.h"
+
 namespace vh::ponc::json {
+///
+auto ColorSerializer::CanParseFromJson(const crude_json::value& json) -> bool {
+  return ValueChecker::IsNumberArray(json, 4);
+}
+
 ///
 auto ColorSerializer::ParseFromJson(const crude_json::value& json) -> ImColor {
   return {static_cast<float>(json[0].get<crude_json::number>()),
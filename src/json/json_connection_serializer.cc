@@ -13,8 +13,21 @@
 #include "core_connection.h"
 #include "json_color_serializer.h"
 #include "json_id_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
+///
+auto ConnectionSerializer::CanParseFromJson(const crude_json::value& json)
+    -> bool {
+  return ValueChecker::HasValue(json, "id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasString(json, "name") &&
+         ValueChecker::HasValue(json, "color",
+                                &ColorSerializer::CanParseFromJson) &&
+         ValueChecker::HasNumber(json, "drop_per_length") &&
+         ValueChecker::HasNumber(json, "drop_added");
+}
+
 ///
 auto ConnectionSerializer::ParseFromJson(const crude_json::value& json)
     -> core::Connection {
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "core_area.h"
@@ -24,17 +25,56 @@
 #include "json_i_node_writer.h"  // IWYU pragma: keep
 #include "json_id_serializer.h"
 #include "json_link_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
 namespace {
 ///
-auto FindFamily(const std::vector<std::unique_ptr<core::IFamily>>& families,
-                core::FamilyId family_id) -> auto& {
+auto FindFamilyIfExists(
+    const std::vector<std::unique_ptr<core::IFamily>>& families,
+    core::FamilyId family_id) -> std::optional<const core::IFamily*> {
   const auto family = std::find_if(
       families.cbegin(), families.cend(),
       [family_id](const auto& family) { return family->GetId() == family_id; });
-  Expects(family != families.cend());
-  return *family;
+
+  if (family == families.cend()) {
+    return std::nullopt;
+  }
+
+  return &**family;
+}
+
+///
+auto FindFamily(const std::vector<std::unique_ptr<core::IFamily>>& families,
+                core::FamilyId family_id) -> auto& {
+  const auto family = FindFamilyIfExists(families, family_id);
+  Expects(family.has_value());
+  return **family;
+}
+
+///
+auto CanParseNode(const crude_json::value& json,
+                  const std::vector<std::unique_ptr<core::IFamily>>& families) {
+  if (!ValueChecker::HasValue(json, "family_id",
+                              &IdSerializer::CanParseFromJson)) {
+    return false;
+  }
+
+  const auto family = FindFamilyIfExists(
+      families, IdSerializer::ParseFromJson<core::FamilyId>(json["family_id"]));
+
+  if (!family.has_value() ||
+      !(*family)->CreateNodeParser()->CanParseFromJson(json)) {
+    return false;
+  }
+
+  // vh: Nodes compute their flows from the pins which their family makes.
+  const auto sample_node = (*family)->CreateSampleNode();
+
+  return (json.contains("input_pin_id") ==
+          sample_node->GetInputPinId().has_value()) &&
+         (json["output_pin_ids"].get<crude_json::array>().size() ==
+          sample_node->GetOutputPinIds().size());
 }
 
 ///
@@ -43,10 +83,32 @@ auto ParseNode(const crude_json::value& json,
   const auto family_id =
       IdSerializer::ParseFromJson<core::FamilyId>(json["family_id"]);
   const auto& family = FindFamily(families, family_id);
-  return family->CreateNodeParser()->ParseFromJson(json);
+  return family.CreateNodeParser()->ParseFromJson(json);
 }
 }  // namespace
 
+///
+auto DiagramSerializer::CanParseFromJson(
+    const crude_json::value& json,
+    const std::vector<std::unique_ptr<core::IFamily>>& families) -> bool {
+  if (!ValueChecker::HasString(json, "name") ||
+      !ValueChecker::HasValue(json, "nodes") ||
+      !ValueChecker::HasValue(json, "links") ||
+      !ValueChecker::HasValue(json, "areas")) {
+    return false;
+  }
+
+  return ContainerSerializer::CanParseFromJson(
+             json["nodes"],
+             [&families](const auto& json) {
+               return CanParseNode(json, families);
+             }) &&
+         ContainerSerializer::CanParseFromJson(
+             json["links"], &LinkSerializer::CanParseFromJson) &&
+         ContainerSerializer::CanParseFromJson(
+             json["areas"], &AreaSerializer::CanParseFromJson);
+}
+
 ///
 auto DiagramSerializer::ParseFromJson(
     const crude_json::value& json,
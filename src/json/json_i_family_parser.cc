@@ -11,8 +11,19 @@
 #include <memory>
 
 #include "json_id_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
+///
+auto IFamilyParser::CanParseFromJson(const crude_json::value& json) const
+    -> bool {
+  return ValueChecker::HasString(json, "type") &&
+         (json["type"].get<crude_json::string>() == GetTypeName()) &&
+         ValueChecker::HasValue(json, "id", &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "data") &&
+         CanParseDataFromJson(json["data"]);
+}
+
 ///
 auto IFamilyParser::TryToParseFromJson(const crude_json::value& json) const
     -> std::optional<std::unique_ptr<core::IFamily>> {
@@ -16,8 +16,25 @@
 #include "json_container_serializer.h"
 #include "json_id_serializer.h"
 #include "json_optional_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
+///
+auto INodeParser::CanParseFromJson(const crude_json::value& json) const
+    -> bool {
+  return ValueChecker::HasValue(json, "id", &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "family_id",
+                                &IdSerializer::CanParseFromJson) &&
+         OptionalSerializer::CanParseFromJson(
+             json, "input_pin_id", &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "output_pin_ids") &&
+         ContainerSerializer::CanParseFromJson(
+             json["output_pin_ids"], &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasNumberArray(json, "pos", 2) &&
+         ValueChecker::HasValue(json, "data") &&
+         CanParseDataFromJson(json["data"]);
+}
+
 ///
 auto INodeParser::ParseFromJson(const crude_json::value& json) const
     -> std::unique_ptr<core::INode> {
@@ -18,9 +18,45 @@
 #include "cpp_assert.h"
 #include "json_color_serializer.h"
 #include "json_id_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
 namespace {
+///
+auto CanParseConnection(const crude_json::value& json) {
+  if (!ValueChecker::HasInteger(json, "index")) {
+    return false;
+  }
+
+  const auto index = static_cast<int>(json["index"].get<crude_json::number>());
+
+  if (index == 0) {
+    return true;
+  }
+
+  if (!ValueChecker::HasValue(json, "value")) {
+    return false;
+  }
+
+  const auto& value_json = json["value"];
+
+  switch (index) {
+    case 1:
+      return IdSerializer::CanParseFromJson(value_json);
+
+    case 2:
+      return ValueChecker::HasValue(value_json, "color",
+                                    &ColorSerializer::CanParseFromJson) &&
+             ValueChecker::HasNumber(value_json, "drop_per_length") &&
+             ValueChecker::HasNumber(value_json, "drop_added");
+
+    default:
+      break;
+  }
+
+  return false;
+}
+
 ///
 auto ParseConnection(const crude_json::value& json) -> core::LinkConnection {
   const auto index = static_cast<int>(json["index"].get<crude_json::number>());
@@ -74,6 +110,18 @@ auto WriteConnection(const core::LinkConnection& connection) {
 }
 }  // namespace
 
+///
+auto LinkSerializer::CanParseFromJson(const crude_json::value& json) -> bool {
+  return ValueChecker::HasValue(json, "id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "start_pin_id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "end_pin_id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasNumber(json, "length") &&
+         ValueChecker::HasValue(json, "connection", CanParseConnection);
+}
+
 ///
 auto LinkSerializer::ParseFromJson(const crude_json::value& json)
     -> core::Link {
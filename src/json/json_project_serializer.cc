@@ -23,6 +23,7 @@
 #include "json_diagram_serializer.h"
 #include "json_i_family_writer.h"  // IWYU pragma: keep
 #include "json_setings_serializer.h"
+#include "json_value_checker.h"
 #include "json_versifier.h"
 
 namespace vh::ponc::json {
@@ -43,18 +44,60 @@ auto ParseFamily(
 }
 }  // namespace
 
+///
+auto ProjectSerializer::CanParseFromJson(
+    const crude_json::value& json,
+    const std::vector<std::unique_ptr<IFamilyParser>>& family_parsers)
+    -> bool {
+  if (!ValueChecker::HasValue(json, "settings",
+                              &SettingsSerializer::CanParseFromJson) ||
+      !ValueChecker::HasValue(json, "families") ||
+      !ValueChecker::HasValue(json, "connections") ||
+      !ValueChecker::HasValue(json, "diagrams")) {
+    return false;
+  }
+
+  const auto can_parse_families = ContainerSerializer::CanParseFromJson(
+      json["families"], [&family_parsers](const auto& json) {
+        return std::any_of(family_parsers.cbegin(), family_parsers.cend(),
+                           [&json](const auto& parser) {
+                             return parser->CanParseFromJson(json);
+                           });
+      });
+
+  if (!can_parse_families ||
+      !ContainerSerializer::CanParseFromJson(
+          json["connections"], &ConnectionSerializer::CanParseFromJson)) {
+    return false;
+  }
+
+  // vh: Nodes are checked by the parsers of their families.
+  const auto families = ParseFamiliesFromJson(json, family_parsers);
+
+  return ContainerSerializer::CanParseFromJson(
+      json["diagrams"], [&families](const auto& json) {
+        return DiagramSerializer::CanParseFromJson(json, families);
+      });
+}
+
+///
+auto ProjectSerializer::ParseFamiliesFromJson(
+    const crude_json::value& json,
+    const std::vector<std::unique_ptr<IFamilyParser>>& family_parsers)
+    -> std::vector<std::unique_ptr<core::IFamily>> {
+  return ContainerSerializer::ParseFromJson<std::unique_ptr<core::IFamily>>(
+      json["families"], [&family_parsers](const auto& json) {
+        return ParseFamily(json, family_parsers);
+      });
+}
+
 ///
 auto ProjectSerializer::ParseFromJson(
     const crude_json::value& json,
     const std::vector<std::unique_ptr<IFamilyParser>>& family_parsers)
     -> core::Project {
   const auto settings = SettingsSerializer::ParseFromJson(json["settings"]);
-
-  auto families =
-      ContainerSerializer::ParseFromJson<std::unique_ptr<core::IFamily>>(
-          json["families"], [&family_parsers](const auto& json) {
-            return ParseFamily(json, family_parsers);
-          });
+  auto families = ParseFamiliesFromJson(json, family_parsers);
 
   auto connections = ContainerSerializer::ParseFromJson<core::Connection>(
       json["connections"], &ConnectionSerializer::ParseFromJson);
@@ -7,6 +7,7 @@
 #include <crude_json.h>
 
 #include <algorithm>
+#include <initializer_list>
 #include <memory>
 
 #include "core_connection.h"
@@ -16,9 +17,46 @@
 #include "json_id_serializer.h"
 #include "json_optional_serializer.h"
 #include "json_setings_serializer.h"
+#include "json_value_checker.h"
 
 namespace vh::ponc::json {
 namespace {
+///
+auto HasValues(const crude_json::value& json,
+               std::initializer_list<const char*> keys,
+               const auto& value_checker) {
+  return std::all_of(keys.begin(), keys.end(),
+                     [&json, &value_checker](const auto* key) {
+                       return value_checker(json, key);
+                     });
+}
+
+///
+auto CanParseFamilySettingsFromJson(const crude_json::value& json) {
+  return ValueChecker::HasValue(json, "family_id",
+                                &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasBoolean(json, "enabled") &&
+         ValueChecker::HasNumber(json, "cost");
+}
+
+///
+auto CanParseCalculatorSettingsFromJson(const crude_json::value& json) {
+  return ValueChecker::HasBoolean(json, "keep_cache_file") &&
+         HasValues(json,
+                   {"min_output", "max_output", "flow_resolution",
+                    "time_budget"},
+                   &ValueChecker::HasNumber) &&
+         HasValues(json,
+                   {"num_clients", "num_threads", "engine", "num_layouts",
+                    "beam_width", "memory_budget", "max_depth", "max_devices",
+                    "num_processes", "daemon_priority"},
+                   &ValueChecker::HasInteger) &&
+         ValueChecker::HasString(json, "daemon_socket") &&
+         ValueChecker::HasValue(json, "family_settings") &&
+         ContainerSerializer::CanParseFromJson(json["family_settings"],
+                                               &CanParseFamilySettingsFromJson);
+}
+
 ///
 auto ParseFamilySettingsFromJson(const crude_json::value& json) {
   return core::CalculatorFamilySettings{
@@ -38,6 +76,24 @@ auto WriteFamilySettingsToJson(const core::CalculatorFamilySettings& settings) {
 }
 }  // namespace
 
+///
+auto SettingsSerializer::CanParseFromJson(const crude_json::value& json)
+    -> bool {
+  return HasValues(json, {"color_flow", "thick_links"},
+                   &ValueChecker::HasBoolean) &&
+         HasValues(json,
+                   {"min_flow", "low_flow", "high_flow", "max_flow",
+                    "min_length", "max_length"},
+                   &ValueChecker::HasNumber) &&
+         HasValues(json,
+                   {"arrange_horizontal_spacing", "arrange_vertical_spacing"},
+                   &ValueChecker::HasInteger) &&
+         OptionalSerializer::CanParseFromJson(
+             json, "default_connection", &IdSerializer::CanParseFromJson) &&
+         ValueChecker::HasValue(json, "calculator_settings",
+                                CanParseCalculatorSettingsFromJson);
+}
+
 ///
 auto SettingsSerializer::ParseFromJson(const crude_json::value& json)
     -> core::Settings {
@@ -72,6 +128,33 @@ auto SettingsSerializer::ParseFromJson(const crude_json::value& json)
                   calculator_json["max_output"].get<crude_json::number>()),
               .num_clients = static_cast<int>(
                   calculator_json["num_clients"].get<crude_json::number>()),
+              .num_threads = static_cast<int>(
+                  calculator_json["num_threads"].get<crude_json::number>()),
+              .engine = static_cast<core::CalculatorEngine>(
+                  calculator_json["engine"].get<crude_json::number>()),
+              .keep_cache_file =
+                  calculator_json["keep_cache_file"].get<crude_json::boolean>(),
+              .num_layouts = static_cast<int>(
+                  calculator_json["num_layouts"].get<crude_json::number>()),
+              .flow_resolution = static_cast<float>(
+                  calculator_json["flow_resolution"]
+                      .get<crude_json::number>()),
+              .beam_width = static_cast<int>(
+                  calculator_json["beam_width"].get<crude_json::number>()),
+              .time_budget = static_cast<float>(
+                  calculator_json["time_budget"].get<crude_json::number>()),
+              .memory_budget = static_cast<int>(
+                  calculator_json["memory_budget"].get<crude_json::number>()),
+              .max_depth = static_cast<int>(
+                  calculator_json["max_depth"].get<crude_json::number>()),
+              .max_devices = static_cast<int>(
+                  calculator_json["max_devices"].get<crude_json::number>()),
+              .num_processes = static_cast<int>(
+                  calculator_json["num_processes"].get<crude_json::number>()),
+              .daemon_socket =
+                  calculator_json["daemon_socket"].get<crude_json::string>(),
+              .daemon_priority = static_cast<int>(
+                  calculator_json["daemon_priority"].get<crude_json::number>()),
               .family_settings = ContainerSerializer::ParseFromJson<
                   core::CalculatorFamilySettings>(
                   calculator_json["family_settings"],
@@ -106,6 +189,30 @@ auto SettingsSerializer::WriteToJson(const core::Settings& settings)
   calculator_json["max_output"] = settings.calculator_settings.max_output;
   calculator_json["num_clients"] =
       static_cast<crude_json::number>(settings.calculator_settings.num_clients);
+  calculator_json["num_threads"] =
+      static_cast<crude_json::number>(settings.calculator_settings.num_threads);
+  calculator_json["engine"] =
+      static_cast<crude_json::number>(settings.calculator_settings.engine);
+  calculator_json["keep_cache_file"] =
+      settings.calculator_settings.keep_cache_file;
+  calculator_json["num_layouts"] =
+      static_cast<crude_json::number>(settings.calculator_settings.num_layouts);
+  calculator_json["flow_resolution"] =
+      settings.calculator_settings.flow_resolution;
+  calculator_json["beam_width"] =
+      static_cast<crude_json::number>(settings.calculator_settings.beam_width);
+  calculator_json["time_budget"] = settings.calculator_settings.time_budget;
+  calculator_json["memory_budget"] = static_cast<crude_json::number>(
+      settings.calculator_settings.memory_budget);
+  calculator_json["max_depth"] =
+      static_cast<crude_json::number>(settings.calculator_settings.max_depth);
+  calculator_json["max_devices"] =
+      static_cast<crude_json::number>(settings.calculator_settings.max_devices);
+  calculator_json["num_processes"] = static_cast<crude_json::number>(
+      settings.calculator_settings.num_processes);
+  calculator_json["daemon_socket"] = settings.calculator_settings.daemon_socket;
+  calculator_json["daemon_priority"] = static_cast<crude_json::number>(
+      settings.calculator_settings.daemon_priority);
 
   calculator_json["family_settings"] = ContainerSerializer::WriteToJson(
       settings.calculator_settings.family_settings, &WriteFamilySettingsToJson);
@@ -0,0 +1,80 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "json_tree_node_serializer.h"
+
+#include <crude_json.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "calc_tree_node.h"
+#include "calc_types.h"
+#include "core_i_family.h"
+#include "json_container_serializer.h"
+#include "json_id_serializer.h"
+
+namespace vh::ponc::json {
+namespace {
+///
+auto ParseOutputFromJson(const crude_json::value& json) {
+  return static_cast<calc::OutputIndex>(json.get<crude_json::number>());
+}
+
+///
+auto WriteOutputToJson(calc::OutputIndex output) {
+  return crude_json::value{static_cast<crude_json::number>(output)};
+}
+}  // namespace
+
+///
+auto TreeNodeSerializer::ParseFromJson(const crude_json::value& json)
+    -> calc::TreeNode {
+  auto tree_node = calc::TreeNode{
+      .family_id =
+          IdSerializer::ParseFromJson<core::FamilyId>(json["family_id"]),
+      .node_cost =
+          static_cast<calc::Cost>(json["node_cost"].get<crude_json::number>()),
+      .tree_cost =
+          static_cast<calc::Cost>(json["tree_cost"].get<crude_json::number>()),
+      .num_clients = static_cast<calc::NumClients>(
+          json["num_clients"].get<crude_json::number>()),
+      .outputs = ContainerSerializer::ParseFromJson<calc::OutputIndex>(
+          json["outputs"], &ParseOutputFromJson)};
+
+  for (const auto& child_json : json["child_nodes"].get<crude_json::array>()) {
+    tree_node.child_nodes.emplace(ParseOutputFromJson(child_json["output"]),
+                                  ParseFromJson(child_json["node"]));
+  }
+
+  return tree_node;
+}
+
+///
+auto TreeNodeSerializer::WriteToJson(const calc::TreeNode& tree_node)
+    -> crude_json::value {
+  auto json = crude_json::value{};
+  json["family_id"] = IdSerializer::WriteToJson(tree_node.family_id);
+  json["node_cost"] = static_cast<crude_json::number>(tree_node.node_cost);
+  json["tree_cost"] = static_cast<crude_json::number>(tree_node.tree_cost);
+  json["num_clients"] = static_cast<crude_json::number>(tree_node.num_clients);
+  json["outputs"] =
+      ContainerSerializer::WriteToJson(tree_node.outputs, &WriteOutputToJson);
+
+  auto child_nodes_json = crude_json::array{};
+  child_nodes_json.reserve(tree_node.child_nodes.size());
+
+  for (const auto& [output, child_node] : tree_node.child_nodes) {
+    auto& child_json = child_nodes_json.emplace_back();
+    child_json["output"] = WriteOutputToJson(output);
+    child_json["node"] = WriteToJson(child_node);
+  }
+
+  json["child_nodes"] = std::move(child_nodes_json);
+  return json;
+}
+}  // namespace vh::ponc::json
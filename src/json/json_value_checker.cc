@@ -0,0 +1,79 @@
+/**
+ * PONC @link https://github.com/qoala101/ponc @endlink
+ * @author Volodymyr Hromakov (4y5t6r@gmail.com)
+ * @copyright Copyright (c) 2023, MIT License
+ */
+
+#include "json_value_checker.h"
+
+#include <crude_json.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vh::ponc::json {
+///
+auto ValueChecker::HasValue(const crude_json::value& json,
+                            const crude_json::string& key) -> bool {
+  return json.is_object() && json.contains(key);
+}
+
+///
+auto ValueChecker::HasBoolean(const crude_json::value& json,
+                              const crude_json::string& key) -> bool {
+  return HasValue(json, key) && json[key].is_boolean();
+}
+
+///
+auto ValueChecker::HasNumber(const crude_json::value& json,
+                             const crude_json::string& key) -> bool {
+  return HasValue(json, key) && json[key].is_number();
+}
+
+///
+auto ValueChecker::HasInteger(const crude_json::value& json,
+                              const crude_json::string& key) -> bool {
+  return HasValue(json, key) && IsInteger(json[key]);
+}
+
+///
+auto ValueChecker::HasString(const crude_json::value& json,
+                             const crude_json::string& key) -> bool {
+  return HasValue(json, key) && json[key].is_string();
+}
+
+///
+auto ValueChecker::HasNumberArray(const crude_json::value& json,
+                                  const crude_json::string& key, int size)
+    -> bool {
+  return HasValue(json, key) && IsNumberArray(json[key], size);
+}
+
+///
+auto ValueChecker::IsInteger(const crude_json::value& json,
+                             crude_json::number min, crude_json::number max)
+    -> bool {
+  if (!json.is_number()) {
+    return false;
+  }
+
+  // vh: Numbers are cast to the integers, which is undefined for the ones
+  // which don't fit.
+  const auto number = json.get<crude_json::number>();
+  return (number >= min) && (number <= max) && (std::trunc(number) == number);
+}
+
+///
+auto ValueChecker::IsNumberArray(const crude_json::value& json, int size)
+    -> bool {
+  if (!json.is_array()) {
+    return false;
+  }
+
+  const auto& array = json.get<crude_json::array>();
+
+  return (static_cast<int>(array.size()) == size) &&
+         std::all_of(array.cbegin(), array.cend(),
+                     [](const auto& item) { return item.is_number(); });
+}
+}  // namespace vh::ponc::json
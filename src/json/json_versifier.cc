@@ -131,7 +131,106 @@ void Upgrade3(crude_json::value& project_json) {
 }
 
 ///
-void Upgrade4(crude_json::value& /*unused*/) {
+void Upgrade4(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["num_threads"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.num_threads);
+}
+
+///
+void Upgrade5(crude_json::value& project_json) {
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["engine"] = static_cast<crude_json::number>(
+      core::CalculatorEngine::kPermutations);
+}
+
+///
+void Upgrade6(crude_json::value& project_json) {
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["keep_cache_file"] = false;
+}
+
+///
+void Upgrade7(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["num_layouts"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.num_layouts);
+}
+
+///
+void Upgrade8(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["flow_resolution"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.flow_resolution);
+}
+
+///
+void Upgrade9(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["beam_width"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.beam_width);
+}
+
+///
+void Upgrade10(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["time_budget"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.time_budget);
+  calculator_json["memory_budget"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.memory_budget);
+}
+
+///
+void Upgrade11(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["max_depth"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.max_depth);
+  calculator_json["max_devices"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.max_devices);
+}
+
+///
+void Upgrade12(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["num_processes"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.num_processes);
+}
+
+///
+void Upgrade13(crude_json::value& project_json) {
+  auto default_settings = core::Settings{};
+  core::Settings::ResetToDefault(default_settings);
+
+  auto& calculator_json = project_json["settings"]["calculator_settings"];
+  calculator_json["daemon_socket"] =
+      default_settings.calculator_settings.daemon_socket;
+  calculator_json["daemon_priority"] = static_cast<crude_json::number>(
+      default_settings.calculator_settings.daemon_priority);
+}
+
+///
+void Upgrade14(crude_json::value& /*unused*/) {
   // vh: Implement when adding new version.
 }
 }  // namespace
@@ -163,6 +262,26 @@ void Versifier::UpgradeToCurrentVersion(crude_json::value& project_json) {
       Upgrade3(project_json);
     case Version::kConnections:
       Upgrade4(project_json);
+    case Version::kCalculatorThreads:
+      Upgrade5(project_json);
+    case Version::kCalculatorEngine:
+      Upgrade6(project_json);
+    case Version::kCalculatorCache:
+      Upgrade7(project_json);
+    case Version::kCalculatorLayouts:
+      Upgrade8(project_json);
+    case Version::kCalculatorResolution:
+      Upgrade9(project_json);
+    case Version::kCalculatorBeam:
+      Upgrade10(project_json);
+    case Version::kCalculatorBudget:
+      Upgrade11(project_json);
+    case Version::kCalculatorPathLimits:
+      Upgrade12(project_json);
+    case Version::kCalculatorProcesses:
+      Upgrade13(project_json);
+    case Version::kCalculatorDaemon:
+      Upgrade14(project_json);
     default:
       break;
   }